@@ -13,8 +13,20 @@
 #ifndef MYSTL_ALGO_H
 #define MYSTL_ALGO_H
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "allocator.h"
+#include "construct.h"
 #include "iterator.h"
 #include "algobase.h"
+#include "functional.h"
+#include "memory.h"
+#include "simd.h"
+#include "uninitialized.h"
+#include "util.h"
 
 namespace mystl
 {
@@ -49,6 +61,1672 @@ namespace mystl
     {
         mystl::reverse_dispatch(first, last, iterator_category(first));
     }
+
+    /// ================================================================================================================
+    /// @brief find / find_if
+    /// ================================================================================================================
+
+    /// @brief 第一个等于 value 的位置，没有时返回 last
+    template<typename InputIter, typename T>
+    InputIter find(InputIter first, InputIter last, const T &value)
+    {
+        while (first != last && !(*first == value))
+            ++first;
+        return first;
+    }
+
+    /// @brief 连续存储的算术类型调用向量化的 simd::find，单字节类型使用 memchr
+    template<typename Tp, typename U>
+    typename std::enable_if<simd::is_simd_key<Tp, U>::value, Tp *>::type
+    find(Tp *first, Tp *last, const U &value)
+    {
+        typename std::remove_const<Tp>::type key;
+        if (!simd::make_key(value, key)) return last;
+        return first + simd::find<typename std::remove_const<Tp>::type>(first, static_cast<size_t>(last - first), key);
+    }
+
+    /// @brief 第一个使 pred 为 true 的位置，没有时返回 last
+    template<typename InputIter, typename UnaryPredicate>
+    InputIter find_if(InputIter first, InputIter last, UnaryPredicate pred)
+    {
+        while (first != last && !pred(*first))
+            ++first;
+        return first;
+    }
+
+    /// ================================================================================================================
+    /// @brief count / count_if
+    /// ================================================================================================================
+
+    /// @brief 等于 value 的元素个数
+    template<typename InputIter, typename T>
+    typename iterator_traits<InputIter>::difference_type count(InputIter first, InputIter last, const T &value)
+    {
+        typename iterator_traits<InputIter>::difference_type n = 0;
+        for (; first != last; ++first)
+        {
+            if (*first == value) ++n;
+        }
+        return n;
+    }
+
+    /// @brief 连续存储的算术类型调用向量化的 simd::count
+    template<typename Tp, typename U>
+    typename std::enable_if<simd::is_simd_key<Tp, U>::value, ptrdiff_t>::type
+    count(Tp *first, Tp *last, const U &value)
+    {
+        typename std::remove_const<Tp>::type key;
+        if (!simd::make_key(value, key)) return 0;
+        return static_cast<ptrdiff_t>(
+                simd::count<typename std::remove_const<Tp>::type>(first, static_cast<size_t>(last - first), key));
+    }
+
+    /// @brief 使 pred 为 true 的元素个数
+    template<typename InputIter, typename UnaryPredicate>
+    typename iterator_traits<InputIter>::difference_type count_if(InputIter first, InputIter last, UnaryPredicate pred)
+    {
+        typename iterator_traits<InputIter>::difference_type n = 0;
+        for (; first != last; ++first)
+        {
+            if (pred(*first)) ++n;
+        }
+        return n;
+    }
+
+    /// ================================================================================================================
+    /// @brief search
+    /// ================================================================================================================
+
+    /**
+     * @brief 在 [first1, last1) 中查找子序列 [first2, last2) 第一次出现的位置，没有时返回 last1，子序列为空时返回 first1
+     * @note 先用 find 定位子序列的第一个元素(连续存储的算术类型因此走向量化路径)，再逐个比较其余元素
+     * */
+    template<typename ForwardIter1, typename ForwardIter2>
+    ForwardIter1 search(ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, ForwardIter2 last2)
+    {
+        if (first2 == last2) return first1;
+        ForwardIter2 next2 = first2;
+        ++next2;
+        while (true)
+        {
+            first1 = mystl::find(first1, last1, *first2);
+            if (first1 == last1) return last1;
+            ForwardIter1 cur1 = first1;
+            ++cur1;
+            ForwardIter2 cur2 = next2;
+            while (true)
+            {
+                if (cur2 == last2) return first1;
+                if (cur1 == last1) return last1;    // 剩余部分已经比子序列短
+                if (!(*cur1 == *cur2)) break;
+                ++cur1;
+                ++cur2;
+            }
+            ++first1;
+        }
+    }
+
+    /// @brief 使用 comp 判断元素相等
+    template<typename ForwardIter1, typename ForwardIter2, typename Compared>
+    ForwardIter1 search(ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, ForwardIter2 last2,
+                        Compared comp)
+    {
+        if (first2 == last2) return first1;
+        ForwardIter2 next2 = first2;
+        ++next2;
+        while (true)
+        {
+            while (first1 != last1 && !comp(*first1, *first2))
+                ++first1;
+            if (first1 == last1) return last1;
+            ForwardIter1 cur1 = first1;
+            ++cur1;
+            ForwardIter2 cur2 = next2;
+            while (true)
+            {
+                if (cur2 == last2) return first1;
+                if (cur1 == last1) return last1;
+                if (!comp(*cur1, *cur2)) break;
+                ++cur1;
+                ++cur2;
+            }
+            ++first1;
+        }
+    }
+
+    /// ================================================================================================================
+    /// @brief for_each
+    /// ================================================================================================================
+
+    template<typename InputIter, typename Function>
+    void for_each_segment_cat(InputIter first, InputIter last, Function &f, std::false_type)
+    {
+        for (; first != last; ++first)
+            f(*first);
+    }
+
+    /// @brief 分段迭代器逐段遍历，段内是指针循环，不再每步检查段边界
+    template<typename SegmentedIter, typename Function>
+    void for_each_segment_cat(SegmentedIter first, SegmentedIter last, Function &f, std::true_type)
+    {
+        typedef typename segmented_iterator_traits<SegmentedIter>::local_iterator local_iterator;
+        mystl::for_each_segment(first, last, [&f](local_iterator lfirst, local_iterator llast)
+        {
+            for (; lfirst != llast; ++lfirst)
+                f(*lfirst);
+            return true;
+        });
+    }
+
+    /// @brief 对 [first, last) 中的每个元素调用 f
+    /// @return f(可能带有累积的状态)
+    template<typename InputIter, typename Function>
+    Function for_each(InputIter first, InputIter last, Function f)
+    {
+        for_each_segment_cat(first, last, f, is_segmented_iterator<InputIter>());
+        return f;
+    }
+
+    /// ================================================================================================================
+    /// @brief transform
+    /// ================================================================================================================
+
+    /// @brief 把 op(*it) 依次写入 result
+    template<typename InputIter, typename OutputIter, typename UnaryOperation>
+    OutputIter transform(InputIter first, InputIter last, OutputIter result, UnaryOperation op)
+    {
+        for (; first != last; ++first, ++result)
+            *result = op(*first);
+        return result;
+    }
+
+    /// @brief 把 op(*it1, *it2) 依次写入 result，第二个区间至少与第一个一样长
+    template<typename InputIter1, typename InputIter2, typename OutputIter, typename BinaryOperation>
+    OutputIter transform(InputIter1 first1, InputIter1 last1, InputIter2 first2, OutputIter result, BinaryOperation op)
+    {
+        for (; first1 != last1; ++first1, ++first2, ++result)
+            *result = op(*first1, *first2);
+        return result;
+    }
+
+    /// ================================================================================================================
+    /// @brief rotate
+    /// ================================================================================================================
+
+    /**
+     * @brief 交换 [first, middle) 与 [middle, last) 两段的位置，各段内部顺序不变
+     * @return 原来的 *first 的新位置
+     * @note 三次反转实现，每个元素恰好交换常数次
+     * */
+    template<typename BidirectionalIter>
+    BidirectionalIter rotate(BidirectionalIter first, BidirectionalIter middle, BidirectionalIter last)
+    {
+        if (first == middle) return last;
+        if (middle == last) return first;
+        BidirectionalIter result = first;
+        mystl::advance(result, mystl::distance(middle, last));
+        mystl::reverse(first, middle);
+        mystl::reverse(middle, last);
+        mystl::reverse(first, last);
+        return result;
+    }
+
+    /// ================================================================================================================
+    /// @brief lower_bound / upper_bound
+    /// ================================================================================================================
+
+    /// @brief 有序区间中第一个不小于 value 的位置
+    template<typename ForwardIter, typename T, typename Compare>
+    ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T &value, Compare comp)
+    {
+        auto len = mystl::distance(first, last);
+        while (len > 0)
+        {
+            const auto half = len / 2;
+            ForwardIter mid = first;
+            mystl::advance(mid, half);
+            if (comp(*mid, value))
+            {
+                first = ++mid;
+                len -= half + 1;
+            }
+            else
+            {
+                len = half;
+            }
+        }
+        return first;
+    }
+
+    template<typename ForwardIter, typename T>
+    ForwardIter lower_bound(ForwardIter first, ForwardIter last, const T &value)
+    {
+        return mystl::lower_bound(first, last, value, mystl::less<T>());
+    }
+
+    /// @brief 有序区间中第一个大于 value 的位置
+    template<typename ForwardIter, typename T, typename Compare>
+    ForwardIter upper_bound(ForwardIter first, ForwardIter last, const T &value, Compare comp)
+    {
+        auto len = mystl::distance(first, last);
+        while (len > 0)
+        {
+            const auto half = len / 2;
+            ForwardIter mid = first;
+            mystl::advance(mid, half);
+            if (comp(value, *mid))
+            {
+                len = half;
+            }
+            else
+            {
+                first = ++mid;
+                len -= half + 1;
+            }
+        }
+        return first;
+    }
+
+    template<typename ForwardIter, typename T>
+    ForwardIter upper_bound(ForwardIter first, ForwardIter last, const T &value)
+    {
+        return mystl::upper_bound(first, last, value, mystl::less<T>());
+    }
+
+    /// ================================================================================================================
+    /// @brief heap 算法：push_heap / pop_heap / make_heap / sort_heap / is_heap
+    /// ================================================================================================================
+
+    /**
+     * @brief [first, last) 按 comp 组织成二叉最大堆，下标 i 的孩子为 2i+1 和 2i+2
+     * @note 只支持随机访问迭代器，mystl::vector 与 mystl::deque 都可以使用
+     * @note 所有调整都在路径上移动一个空位(hole)，每层只做一次移动赋值，而不是交换
+     * */
+
+    /// @brief 把 value 放入空位 hole 并向上调整，不越过 top
+    template<typename RandomIter, typename Distance, typename T, typename Compare>
+    void push_heap_aux(RandomIter first, Distance hole, Distance top, T value, Compare comp)
+    {
+        Distance parent = (hole - 1) / 2;
+        while (hole > top && comp(*(first + parent), value))
+        {
+            *(first + hole) = mystl::move(*(first + parent));
+            hole = parent;
+            parent = (hole - 1) / 2;
+        }
+        *(first + hole) = mystl::move(value);
+    }
+
+    /**
+     * @brief 以 hole 为根、大小为 len 的子堆在 hole 处有一个空位，把 value 放进去
+     * @note 空位先沿较大的孩子一路下沉到叶子(每层一次比较)，再让 value 从叶子向上调整。
+     * @note 被放入的值通常来自堆尾，很可能本来就属于底层，这样比逐层同时与两个孩子比较少用约一半的比较
+     * */
+    template<typename RandomIter, typename Distance, typename T, typename Compare>
+    void adjust_heap(RandomIter first, Distance hole, Distance len, T value, Compare comp)
+    {
+        const Distance top = hole;
+        Distance child = 2 * hole + 2;
+        while (child < len)
+        {
+            if (comp(*(first + child), *(first + (child - 1))))
+                --child;
+            *(first + hole) = mystl::move(*(first + child));
+            hole = child;
+            child = 2 * child + 2;
+        }
+        if (child == len)
+        {
+            // 只有左孩子
+            *(first + hole) = mystl::move(*(first + (child - 1)));
+            hole = child - 1;
+        }
+        mystl::push_heap_aux(first, hole, top, mystl::move(value), comp);
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief push_heap [first, last - 1) 已经是堆，把 *(last - 1) 加入堆
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    template<typename RandomIter, typename Compare>
+    void push_heap_dispatch(RandomIter first, RandomIter last, Compare comp, random_access_iterator_tag)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        const Distance hole = last - first - 1;
+        if (hole <= 0) return;
+        T value = mystl::move(*(first + hole));
+        mystl::push_heap_aux(first, hole, Distance(0), mystl::move(value), comp);
+    }
+
+    template<typename RandomIter, typename Compare>
+    void push_heap(RandomIter first, RandomIter last, Compare comp)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "push_heap requires random access iterators");
+        mystl::push_heap_dispatch(first, last, comp, iterator_category(first));
+    }
+
+    template<typename RandomIter>
+    void push_heap(RandomIter first, RandomIter last)
+    {
+        mystl::push_heap(first, last, mystl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief pop_heap 把堆顶移到 *(last - 1)，[first, last - 1) 重新成为堆
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    template<typename RandomIter, typename Compare>
+    void pop_heap_dispatch(RandomIter first, RandomIter last, Compare comp, random_access_iterator_tag)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        const Distance len = last - first - 1;
+        if (len <= 0) return;
+        // 堆尾的值暂存，堆顶直接移动到堆尾，堆顶留下空位
+        T value = mystl::move(*(first + len));
+        *(first + len) = mystl::move(*first);
+        mystl::adjust_heap(first, Distance(0), len, mystl::move(value), comp);
+    }
+
+    template<typename RandomIter, typename Compare>
+    void pop_heap(RandomIter first, RandomIter last, Compare comp)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "pop_heap requires random access iterators");
+        mystl::pop_heap_dispatch(first, last, comp, iterator_category(first));
+    }
+
+    template<typename RandomIter>
+    void pop_heap(RandomIter first, RandomIter last)
+    {
+        mystl::pop_heap(first, last, mystl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief make_heap Floyd 自底向上建堆：从最后一个非叶节点开始逐个调整，总代价 O(n)
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    template<typename RandomIter, typename Compare>
+    void make_heap_dispatch(RandomIter first, RandomIter last, Compare comp, random_access_iterator_tag)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        const Distance len = last - first;
+        if (len < 2) return;
+        for (Distance parent = (len - 2) / 2; parent >= 0; --parent)
+        {
+            T value = mystl::move(*(first + parent));
+            mystl::adjust_heap(first, parent, len, mystl::move(value), comp);
+        }
+    }
+
+    template<typename RandomIter, typename Compare>
+    void make_heap(RandomIter first, RandomIter last, Compare comp)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "make_heap requires random access iterators");
+        mystl::make_heap_dispatch(first, last, comp, iterator_category(first));
+    }
+
+    template<typename RandomIter>
+    void make_heap(RandomIter first, RandomIter last)
+    {
+        mystl::make_heap(first, last, mystl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief sort_heap 不断把堆顶移到末尾，得到按 comp 升序排列的区间
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    template<typename RandomIter, typename Compare>
+    void sort_heap_dispatch(RandomIter first, RandomIter last, Compare comp, random_access_iterator_tag)
+    {
+        while (last - first > 1)
+            mystl::pop_heap_dispatch(first, last--, comp, random_access_iterator_tag());
+    }
+
+    template<typename RandomIter, typename Compare>
+    void sort_heap(RandomIter first, RandomIter last, Compare comp)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "sort_heap requires random access iterators");
+        mystl::sort_heap_dispatch(first, last, comp, iterator_category(first));
+    }
+
+    template<typename RandomIter>
+    void sort_heap(RandomIter first, RandomIter last)
+    {
+        mystl::sort_heap(first, last, mystl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief is_heap_until / is_heap
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    /// @brief 返回最长的堆前缀 [first, result) 的尾部
+    template<typename RandomIter, typename Compare>
+    RandomIter is_heap_until(RandomIter first, RandomIter last, Compare comp)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "is_heap_until requires random access iterators");
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance len = last - first;
+        for (Distance child = 1; child < len; ++child)
+        {
+            if (comp(*(first + (child - 1) / 2), *(first + child)))
+                return first + child;
+        }
+        return last;
+    }
+
+    template<typename RandomIter>
+    RandomIter is_heap_until(RandomIter first, RandomIter last)
+    {
+        return mystl::is_heap_until(first, last, mystl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    template<typename RandomIter, typename Compare>
+    bool is_heap(RandomIter first, RandomIter last, Compare comp)
+    {
+        return mystl::is_heap_until(first, last, comp) == last;
+    }
+
+    template<typename RandomIter>
+    bool is_heap(RandomIter first, RandomIter last)
+    {
+        return mystl::is_heap_until(first, last) == last;
+    }
+
+    /// ================================================================================================================
+    /// @brief sort 内省排序
+    /// ================================================================================================================
+
+    /**
+     * @brief 以快速排序为主体，并借鉴 pattern-defeating quicksort 的改进：
+     * @brief 1. 小区间(< sort_threshold)用插入排序，非最左侧的区间左边有哨兵，可以用无边界检查的版本
+     * @brief 2. 区间较大时用 Tukey ninther(九数取中)选枢轴，否则用三数取中
+     * @brief 3. 划分严重不平衡时打乱几个元素破坏输入中的模式；不平衡次数超过 log2(n) 时改用堆排序，保证 O(n log n)
+     * @brief 4. 划分时没有发生交换说明区间可能已经有序，尝试有限次数的插入排序直接结束
+     * @brief 5. 大量与上一个枢轴相等的元素会被一次性划到左侧，重复元素多时接近线性
+     * @brief 6. 算术类型配合 mystl::less / mystl::greater 时使用无分支的块划分(BlockQuicksort)，避免分支预测失败
+     * */
+
+    /// @brief 插入排序阈值
+    constexpr ptrdiff_t sort_threshold = 24;
+    /// @brief 超过该长度时使用 ninther 选取枢轴
+    constexpr ptrdiff_t sort_ninther_threshold = 128;
+    /// @brief 尝试对“可能有序”的区间做插入排序时，最多允许移动的元素个数
+    constexpr ptrdiff_t sort_partial_insertion_limit = 8;
+    /// @brief 无分支划分中每块的元素个数，偏移量用 unsigned char 保存
+    constexpr ptrdiff_t sort_block_size = 64;
+
+    /// @brief 算术类型且比较器是已知的简单比较时，比较结果可以无分支地使用
+    template<typename T, typename Compare>
+    struct is_branchless_sortable
+            : public std::integral_constant<bool, std::is_arithmetic<T>::value &&
+                                                  (std::is_same<Compare, mystl::less<T>>::value ||
+                                                   std::is_same<Compare, mystl::greater<T>>::value)>
+    {
+    };
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief 插入排序
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    template<typename RandomIter, typename Compare>
+    void insertion_sort(RandomIter first, RandomIter last, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        if (first == last) return;
+        for (RandomIter i = first + 1; i != last; ++i)
+        {
+            RandomIter hole = i;
+            RandomIter prev = i - 1;
+            if (comp(*hole, *prev))
+            {
+                T value = mystl::move(*hole);
+                do
+                {
+                    *hole = mystl::move(*prev);
+                    hole = prev;
+                } while (hole != first && comp(value, *--prev));
+                *hole = mystl::move(value);
+            }
+        }
+    }
+
+    /// @brief 要求 *(first - 1) 不大于区间内任何元素，因此向前移动时不需要检查边界
+    template<typename RandomIter, typename Compare>
+    void unguarded_insertion_sort(RandomIter first, RandomIter last, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        if (first == last) return;
+        for (RandomIter i = first + 1; i != last; ++i)
+        {
+            RandomIter hole = i;
+            RandomIter prev = i - 1;
+            if (comp(*hole, *prev))
+            {
+                T value = mystl::move(*hole);
+                do
+                {
+                    *hole = mystl::move(*prev);
+                    hole = prev;
+                } while (comp(value, *--prev));
+                *hole = mystl::move(value);
+            }
+        }
+    }
+
+    /// @brief 插入排序，但累计移动超过 sort_partial_insertion_limit 个元素时放弃并返回 false(区间内容仍是原元素的一个排列)
+    template<typename RandomIter, typename Compare>
+    bool partial_insertion_sort(RandomIter first, RandomIter last, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        if (first == last) return true;
+        ptrdiff_t moved = 0;
+        for (RandomIter i = first + 1; i != last; ++i)
+        {
+            RandomIter hole = i;
+            RandomIter prev = i - 1;
+            if (comp(*hole, *prev))
+            {
+                T value = mystl::move(*hole);
+                do
+                {
+                    *hole = mystl::move(*prev);
+                    hole = prev;
+                } while (hole != first && comp(value, *--prev));
+                *hole = mystl::move(value);
+                moved += i - hole;
+                if (moved > sort_partial_insertion_limit)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief 选取枢轴
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    /// @brief 交换使得 *a <= *b <= *c
+    template<typename RandomIter, typename Compare>
+    void sort3(RandomIter a, RandomIter b, RandomIter c, Compare comp)
+    {
+        if (comp(*b, *a)) mystl::iter_swap(a, b);
+        if (comp(*c, *b)) mystl::iter_swap(b, c);
+        if (comp(*b, *a)) mystl::iter_swap(a, b);
+    }
+
+    /**
+     * @brief 把枢轴放到 *first
+     * @note 选取之后区间右侧一定存在不小于枢轴的元素，划分时向右的扫描因此不需要边界检查
+     * */
+    template<typename RandomIter, typename Compare>
+    void choose_pivot(RandomIter first, RandomIter last, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance len = last - first;
+        const Distance half = len / 2;
+        if (len > sort_ninther_threshold)
+        {
+            mystl::sort3(first, first + half, last - 1, comp);
+            mystl::sort3(first + 1, first + (half - 1), last - 2, comp);
+            mystl::sort3(first + 2, first + (half + 1), last - 3, comp);
+            mystl::sort3(first + (half - 1), first + half, first + (half + 1), comp);
+            mystl::iter_swap(first, first + half);
+        }
+        else
+        {
+            mystl::sort3(first + half, first, last - 1, comp);
+        }
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief 划分
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    /**
+     * @brief 以 *first 为枢轴划分，小于枢轴的元素在左侧，其余在右侧
+     * @return 枢轴的最终位置，以及划分前区间是否已经是划分好的(没有发生交换)
+     * */
+    template<typename RandomIter, typename Compare>
+    mystl::pair<RandomIter, bool> partition_right(RandomIter first, RandomIter last, Compare comp, std::false_type)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        const RandomIter begin = first;
+        T pivot = mystl::move(*first);
+        while (comp(*++first, pivot));
+        // 左侧没有越过任何元素时，向左的扫描没有哨兵
+        if (first - 1 == begin)
+            while (first < last && !comp(*--last, pivot));
+        else
+            while (!comp(*--last, pivot));
+        const bool already_partitioned = first >= last;
+        while (first < last)
+        {
+            mystl::iter_swap(first, last);
+            while (comp(*++first, pivot));
+            while (!comp(*--last, pivot));
+        }
+        const RandomIter pivot_pos = first - 1;
+        *begin = mystl::move(*pivot_pos);
+        *pivot_pos = mystl::move(pivot);
+        return mystl::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+    }
+
+    /// @brief 把两个偏移块中记录的 num 对元素互换；数量相等时逐对交换，否则用一次轮转减少一半的移动
+    template<typename RandomIter>
+    void swap_offsets(RandomIter left_base, RandomIter right_base, const unsigned char *left,
+                      const unsigned char *right, ptrdiff_t num, bool use_swaps)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        if (use_swaps)
+        {
+            // 降序输入中每对元素都需要真正的交换，否则会退化
+            for (ptrdiff_t i = 0; i < num; ++i)
+                mystl::iter_swap(left_base + left[i], right_base - right[i]);
+        }
+        else if (num > 0)
+        {
+            RandomIter l = left_base + left[0];
+            RandomIter r = right_base - right[0];
+            T tmp = mystl::move(*l);
+            *l = mystl::move(*r);
+            for (ptrdiff_t i = 1; i < num; ++i)
+            {
+                l = left_base + left[i];
+                *r = mystl::move(*l);
+                r = right_base - right[i];
+                *l = mystl::move(*r);
+            }
+            *r = mystl::move(tmp);
+        }
+    }
+
+    /**
+     * @brief partition_right 的无分支版本(BlockQuicksort，Edelkamp & Weiss)
+     * @note 两端各取一块元素，把“站错边”的元素偏移量写入缓冲区，写入位置只依赖比较结果的累加，
+     * @note 循环体中没有依赖数据的分支；之后再按偏移量成对交换
+     * */
+    template<typename RandomIter, typename Compare>
+    mystl::pair<RandomIter, bool> partition_right(RandomIter first, RandomIter last, Compare comp, std::true_type)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        const RandomIter begin = first;
+        T pivot = mystl::move(*first);
+        while (comp(*++first, pivot));
+        if (first - 1 == begin)
+            while (first < last && !comp(*--last, pivot));
+        else
+            while (!comp(*--last, pivot));
+        const bool already_partitioned = first >= last;
+        if (!already_partitioned)
+        {
+            mystl::iter_swap(first, last);
+            ++first;
+
+            // 以下 [first, last) 为未处理的元素
+            unsigned char offsets_l[sort_block_size];
+            unsigned char offsets_r[sort_block_size];
+            RandomIter base_l = first;
+            RandomIter base_r = last;
+            ptrdiff_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+            while (first < last)
+            {
+                // 只有偏移块用完的一侧才继续取元素，剩余不足两块时两侧平分
+                const ptrdiff_t unknown = last - first;
+                const ptrdiff_t split_l = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0;
+                const ptrdiff_t split_r = num_r == 0 ? unknown - split_l : 0;
+
+                const ptrdiff_t block_l = split_l < sort_block_size ? split_l : sort_block_size;
+                for (ptrdiff_t i = 0; i < block_l; ++i)
+                {
+                    offsets_l[num_l] = static_cast<unsigned char>(i);
+                    num_l += !comp(*first, pivot);
+                    ++first;
+                }
+                const ptrdiff_t block_r = split_r < sort_block_size ? split_r : sort_block_size;
+                for (ptrdiff_t i = 0; i < block_r; ++i)
+                {
+                    // 右侧偏移从 1 开始：base_r - offset 指向元素
+                    offsets_r[num_r] = static_cast<unsigned char>(i + 1);
+                    num_r += comp(*--last, pivot);
+                }
+
+                const ptrdiff_t num = num_l < num_r ? num_l : num_r;
+                mystl::swap_offsets(base_l, base_r, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+                num_l -= num;
+                num_r -= num;
+                start_l += num;
+                start_r += num;
+                if (num_l == 0)
+                {
+                    start_l = 0;
+                    base_l = first;
+                }
+                if (num_r == 0)
+                {
+                    start_r = 0;
+                    base_r = last;
+                }
+            }
+
+            // 最多还有一侧留有站错边的元素，把它们逐个交换到中间
+            if (num_l > 0)
+            {
+                while (num_l--)
+                    mystl::iter_swap(base_l + offsets_l[start_l + num_l], --last);
+                first = last;
+            }
+            if (num_r > 0)
+            {
+                while (num_r--)
+                {
+                    mystl::iter_swap(base_r - offsets_r[start_r + num_r], first);
+                    ++first;
+                }
+            }
+        }
+        const RandomIter pivot_pos = first - 1;
+        *begin = mystl::move(*pivot_pos);
+        *pivot_pos = mystl::move(pivot);
+        return mystl::pair<RandomIter, bool>(pivot_pos, already_partitioned);
+    }
+
+    /**
+     * @brief 以 *first 为枢轴划分，不大于枢轴的元素在左侧；要求 *(first - 1) 与枢轴相等，
+     * @brief 此时左侧全部等于枢轴，不需要再排序
+     * @return 枢轴的最终位置
+     * */
+    template<typename RandomIter, typename Compare>
+    RandomIter partition_left(RandomIter first, RandomIter last, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        const RandomIter begin = first;
+        const RandomIter end = last;
+        T pivot = mystl::move(*first);
+        // *(first - 1) 等于枢轴，向左的扫描总会停下
+        while (comp(pivot, *--last));
+        // 右侧没有越过任何元素时，向右的扫描没有哨兵
+        if (last + 1 == end)
+            while (first < last && !comp(pivot, *++first));
+        else
+            while (!comp(pivot, *++first));
+        while (first < last)
+        {
+            mystl::iter_swap(first, last);
+            while (comp(pivot, *--last));
+            while (!comp(pivot, *++first));
+        }
+        const RandomIter pivot_pos = last;
+        *begin = mystl::move(*pivot_pos);
+        *pivot_pos = mystl::move(pivot);
+        return pivot_pos;
+    }
+
+    /// @brief 划分严重不平衡时打乱枢轴两侧的几个元素，破坏导致不平衡的输入模式
+    template<typename RandomIter>
+    void break_patterns(RandomIter first, RandomIter pivot_pos, RandomIter last)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance l_size = pivot_pos - first;
+        const Distance r_size = last - (pivot_pos + 1);
+        if (l_size >= sort_threshold)
+        {
+            mystl::iter_swap(first, first + l_size / 4);
+            mystl::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+            if (l_size > sort_ninther_threshold)
+            {
+                mystl::iter_swap(first + 1, first + (l_size / 4 + 1));
+                mystl::iter_swap(first + 2, first + (l_size / 4 + 2));
+                mystl::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+                mystl::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+            }
+        }
+        if (r_size >= sort_threshold)
+        {
+            mystl::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+            mystl::iter_swap(last - 1, last - r_size / 4);
+            if (r_size > sort_ninther_threshold)
+            {
+                mystl::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+                mystl::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+                mystl::iter_swap(last - 2, last - (1 + r_size / 4));
+                mystl::iter_swap(last - 3, last - (2 + r_size / 4));
+            }
+        }
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief introsort_loop
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    /**
+     * @param[in] bad_allowed 还允许出现的严重不平衡划分次数，用完后改用堆排序
+     * @param[in] leftmost 区间是否位于整个序列的最左侧(左侧没有可作哨兵的枢轴)
+     * */
+    template<typename RandomIter, typename Compare, typename Branchless>
+    void introsort_loop(RandomIter first, RandomIter last, Compare comp, int bad_allowed, bool leftmost,
+                        Branchless branchless)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        while (true)
+        {
+            const Distance len = last - first;
+            if (len < sort_threshold)
+            {
+                if (leftmost)
+                    mystl::insertion_sort(first, last, comp);
+                else
+                    mystl::unguarded_insertion_sort(first, last, comp);
+                return;
+            }
+
+            mystl::choose_pivot(first, last, comp);
+
+            // 上一个枢轴(在 first - 1 处)不小于新枢轴，说明两者相等：把所有等于它的元素放到左边后只处理右边
+            if (!leftmost && !comp(*(first - 1), *first))
+            {
+                first = mystl::partition_left(first, last, comp) + 1;
+                continue;
+            }
+
+            const mystl::pair<RandomIter, bool> part = mystl::partition_right(first, last, comp, branchless);
+            const RandomIter pivot_pos = part.first;
+            const Distance l_size = pivot_pos - first;
+            const Distance r_size = last - (pivot_pos + 1);
+
+            if (l_size < len / 8 || r_size < len / 8)
+            {
+                if (--bad_allowed == 0)
+                {
+                    mystl::make_heap(first, last, comp);
+                    mystl::sort_heap(first, last, comp);
+                    return;
+                }
+                mystl::break_patterns(first, pivot_pos, last);
+            }
+            else if (part.second && mystl::partial_insertion_sort(first, pivot_pos, comp) &&
+                     mystl::partial_insertion_sort(pivot_pos + 1, last, comp))
+            {
+                // 划分时没有交换且两侧都几乎有序
+                return;
+            }
+
+            // 递归处理左侧，循环处理右侧
+            mystl::introsort_loop(first, pivot_pos, comp, bad_allowed, leftmost, branchless);
+            first = pivot_pos + 1;
+            leftmost = false;
+        }
+    }
+
+    template<typename RandomIter, typename Compare>
+    void sort_dispatch(RandomIter first, RandomIter last, Compare comp, random_access_iterator_tag)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        Distance len = last - first;
+        if (len < 2) return;
+        int log2 = 0;
+        while (len >>= 1) ++log2;
+        mystl::introsort_loop(first, last, comp, log2, true,
+                              typename is_branchless_sortable<T, Compare>::type());
+    }
+
+    template<typename RandomIter, typename Compare>
+    void sort(RandomIter first, RandomIter last, Compare comp)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "sort requires random access iterators");
+        mystl::sort_dispatch(first, last, comp, iterator_category(first));
+    }
+
+    template<typename RandomIter>
+    void sort(RandomIter first, RandomIter last)
+    {
+        mystl::sort(first, last, mystl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /// ================================================================================================================
+    /// @brief radix_sort LSD 基数排序
+    /// ================================================================================================================
+
+    /**
+     * @brief 按键的字节从低到高做计数排序，共 sizeof(key) 趟，时间 O(n * sizeof(key))，稳定
+     * @note 一次遍历同时统计所有字节的直方图；某个字节在所有元素上都相同时跳过这一趟
+     * @note 在原区间与一块同样大小的缓冲区之间来回分发，缓冲区由 mystl::allocator 分配
+     * @note 支持整数、float、double 键，以及通过 key 函数对象从记录中提取的这些类型的键
+     * */
+
+    /// @brief 元素个数不超过该值时改用(稳定的)插入排序
+    constexpr size_t radix_small_threshold = 64;
+
+    /**
+     * @brief 把键映射为同样宽度的无符号整数，保持大小顺序
+     * @note 有符号整数翻转符号位；浮点数为负时按位取反，否则置符号位(-0.0 排在 +0.0 前，NaN 按位模式排在两端)
+     * */
+    template<typename Key, typename = void>
+    struct radix_traits;
+
+    template<typename Key>
+    struct radix_traits<Key, typename std::enable_if<std::is_integral<Key>::value && std::is_unsigned<Key>::value>::type>
+    {
+        typedef Key unsigned_type;
+
+        static unsigned_type encode(Key key) noexcept { return key; }
+    };
+
+    template<typename Key>
+    struct radix_traits<Key, typename std::enable_if<std::is_integral<Key>::value && std::is_signed<Key>::value>::type>
+    {
+        typedef typename std::make_unsigned<Key>::type unsigned_type;
+
+        static unsigned_type encode(Key key) noexcept
+        {
+            return static_cast<unsigned_type>(static_cast<unsigned_type>(key) ^
+                                              (unsigned_type(1) << (sizeof(Key) * 8 - 1)));
+        }
+    };
+
+    template<typename Key>
+    struct radix_traits<Key, typename std::enable_if<std::is_floating_point<Key>::value>::type>
+    {
+        static_assert(sizeof(Key) == 4 || sizeof(Key) == 8, "radix_sort supports only 32 and 64 bit floating point keys");
+
+        typedef typename std::conditional<sizeof(Key) == 4, uint32_t, uint64_t>::type unsigned_type;
+
+        static unsigned_type encode(Key key) noexcept
+        {
+            unsigned_type bits;
+            std::memcpy(&bits, &key, sizeof(bits));
+            const unsigned_type sign = unsigned_type(1) << (sizeof(Key) * 8 - 1);
+            return (bits & sign) ? static_cast<unsigned_type>(~bits) : static_cast<unsigned_type>(bits | sign);
+        }
+    };
+
+    /// @brief 把元素本身作为键
+    template<typename T>
+    struct radix_identity
+    {
+        const T &operator()(const T &value) const noexcept { return value; }
+    };
+
+    /// @brief 按编码后的键比较，用于小区间的插入排序
+    template<typename KeyOf, typename Traits>
+    struct radix_key_less
+    {
+        KeyOf key;
+
+        template<typename T>
+        bool operator()(const T &lhs, const T &rhs) const
+        {
+            return Traits::encode(key(lhs)) < Traits::encode(key(rhs));
+        }
+    };
+
+    /**
+     * @brief 基数排序的缓冲区，析构时销毁元素并归还内存
+     * @note 平凡可复制的类型直接在未初始化的内存上构造，其它类型先把整个区间移动进来(之后只做赋值)
+     * */
+    template<typename T>
+    class radix_buffer
+    {
+    private:
+        T *data_;
+        size_t size_;
+        bool constructed_;
+
+    public:
+        explicit radix_buffer(size_t n) : data_(mystl::allocator<T>::allocate(n)), size_(n), constructed_(false) {}
+
+        radix_buffer(const radix_buffer &) = delete;
+
+        radix_buffer &operator=(const radix_buffer &) = delete;
+
+        ~radix_buffer()
+        {
+            if (constructed_)
+                mystl::destroy(data_, data_ + size_);
+            mystl::allocator<T>::deallocate(data_, size_);
+        }
+
+        T *data() const noexcept { return data_; }
+
+        template<typename RandomIter>
+        void move_from(RandomIter first, RandomIter last)
+        {
+            mystl::uninitialized_move(first, last, data_);
+            constructed_ = true;
+        }
+    };
+
+    /// @brief 把 [first, first + n) 按键的第 shift / 8 个字节分发到 out，offset 为各桶的起始位置
+    template<typename InIter, typename OutIter, typename KeyOf, typename Traits>
+    void radix_scatter(InIter first, size_t n, OutIter out, KeyOf key, size_t shift, size_t *offset, Traits)
+    {
+        for (size_t i = 0; i < n; ++i, ++first)
+        {
+            const size_t digit = static_cast<size_t>((Traits::encode(key(*first)) >> shift) & 0xff);
+            *(out + offset[digit]++) = mystl::move(*first);
+        }
+    }
+
+    /// @brief 平凡可复制的元素第一次分发到未初始化的缓冲区时，直接在目标位置构造
+    template<typename InIter, typename T, typename KeyOf, typename Traits>
+    void radix_scatter_construct(InIter first, size_t n, T *out, KeyOf key, size_t shift, size_t *offset, Traits)
+    {
+        for (size_t i = 0; i < n; ++i, ++first)
+        {
+            const size_t digit = static_cast<size_t>((Traits::encode(key(*first)) >> shift) & 0xff);
+            mystl::construct(out + offset[digit]++, mystl::move(*first));
+        }
+    }
+
+    template<typename RandomIter, typename KeyOf>
+    void radix_sort_dispatch(RandomIter first, RandomIter last, KeyOf key, random_access_iterator_tag)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        typedef typename std::decay<decltype(key(*first))>::type Key;
+        typedef radix_traits<Key> traits;
+        typedef typename traits::unsigned_type U;
+        constexpr size_t digits = sizeof(U);
+        typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value> trivial;
+
+        const size_t n = static_cast<size_t>(last - first);
+        if (n < 2) return;
+        if (n <= radix_small_threshold)
+        {
+            mystl::insertion_sort(first, last, radix_key_less<KeyOf, traits>{key});
+            return;
+        }
+
+        // 一次遍历统计每个字节的直方图
+        size_t count[digits][256] = {};
+        for (RandomIter it = first; it != last; ++it)
+        {
+            const U u = traits::encode(key(*it));
+            for (size_t d = 0; d < digits; ++d)
+                ++count[d][(u >> (d * 8)) & 0xff];
+        }
+        const U first_key = traits::encode(key(*first));
+
+        // 每个字节都只落在一个桶里(例如所有键相同)时每一趟都会跳过，不必申请缓冲区
+        bool need_pass = false;
+        for (size_t d = 0; d < digits && !need_pass; ++d)
+            need_pass = count[d][(first_key >> (d * 8)) & 0xff] != n;
+        if (!need_pass) return;
+
+        radix_buffer<T> buffer(n);
+        bool in_buffer = false;      // 当前数据在缓冲区中还是在原区间中
+        bool buffer_ready = false;   // 缓冲区中是否已经有构造好的元素
+        size_t offset[256];
+        for (size_t d = 0; d < digits; ++d)
+        {
+            // 所有元素这个字节都相同，这一趟不改变顺序
+            if (count[d][(first_key >> (d * 8)) & 0xff] == n)
+                continue;
+            size_t sum = 0;
+            for (size_t b = 0; b < 256; ++b)
+            {
+                offset[b] = sum;
+                sum += count[d][b];
+            }
+            if (in_buffer)
+            {
+                mystl::radix_scatter(buffer.data(), n, first, key, d * 8, offset, traits());
+            }
+            else if (buffer_ready)
+            {
+                mystl::radix_scatter(first, n, buffer.data(), key, d * 8, offset, traits());
+            }
+            else if (trivial::value)
+            {
+                mystl::radix_scatter_construct(first, n, buffer.data(), key, d * 8, offset, traits());
+                buffer_ready = true;
+            }
+            else
+            {
+                // 先把元素整体移入缓冲区，再从缓冲区分发回原区间，此后两边都只需要赋值
+                buffer.move_from(first, last);
+                buffer_ready = true;
+                mystl::radix_scatter(buffer.data(), n, first, key, d * 8, offset, traits());
+                continue;
+            }
+            in_buffer = !in_buffer;
+        }
+        if (in_buffer)
+            mystl::move(buffer.data(), buffer.data() + n, first);
+    }
+
+    /// @brief 按 key(元素) 的值对 [first, last) 稳定地升序排序，键必须是整数或浮点数
+    template<typename RandomIter, typename KeyOf>
+    void radix_sort(RandomIter first, RandomIter last, KeyOf key)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "radix_sort requires random access iterators");
+        mystl::radix_sort_dispatch(first, last, key, iterator_category(first));
+    }
+
+    template<typename RandomIter>
+    void radix_sort(RandomIter first, RandomIter last)
+    {
+        mystl::radix_sort(first, last, radix_identity<typename iterator_traits<RandomIter>::value_type>());
+    }
+
+    /// ================================================================================================================
+    /// @brief stable_sort 自适应归并排序
+    /// ================================================================================================================
+
+    /**
+     * @brief TimSort：从左到右识别已有的有序段(严格降序的段就地反转)，过短的段用二分插入排序补足到 minrun，
+     * @brief 各段压栈后按长度不变式合并，基本有序的输入只需要 O(n) 次比较
+     * @note 合并前先二分剪掉两段首尾已经就位的元素，再把较短的一段移入临时缓冲区合并；
+     * @note 某一段连续胜出 min_gallop 次后进入飞奔(galloping)模式，用指数查找成块移动
+     * @note 缓冲区由 temporary_buffer 通过 mystl::allocator 申请，最多 n / 2 个元素；
+     * @note 申请不到足够的空间时，放不下的合并改为二分 + rotate 的就地合并，时间退化为 O(n log^2 n)
+     * */
+
+    /// @brief 短于该长度的区间直接二分插入排序；minrun 在 [stable_sort_min_merge / 2, stable_sort_min_merge] 之间
+    constexpr size_t stable_sort_min_merge = 32;
+
+    /// @brief 进入飞奔模式的初始阈值，合并过程中根据飞奔的收益增减
+    constexpr size_t stable_sort_min_gallop = 7;
+
+    /// @brief 段栈的容量：栈中段长自顶向下至少按斐波那契数列增长，64 位长度下不会超过该深度
+    constexpr size_t stable_sort_max_runs = 96;
+
+    /// @brief 选取 minrun，使 n / minrun 等于或略小于 2 的幂，最后几次合并的两段长度接近
+    inline size_t stable_sort_min_run(size_t n) noexcept
+    {
+        size_t r = 0;
+        while (n >= stable_sort_min_merge)
+        {
+            r |= n & 1;
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    /// @brief 析构时销毁缓冲区中 [first, last) 的元素
+    template<typename T>
+    struct destroy_guard
+    {
+        T *first;
+        T *last;
+
+        ~destroy_guard()
+        {
+            mystl::destroy(first, last);
+        }
+    };
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief 有序段的识别与补足
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    /**
+     * @brief 从 first 开始的有序段的长度
+     * @note 非降序段直接返回；严格降序段反转为升序(只反转严格降序段才能保持稳定)
+     * */
+    template<typename RandomIter, typename Compare>
+    typename iterator_traits<RandomIter>::difference_type
+    count_run_and_make_ascending(RandomIter first, RandomIter last, Compare comp)
+    {
+        RandomIter run_end = first + 1;
+        if (run_end == last) return 1;
+        if (comp(*run_end, *first))
+        {
+            while (++run_end != last && comp(*run_end, *(run_end - 1)));
+            mystl::reverse(first, run_end);
+        }
+        else
+        {
+            while (++run_end != last && !comp(*run_end, *(run_end - 1)));
+        }
+        return run_end - first;
+    }
+
+    /**
+     * @brief [first, sorted) 已经有序，把 [sorted, last) 逐个插入
+     * @note 一般情况下用 upper_bound 查找位置，比较次数为 O(log n)
+     * */
+    template<typename RandomIter, typename Compare>
+    void run_insertion_sort(RandomIter first, RandomIter sorted, RandomIter last, Compare comp, std::false_type)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        for (; sorted != last; ++sorted)
+        {
+            T value = mystl::move(*sorted);
+            const RandomIter pos = mystl::upper_bound(first, sorted, value, comp);
+            mystl::move_backward(pos, sorted, sorted + 1);
+            *pos = mystl::move(value);
+        }
+    }
+
+    /// @brief 比较廉价的算术类型逐个向前比较并移动，比二分查找的分支更容易预测
+    template<typename RandomIter, typename Compare>
+    void run_insertion_sort(RandomIter first, RandomIter sorted, RandomIter last, Compare comp, std::true_type)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        for (; sorted != last; ++sorted)
+        {
+            RandomIter hole = sorted;
+            if (!comp(*hole, *(hole - 1)))
+                continue;
+            T value = mystl::move(*hole);
+            do
+            {
+                *hole = mystl::move(*(hole - 1));
+                --hole;
+            } while (hole != first && comp(value, *(hole - 1)));
+            *hole = mystl::move(value);
+        }
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief 飞奔查找
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    /**
+     * @brief 与 lower_bound / upper_bound 结果相同，但先从一端以 1, 3, 7, 15... 的步长指数探查，再在最后一段中二分
+     * @note 目标离起点 k 个元素时只需要 O(log k) 次比较；_back 版本从 last 一端开始探查
+     * */
+
+    template<typename RandomIter, typename T, typename Compare>
+    RandomIter gallop_lower_bound(RandomIter first, RandomIter last, const T &value, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance n = last - first;
+        Distance prev = 0;   // [first, first + prev) 都小于 value
+        Distance cur = 0;
+        while (cur < n && comp(*(first + cur), value))
+        {
+            prev = cur + 1;
+            cur = cur * 2 + 1;
+        }
+        return mystl::lower_bound(first + prev, first + (cur < n ? cur : n), value, comp);
+    }
+
+    template<typename RandomIter, typename T, typename Compare>
+    RandomIter gallop_upper_bound(RandomIter first, RandomIter last, const T &value, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance n = last - first;
+        Distance prev = 0;   // [first, first + prev) 都不大于 value
+        Distance cur = 0;
+        while (cur < n && !comp(value, *(first + cur)))
+        {
+            prev = cur + 1;
+            cur = cur * 2 + 1;
+        }
+        return mystl::upper_bound(first + prev, first + (cur < n ? cur : n), value, comp);
+    }
+
+    template<typename RandomIter, typename T, typename Compare>
+    RandomIter gallop_lower_bound_back(RandomIter first, RandomIter last, const T &value, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance n = last - first;
+        Distance prev = 0;   // [last - prev, last) 都不小于 value
+        Distance cur = 1;
+        while (cur <= n && !comp(*(last - cur), value))
+        {
+            prev = cur;
+            cur = cur * 2 + 1;
+        }
+        return mystl::lower_bound(cur <= n ? last - (cur - 1) : first, last - prev, value, comp);
+    }
+
+    template<typename RandomIter, typename T, typename Compare>
+    RandomIter gallop_upper_bound_back(RandomIter first, RandomIter last, const T &value, Compare comp)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        const Distance n = last - first;
+        Distance prev = 0;   // [last - prev, last) 都大于 value
+        Distance cur = 1;
+        while (cur <= n && comp(value, *(last - cur)))
+        {
+            prev = cur;
+            cur = cur * 2 + 1;
+        }
+        return mystl::upper_bound(cur <= n ? last - (cur - 1) : first, last - prev, value, comp);
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief 合并
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    /**
+     * @brief 合并 [first, middle) 与 [middle, last)：第一段移入缓冲区，从前向后写回
+     * @note 写入位置永远不会越过第二段的读取位置；缓冲区先用完时第二段剩下的元素已经就位
+     * @note 相等时取第一段的元素，保持稳定
+     * */
+    template<typename RandomIter, typename T, typename Compare>
+    void merge_lo(RandomIter first, RandomIter middle, RandomIter last, T *buffer, Compare comp, size_t &min_gallop)
+    {
+        T *const buffer_end = mystl::uninitialized_move(first, middle, buffer);
+        destroy_guard<T> guard{buffer, buffer_end};
+        T *b = buffer;
+        RandomIter c = middle;
+        RandomIter dest = first;
+        while (b != buffer_end && c != last)
+        {
+            // 逐个比较，直到某一段连续胜出 min_gallop 次
+            size_t count1 = 0;
+            size_t count2 = 0;
+            do
+            {
+                if (comp(*c, *b))
+                {
+                    *dest = mystl::move(*c);
+                    ++dest;
+                    ++c;
+                    ++count2;
+                    count1 = 0;
+                    if (c == last) break;
+                }
+                else
+                {
+                    *dest = mystl::move(*b);
+                    ++dest;
+                    ++b;
+                    ++count1;
+                    count2 = 0;
+                    if (b == buffer_end) break;
+                }
+            } while ((count1 | count2) < min_gallop);
+            if (b == buffer_end || c == last) break;
+
+            // 飞奔：第一段中不大于 *c 的元素、第二段中小于 *b 的元素各成块移动
+            while (true)
+            {
+                T *const p = mystl::gallop_upper_bound(b, buffer_end, *c, comp);
+                const size_t run1 = static_cast<size_t>(p - b);
+                dest = mystl::move(b, p, dest);
+                b = p;
+                if (b == buffer_end) break;
+                *dest++ = mystl::move(*c++);
+                if (c == last) break;
+
+                const RandomIter q = mystl::gallop_lower_bound(c, last, *b, comp);
+                const size_t run2 = static_cast<size_t>(q - c);
+                dest = mystl::move(c, q, dest);
+                c = q;
+                if (c == last) break;
+                *dest++ = mystl::move(*b++);
+                if (b == buffer_end) break;
+
+                if (run1 < stable_sort_min_gallop && run2 < stable_sort_min_gallop)
+                {
+                    // 飞奔的收益不大，回到逐个比较并提高下次进入的门槛
+                    min_gallop += 2;
+                    break;
+                }
+                if (min_gallop > 1)
+                    --min_gallop;
+            }
+        }
+        mystl::move(b, buffer_end, dest);
+    }
+
+    /**
+     * @brief 合并 [first, middle) 与 [middle, last)：第二段移入缓冲区，从后向前写回
+     * @note 与 merge_lo 对称；相等时先写出(即放在后面的)第二段的元素，保持稳定
+     * */
+    template<typename RandomIter, typename T, typename Compare>
+    void merge_hi(RandomIter first, RandomIter middle, RandomIter last, T *buffer, Compare comp, size_t &min_gallop)
+    {
+        T *const buffer_end = mystl::uninitialized_move(middle, last, buffer);
+        destroy_guard<T> guard{buffer, buffer_end};
+        T *b = buffer_end;      // 缓冲区剩余 [buffer, b)
+        RandomIter c = middle;  // 第一段剩余 [first, c)
+        RandomIter dest = last;
+        while (b != buffer && c != first)
+        {
+            size_t count1 = 0;
+            size_t count2 = 0;
+            do
+            {
+                if (comp(*(b - 1), *(c - 1)))
+                {
+                    --dest;
+                    --c;
+                    *dest = mystl::move(*c);
+                    ++count1;
+                    count2 = 0;
+                    if (c == first) break;
+                }
+                else
+                {
+                    --dest;
+                    --b;
+                    *dest = mystl::move(*b);
+                    ++count2;
+                    count1 = 0;
+                    if (b == buffer) break;
+                }
+            } while ((count1 | count2) < min_gallop);
+            if (b == buffer || c == first) break;
+
+            while (true)
+            {
+                const RandomIter p = mystl::gallop_upper_bound_back(first, c, *(b - 1), comp);
+                const size_t run1 = static_cast<size_t>(c - p);
+                dest = mystl::move_backward(p, c, dest);
+                c = p;
+                if (c == first) break;
+                *--dest = mystl::move(*--b);
+                if (b == buffer) break;
+
+                T *const q = mystl::gallop_lower_bound_back(buffer, b, *(c - 1), comp);
+                const size_t run2 = static_cast<size_t>(b - q);
+                dest = mystl::move_backward(q, b, dest);
+                b = q;
+                if (b == buffer) break;
+                *--dest = mystl::move(*--c);
+                if (c == first) break;
+
+                if (run1 < stable_sort_min_gallop && run2 < stable_sort_min_gallop)
+                {
+                    min_gallop += 2;
+                    break;
+                }
+                if (min_gallop > 1)
+                    --min_gallop;
+            }
+        }
+        mystl::move_backward(buffer, b, dest);
+    }
+
+    /**
+     * @brief 较短的一段放得进缓冲区时用 merge_lo / merge_hi，否则在较长一段的中点切开，
+     * @brief 二分找到另一段的对应位置，rotate 交换中间两块后递归合并两半
+     * */
+    template<typename RandomIter, typename Distance, typename T, typename Compare>
+    void merge_adaptive(RandomIter first, RandomIter middle, RandomIter last, Distance len1, Distance len2,
+                        T *buffer, Distance buffer_size, Compare comp, size_t &min_gallop)
+    {
+        while (len1 != 0 && len2 != 0)
+        {
+            if (len1 <= len2 && len1 <= buffer_size)
+            {
+                mystl::merge_lo(first, middle, last, buffer, comp, min_gallop);
+                return;
+            }
+            if (len2 < len1 && len2 <= buffer_size)
+            {
+                mystl::merge_hi(first, middle, last, buffer, comp, min_gallop);
+                return;
+            }
+            if (len1 + len2 == 2)
+            {
+                if (comp(*middle, *first))
+                    mystl::iter_swap(first, middle);
+                return;
+            }
+
+            RandomIter cut1;
+            RandomIter cut2;
+            Distance len11;
+            Distance len22;
+            if (len1 > len2)
+            {
+                len11 = len1 / 2;
+                cut1 = first + len11;
+                cut2 = mystl::lower_bound(middle, last, *cut1, comp);
+                len22 = cut2 - middle;
+            }
+            else
+            {
+                len22 = len2 / 2;
+                cut2 = middle + len22;
+                cut1 = mystl::upper_bound(first, middle, *cut2, comp);
+                len11 = cut1 - first;
+            }
+            const RandomIter new_middle = mystl::rotate(cut1, middle, cut2);
+            mystl::merge_adaptive(first, cut1, new_middle, len11, len22, buffer, buffer_size, comp, min_gallop);
+            first = new_middle;
+            middle = cut2;
+            len1 -= len11;
+            len2 -= len22;
+        }
+    }
+
+    /// ----------------------------------------------------------------------------------------------------------------
+    /// @brief 段栈
+    /// ----------------------------------------------------------------------------------------------------------------
+
+    /**
+     * @brief 维护待合并的有序段，保证自栈顶向下 len[i - 2] > len[i - 1] + len[i] 且 len[i - 1] > len[i]
+     * @note 同时检查栈顶下面第三段(修正了原始 TimSort 只检查两段时不变式可能被破坏的问题)
+     * */
+    template<typename RandomIter, typename Compare>
+    class stable_sort_runs
+    {
+    private:
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+
+        RandomIter first_;
+        Compare comp_;
+        T *buffer_;
+        Distance buffer_size_;
+        size_t min_gallop_;
+        Distance base_[stable_sort_max_runs];   // 各段相对 first_ 的起点
+        Distance len_[stable_sort_max_runs];
+        size_t runs_;
+
+    public:
+        stable_sort_runs(RandomIter first, Compare comp, T *buffer, Distance buffer_size)
+                : first_(first), comp_(comp), buffer_(buffer), buffer_size_(buffer_size),
+                  min_gallop_(stable_sort_min_gallop), runs_(0) {}
+
+        /// @brief 压入从 base 开始的一段并合并到不变式重新成立
+        void push(Distance base, Distance len)
+        {
+            MYSTL_DEBUG(runs_ < stable_sort_max_runs);
+            base_[runs_] = base;
+            len_[runs_] = len;
+            ++runs_;
+            while (runs_ > 1)
+            {
+                size_t i = runs_ - 2;
+                if ((i > 0 && len_[i - 1] <= len_[i] + len_[i + 1]) ||
+                    (i > 1 && len_[i - 2] <= len_[i - 1] + len_[i]))
+                {
+                    if (len_[i - 1] < len_[i + 1])
+                        --i;
+                }
+                else if (len_[i] > len_[i + 1])
+                {
+                    break;
+                }
+                merge_at(i);
+            }
+        }
+
+        /// @brief 把栈中所有段合并为一段
+        void collapse()
+        {
+            while (runs_ > 1)
+            {
+                size_t i = runs_ - 2;
+                if (i > 0 && len_[i - 1] < len_[i + 1])
+                    --i;
+                merge_at(i);
+            }
+        }
+
+    private:
+        /// @brief 合并第 i 段与第 i + 1 段
+        void merge_at(size_t i)
+        {
+            RandomIter first = first_ + base_[i];
+            const RandomIter middle = first_ + base_[i + 1];
+            RandomIter last = middle + len_[i + 1];
+            len_[i] += len_[i + 1];
+            if (i + 3 == runs_)
+            {
+                base_[i + 1] = base_[i + 2];
+                len_[i + 1] = len_[i + 2];
+            }
+            --runs_;
+
+            // 第一段中不大于 *middle 的前缀、第二段中不小于 *(middle - 1) 的后缀已经就位
+            first = mystl::gallop_upper_bound(first, middle, *middle, comp_);
+            if (first == middle) return;
+            last = mystl::gallop_lower_bound_back(middle, last, *(middle - 1), comp_);
+            mystl::merge_adaptive(first, middle, last, middle - first, last - middle, buffer_, buffer_size_, comp_,
+                                  min_gallop_);
+        }
+    };
+
+    template<typename RandomIter, typename Compare>
+    void stable_sort_dispatch(RandomIter first, RandomIter last, Compare comp, random_access_iterator_tag)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        typedef typename is_branchless_sortable<T, Compare>::type cheap_compare;
+        const Distance n = last - first;
+        if (n < 2) return;
+        if (n < static_cast<Distance>(stable_sort_min_merge))
+        {
+            const Distance run = mystl::count_run_and_make_ascending(first, last, comp);
+            mystl::run_insertion_sort(first, first + run, last, comp, cheap_compare());
+            return;
+        }
+
+        // 每次合并只把较短的一段移入缓冲区，n / 2 个元素足够
+        temporary_buffer<T> buffer(static_cast<size_t>(n / 2));
+        stable_sort_runs<RandomIter, Compare> runs(first, comp, buffer.data(),
+                                                   static_cast<Distance>(buffer.size()));
+        const Distance min_run = static_cast<Distance>(mystl::stable_sort_min_run(static_cast<size_t>(n)));
+        for (Distance lo = 0; lo < n;)
+        {
+            Distance len = mystl::count_run_and_make_ascending(first + lo, last, comp);
+            if (len < min_run)
+            {
+                const Distance force = n - lo < min_run ? n - lo : min_run;
+                mystl::run_insertion_sort(first + lo, first + (lo + len), first + (lo + force), comp,
+                                          cheap_compare());
+                len = force;
+            }
+            runs.push(lo, len);
+            lo += len;
+        }
+        runs.collapse();
+    }
+
+    /// @brief 稳定排序：相等元素保持原来的相对顺序
+    template<typename RandomIter, typename Compare>
+    void stable_sort(RandomIter first, RandomIter last, Compare comp)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "stable_sort requires random access iterators");
+        mystl::stable_sort_dispatch(first, last, comp, iterator_category(first));
+    }
+
+    template<typename RandomIter>
+    void stable_sort(RandomIter first, RandomIter last)
+    {
+        mystl::stable_sort(first, last, mystl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
 }
 
 #endif //MYSTL_ALGO_H
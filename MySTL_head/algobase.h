@@ -15,6 +15,7 @@
 
 #include <cstring>
 #include "iterator.h"
+#include "simd.h"
 #include "util.h"
 
 namespace mystl
@@ -72,28 +73,57 @@ namespace mystl
     }
 
     /// ================================================================================================================
-    /// @brief fill series
+    /// @brief 分段迭代器的逐段处理
     /// ================================================================================================================
 
-    template<typename ForwardIter, typename T>
-    void fill_cat(ForwardIter first, ForwardIter last, const T &value, mystl::forward_iterator_tag)
-    {
-        for (; first != last; ++first)
+    /**
+     * @brief 把分段迭代器区间 [first, last) 拆成若干段连续的局部区间，依次调用 f(local_first, local_last)
+     * @note f 返回 false 时提前结束
+     * */
+    template<typename SegmentedIter, typename Function>
+    void for_each_segment(SegmentedIter first, SegmentedIter last, Function f)
+    {
+        typedef segmented_iterator_traits<SegmentedIter> traits;
+        auto seg = traits::segment(first);
+        const auto seg_last = traits::segment(last);
+        if (seg == seg_last)
         {
-            *first = value;
+            f(traits::local(first), traits::local(last));
+            return;
+        }
+        if (!f(traits::local(first), traits::end(seg)))
+            return;
+        for (++seg; seg != seg_last; ++seg)
+        {
+            if (!f(traits::begin(seg), traits::end(seg)))
+                return;
+        }
+        f(traits::begin(seg_last), traits::local(last));
+    }
+
+    /**
+     * @brief 从分段迭代器 first 开始的 n 个位置按段拆开，依次调用 f(local_first, local_last)
+     * @return 处理完的最后一个位置之后的迭代器；f 返回 false 时为该段的末尾
+     * */
+    template<typename SegmentedIter, typename Distance, typename Function>
+    SegmentedIter for_each_segment_n(SegmentedIter first, Distance n, Function f)
+    {
+        typedef segmented_iterator_traits<SegmentedIter> traits;
+        if (n <= 0)
+            return first;
+        auto seg = traits::segment(first);
+        auto local = traits::local(first);
+        while (true)
+        {
+            const auto room = static_cast<Distance>(traits::end(seg) - local);
+            const auto step = n < room ? n : room;
+            const auto local_last = local + step;
+            n -= step;
+            if (!f(local, local_last) || n == 0)
+                return traits::compose(seg, local_last);
+            ++seg;
+            local = traits::begin(seg);
         }
-    }
-
-    template<typename ForwardIter, typename T>
-    void fill_cat(ForwardIter first, ForwardIter last, const T &value, mystl::random_access_iterator_tag)
-    {
-        fill_n(first, last - first, value);
-    }
-
-    template<typename ForwardIter, typename T>
-    void fill(ForwardIter first, ForwardIter last, const T &value)
-    {
-        fill_cat(first, last, value, iterator_category(first));
     }
 
     /// ================================================================================================================
@@ -127,12 +157,68 @@ namespace mystl
         return first + n;
     }
 
+    /// @brief 其余可向量化的算术类型(包括 1 字节类型配合非 1 字节的值)，调用 simd::fill
+
+    template<typename T, typename Size, typename U>
+    typename std::enable_if<simd::is_vectorizable<T>::value && std::is_arithmetic<U>::value &&
+                            !(std::is_integral<T>::value && sizeof(T) == 1 &&
+                              std::is_integral<U>::value && sizeof(U) == 1 &&
+                              !std::is_same<T, bool>::value), T *>::type
+    unchecked_fill_n(T *first, Size n, U value)
+    {
+        if (n <= 0) return first;
+        return simd::fill(first, static_cast<size_t>(n), static_cast<T>(value));
+    }
+
     template<typename OutputIter, typename Size, typename T>
     OutputIter fill_n(OutputIter first, Size n, const T &value)
     {
         return unchecked_fill_n(first, n, value);
     }
 
+    /// ================================================================================================================
+    /// @brief fill series
+    /// ================================================================================================================
+
+    template<typename ForwardIter, typename T>
+    void fill_cat(ForwardIter first, ForwardIter last, const T &value, mystl::forward_iterator_tag)
+    {
+        for (; first != last; ++first)
+        {
+            *first = value;
+        }
+    }
+
+    template<typename ForwardIter, typename T>
+    void fill_cat(ForwardIter first, ForwardIter last, const T &value, mystl::random_access_iterator_tag)
+    {
+        mystl::fill_n(first, last - first, value);
+    }
+
+    template<typename ForwardIter, typename T>
+    void fill_segment(ForwardIter first, ForwardIter last, const T &value, std::false_type)
+    {
+        fill_cat(first, last, value, iterator_category(first));
+    }
+
+    /// @brief 分段迭代器逐段填充，每段是指针区间，可以走 memset / simd::fill
+    template<typename SegmentedIter, typename T>
+    void fill_segment(SegmentedIter first, SegmentedIter last, const T &value, std::true_type)
+    {
+        typedef typename segmented_iterator_traits<SegmentedIter>::local_iterator local_iterator;
+        mystl::for_each_segment(first, last, [&value](local_iterator lfirst, local_iterator llast)
+        {
+            fill_cat(lfirst, llast, value, mystl::random_access_iterator_tag());
+            return true;
+        });
+    }
+
+    template<typename ForwardIter, typename T>
+    void fill(ForwardIter first, ForwardIter last, const T &value)
+    {
+        fill_segment(first, last, value, is_segmented_iterator<ForwardIter>());
+    }
+
     /// ================================================================================================================
     /// @brief copy series
     /// ================================================================================================================
@@ -180,10 +266,58 @@ namespace mystl
         return result + n;
     }
 
+    /// @brief 只有输出是分段迭代器：随机访问的输入按输出的段切开，每段写入一个指针区间
+    template<typename RandomIter, typename SegmentedIter>
+    SegmentedIter copy_segment_out(RandomIter first, RandomIter last, SegmentedIter result,
+                                   mystl::random_access_iterator_tag)
+    {
+        typedef typename segmented_iterator_traits<SegmentedIter>::local_iterator local_iterator;
+        return mystl::for_each_segment_n(result, last - first, [&first](local_iterator lfirst, local_iterator llast)
+        {
+            const auto n = llast - lfirst;
+            mystl::unchecked_copy(first, first + n, lfirst);
+            first += n;
+            return true;
+        });
+    }
+
+    template<typename InputIter, typename SegmentedIter>
+    SegmentedIter copy_segment_out(InputIter first, InputIter last, SegmentedIter result,
+                                   mystl::input_iterator_tag)
+    {
+        return mystl::unchecked_copy(first, last, result);
+    }
+
+    template<typename InputIter, typename SegmentedIter>
+    SegmentedIter copy_segment(InputIter first, InputIter last, SegmentedIter result, std::false_type, std::true_type)
+    {
+        return copy_segment_out(first, last, result, iterator_category(first));
+    }
+
+    template<typename InputIter, typename OutputIter>
+    OutputIter copy_segment(InputIter first, InputIter last, OutputIter result, std::false_type, std::false_type)
+    {
+        return mystl::unchecked_copy(first, last, result);
+    }
+
+    /// @brief 输入是分段迭代器：每段是一个指针区间，输出端再按是否分段处理
+    template<typename SegmentedIter, typename OutputIter, typename OutputSegmented>
+    OutputIter copy_segment(SegmentedIter first, SegmentedIter last, OutputIter result, std::true_type, OutputSegmented)
+    {
+        typedef typename segmented_iterator_traits<SegmentedIter>::local_iterator local_iterator;
+        mystl::for_each_segment(first, last, [&result](local_iterator lfirst, local_iterator llast)
+        {
+            result = copy_segment(lfirst, llast, result, std::false_type(), OutputSegmented());
+            return true;
+        });
+        return result;
+    }
+
     template<typename InputIter, typename OutputIter>
     OutputIter copy(InputIter first, InputIter last, OutputIter result)
     {
-        return unchecked_copy(first, last, result);
+        return copy_segment(first, last, result, is_segmented_iterator<InputIter>(),
+                            is_segmented_iterator<OutputIter>());
     }
 
     /// ================================================================================================================
@@ -312,10 +446,58 @@ namespace mystl
         return result + n;
     }
 
+    /// @brief 只有输出是分段迭代器：随机访问的输入按输出的段切开，每段写入一个指针区间
+    template<typename RandomIter, typename SegmentedIter>
+    SegmentedIter move_segment_out(RandomIter first, RandomIter last, SegmentedIter result,
+                                   mystl::random_access_iterator_tag)
+    {
+        typedef typename segmented_iterator_traits<SegmentedIter>::local_iterator local_iterator;
+        return mystl::for_each_segment_n(result, last - first, [&first](local_iterator lfirst, local_iterator llast)
+        {
+            const auto n = llast - lfirst;
+            mystl::unchecked_move(first, first + n, lfirst);
+            first += n;
+            return true;
+        });
+    }
+
+    template<typename InputIter, typename SegmentedIter>
+    SegmentedIter move_segment_out(InputIter first, InputIter last, SegmentedIter result,
+                                   mystl::input_iterator_tag)
+    {
+        return mystl::unchecked_move(first, last, result);
+    }
+
+    template<typename InputIter, typename SegmentedIter>
+    SegmentedIter move_segment(InputIter first, InputIter last, SegmentedIter result, std::false_type, std::true_type)
+    {
+        return move_segment_out(first, last, result, iterator_category(first));
+    }
+
+    template<typename InputIter, typename OutputIter>
+    OutputIter move_segment(InputIter first, InputIter last, OutputIter result, std::false_type, std::false_type)
+    {
+        return mystl::unchecked_move(first, last, result);
+    }
+
+    /// @brief 输入是分段迭代器：每段是一个指针区间，输出端再按是否分段处理
+    template<typename SegmentedIter, typename OutputIter, typename OutputSegmented>
+    OutputIter move_segment(SegmentedIter first, SegmentedIter last, OutputIter result, std::true_type, OutputSegmented)
+    {
+        typedef typename segmented_iterator_traits<SegmentedIter>::local_iterator local_iterator;
+        mystl::for_each_segment(first, last, [&result](local_iterator lfirst, local_iterator llast)
+        {
+            result = move_segment(lfirst, llast, result, std::false_type(), OutputSegmented());
+            return true;
+        });
+        return result;
+    }
+
     template<typename InputIter, typename OutputIter>
     OutputIter move(InputIter first, InputIter last, OutputIter result)
     {
-        return unchecked_move(first, last, result);
+        return move_segment(first, last, result, is_segmented_iterator<InputIter>(),
+                            is_segmented_iterator<OutputIter>());
     }
 
     /// ================================================================================================================
@@ -374,7 +556,7 @@ namespace mystl
     /// @brief equal
     /// ================================================================================================================
     template<typename InputIter1, typename InputIter2>
-    bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2)
+    bool unchecked_equal(InputIter1 first1, InputIter1 last1, InputIter2 first2)
     {
         for (; first1 != last1; ++first1, ++first2)
         {
@@ -384,6 +566,89 @@ namespace mystl
         return true;
     }
 
+    /// @brief 连续存储的算术类型调用向量化的 simd::equal
+    template<typename Tp, typename Up>
+    typename std::enable_if<simd::is_simd_pair<Tp, Up>::value, bool>::type
+    unchecked_equal(Tp *first1, Tp *last1, Up *first2)
+    {
+        return simd::equal<typename std::remove_const<Tp>::type>(first1, first2,
+                                                                 static_cast<size_t>(last1 - first1));
+    }
+
+    /// @brief 只有第二个序列是分段迭代器且第一个序列可以随机访问：按第二个序列的段切开第一个序列
+    template<typename RandomIter, typename SegmentedIter>
+    bool equal_segment_second(RandomIter first1, RandomIter last1, SegmentedIter first2, std::true_type)
+    {
+        typedef typename segmented_iterator_traits<SegmentedIter>::local_iterator local_iterator;
+        bool result = true;
+        mystl::for_each_segment_n(first2, last1 - first1, [&first1, &result](local_iterator lfirst,
+                                                                              local_iterator llast)
+        {
+            const auto n = llast - lfirst;
+            result = mystl::unchecked_equal(first1, first1 + n, lfirst);
+            first1 += n;
+            return result;
+        });
+        return result;
+    }
+
+    template<typename InputIter, typename SegmentedIter>
+    bool equal_segment_second(InputIter first1, InputIter last1, SegmentedIter first2, std::false_type)
+    {
+        return mystl::unchecked_equal(first1, last1, first2);
+    }
+
+    template<typename InputIter1, typename SegmentedIter>
+    bool equal_segment(InputIter1 first1, InputIter1 last1, SegmentedIter first2, std::false_type, std::true_type)
+    {
+        return equal_segment_second(first1, last1, first2,
+                                    std::integral_constant<bool, is_random_access_iterator<InputIter1>::value>());
+    }
+
+    template<typename InputIter1, typename InputIter2>
+    bool equal_segment(InputIter1 first1, InputIter1 last1, InputIter2 first2, std::false_type, std::false_type)
+    {
+        return mystl::unchecked_equal(first1, last1, first2);
+    }
+
+    /// @brief 第一个序列是分段迭代器且第二个序列可以随机访问：逐段比较，每段是一个指针区间
+    template<typename SegmentedIter, typename RandomIter, typename Segmented2>
+    bool equal_segment_first(SegmentedIter first1, SegmentedIter last1, RandomIter first2, Segmented2,
+                             std::true_type)
+    {
+        typedef typename segmented_iterator_traits<SegmentedIter>::local_iterator local_iterator;
+        bool result = true;
+        mystl::for_each_segment(first1, last1, [&first2, &result](local_iterator lfirst, local_iterator llast)
+        {
+            result = equal_segment(lfirst, llast, first2, std::false_type(), Segmented2());
+            first2 += llast - lfirst;
+            return result;
+        });
+        return result;
+    }
+
+    template<typename SegmentedIter, typename InputIter, typename Segmented2>
+    bool equal_segment_first(SegmentedIter first1, SegmentedIter last1, InputIter first2, Segmented2,
+                             std::false_type)
+    {
+        return mystl::unchecked_equal(first1, last1, first2);
+    }
+
+    template<typename SegmentedIter, typename InputIter2, typename Segmented2>
+    bool equal_segment(SegmentedIter first1, SegmentedIter last1, InputIter2 first2, std::true_type, Segmented2)
+    {
+        return equal_segment_first(first1, last1, first2, Segmented2(),
+                                   std::integral_constant<bool, is_random_access_iterator<InputIter2>::value>());
+    }
+
+    /// @brief 其中一个序列是分段迭代器时逐段比较，另一个序列需要是 mystl 的随机访问迭代器(用来整段跳过)，否则逐个比较
+    template<typename InputIter1, typename InputIter2>
+    bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2)
+    {
+        return equal_segment(first1, last1, first2, is_segmented_iterator<InputIter1>(),
+                             is_segmented_iterator<InputIter2>());
+    }
+
     template<typename InputIter1, typename InputIter2, typename Compared>
     bool equal(InputIter1 first1, InputIter1 last1, InputIter2 first2, Compared comp)
     {
@@ -395,6 +660,44 @@ namespace mystl
         return true;
     }
 
+    /// ================================================================================================================
+    /// @brief mismatch
+    /// ================================================================================================================
+
+    /// @brief 返回两个序列第一个不相等的位置
+    template<typename InputIter1, typename InputIter2>
+    mystl::pair<InputIter1, InputIter2> mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2)
+    {
+        while (first1 != last1 && *first1 == *first2)
+        {
+            ++first1;
+            ++first2;
+        }
+        return mystl::pair<InputIter1, InputIter2>(first1, first2);
+    }
+
+    template<typename InputIter1, typename InputIter2, typename Compared>
+    mystl::pair<InputIter1, InputIter2>
+    mismatch(InputIter1 first1, InputIter1 last1, InputIter2 first2, Compared comp)
+    {
+        while (first1 != last1 && comp(*first1, *first2))
+        {
+            ++first1;
+            ++first2;
+        }
+        return mystl::pair<InputIter1, InputIter2>(first1, first2);
+    }
+
+    /// @brief 连续存储的算术类型调用向量化的 simd::mismatch
+    template<typename Tp, typename Up>
+    typename std::enable_if<simd::is_simd_pair<Tp, Up>::value, mystl::pair<Tp *, Up *>>::type
+    mismatch(Tp *first1, Tp *last1, Up *first2)
+    {
+        const size_t i = simd::mismatch<typename std::remove_const<Tp>::type>(first1, first2,
+                                                                              static_cast<size_t>(last1 - first1));
+        return mystl::pair<Tp *, Up *>(first1 + i, first2 + i);
+    }
+
     /// ================================================================================================================
     /// @brief lexicographical_compare
     /// ================================================================================================================
@@ -427,17 +730,27 @@ namespace mystl
         return first1 == last1 && first2 != last2;
     }
 
-    bool lexicographical_compare(const unsigned char *first1, const unsigned char *last1,
+    inline bool lexicographical_compare(const unsigned char *first1, const unsigned char *last1,
                                  const unsigned char *first2, const unsigned char *last2)
     {
         const auto len1 = last1 - first1;
         const auto len2 = last2 - first2;
-        // 先比较相同长度的部分
-        const auto result = std::memcmp(first1, first2, mystl::min(len1, len2));
+        // 先比较相同长度的部分，长度为 0 时指针可能为空，不能传给 memcmp
+        const auto len = mystl::min(len1, len2);
+        const auto result = len == 0 ? 0 : std::memcmp(first1, first2, len);
         // 若相等，长度较长的比较大
         return result != 0 ? result < 0 : len1 < len2;
     }
 
+    /// @brief 其余连续存储的算术类型先用 simd::mismatch 跳过相同的前缀
+    template<typename Tp, typename Up>
+    typename std::enable_if<simd::is_simd_pair<Tp, Up>::value, bool>::type
+    lexicographical_compare(Tp *first1, Tp *last1, Up *first2, Up *last2)
+    {
+        return simd::lexicographical_compare<typename std::remove_const<Tp>::type>(
+                first1, static_cast<size_t>(last1 - first1), first2, static_cast<size_t>(last2 - first2));
+    }
+
 }
 
 #endif //MYSTL_ALGOBASE_H
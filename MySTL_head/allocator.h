@@ -14,10 +14,108 @@
 #define MYSTL_ALLOCATOR_H
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
 #include "construct.h"
+#include "exceptdef.h"
 
 namespace mystl
 {
+    /// ================================================================================================================
+    /// @brief 带大小/对齐信息的原始内存分配与回收
+    /// ================================================================================================================
+
+    /**
+     * @brief operator new 默认保证的对齐，超过它的类型(例如 32/64 字节对齐的 SIMD 结构体)需要额外处理
+     * */
+
+#ifdef __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    constexpr size_t default_new_alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+    constexpr size_t default_new_alignment = alignof(std::max_align_t);
+#endif
+
+    /**
+     * @brief 分配 bytes 字节、按 alignment 对齐的内存
+     * @note 支持 aligned new(C++17)时直接调用 operator new(size_t, align_val_t)；
+     *       否则多申请 alignment + sizeof(void*) 字节，手动对齐并在返回地址之前保存原始指针
+     * */
+
+    inline void *allocate_bytes(size_t bytes, size_t alignment)
+    {
+        if (alignment <= default_new_alignment)
+            return ::operator new(bytes);
+#ifdef __cpp_aligned_new
+        return ::operator new(bytes, static_cast<std::align_val_t>(alignment));
+#else
+        THROW_LENGTH_ERROR_IF(bytes > static_cast<size_t>(-1) - alignment - sizeof(void *),
+                              "mystl::allocate_bytes size too big");
+        void *raw = ::operator new(bytes + alignment + sizeof(void *));
+        const auto addr = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *);
+        void *aligned = reinterpret_cast<void *>((addr + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1));
+        static_cast<void **>(aligned)[-1] = raw;
+        return aligned;
+#endif
+    }
+
+    /**
+     * @brief 回收由 allocate_bytes 分配的内存，bytes 和 alignment 必须与分配时相同
+     * @note 编译器支持 sized deallocation 时把大小传给 operator delete，分配器可以跳过查找块大小
+     * */
+
+    inline void deallocate_bytes(void *ptr, size_t bytes, size_t alignment) noexcept
+    {
+        if (alignment <= default_new_alignment)
+        {
+#ifdef __cpp_sized_deallocation
+            ::operator delete(ptr, bytes);
+#else
+            (void) bytes;
+            ::operator delete(ptr);
+#endif
+            return;
+        }
+#ifdef __cpp_aligned_new
+        ::operator delete(ptr, bytes, static_cast<std::align_val_t>(alignment));
+#else
+        (void) bytes;
+        ::operator delete(static_cast<void **>(ptr)[-1]);
+#endif
+    }
+
+    /**
+     * @brief 把请求的字节数向上取整到主流 malloc 的尺寸粒度：小块按 16 字节，大块(>= 128KiB，通常走 mmap)按页
+     * @note 取整后的空间底层分配器本来就会占用，直接申请并交给容器使用不会多消耗内存
+     * */
+
+    inline size_t good_alloc_size(size_t bytes) noexcept
+    {
+        constexpr size_t small_granule = 16;
+        constexpr size_t page_size = 4096;
+        constexpr size_t large_threshold = 128 * 1024;
+        if (bytes > static_cast<size_t>(-1) - page_size) return bytes;
+        if (bytes < large_threshold)
+            return (bytes + small_granule - 1) & ~(small_granule - 1);
+        return (bytes + page_size - 1) & ~(page_size - 1);
+    }
+
+    /// ================================================================================================================
+    /// @brief allocate_at_least 的返回值：分配到的指针以及实际可用的元素个数
+    /// ================================================================================================================
+
+    template<typename Pointer, typename SizeType = size_t>
+    struct allocation_result
+    {
+        Pointer ptr;
+        SizeType count;
+    };
+
+    /// ================================================================================================================
+    /// @brief 模板类 allocator
+    /// ================================================================================================================
+
     template<typename T>
     class allocator
     {
@@ -30,7 +128,29 @@ namespace mystl
         typedef size_t size_type;
         typedef ptrdiff_t difference_type;
 
+        /// @brief allocator 不含状态，任意两个实例都相等，移动赋值时随容器一起传播
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type is_always_equal;
+
+        /// @brief 将 allocator<T> 重新绑定为 allocator<U>
+        template<typename U>
+        struct rebind
+        {
+            typedef allocator<U> other;
+        };
+
     public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        allocator() noexcept = default;
+
+        allocator(const allocator &) noexcept = default;
+
+        template<typename U>
+        allocator(const allocator<U> &) noexcept {}
+
         /// ------------------------------------------------------------------------------------------------------------
         /// @brief allocate 分配空间
         /// ------------------------------------------------------------------------------------------------------------
@@ -39,6 +159,8 @@ namespace mystl
 
         static T *allocate(size_type n);
 
+        static allocation_result<T *, size_type> allocate_at_least(size_type n);
+
         /// ------------------------------------------------------------------------------------------------------------
         /// @brief deallocate 回收空间
         /// ------------------------------------------------------------------------------------------------------------
@@ -79,15 +201,31 @@ namespace mystl
     template<typename T>
     T *allocator<T>::allocate()
     {
-        // 全局函数 operator new，分配内存返回void指针，且不初始化
-        return static_cast<T *>(::operator new(sizeof(T)));
+        // 全局函数 operator new，分配内存返回void指针，且不初始化；对齐要求超过默认值时走对齐版本
+        return static_cast<T *>(mystl::allocate_bytes(sizeof(T), alignof(T)));
     }
 
     template<typename T>
     T *allocator<T>::allocate(size_type n)
     {
         if (n == 0) return nullptr;
-        return static_cast<T *> (::operator new(n * sizeof(T)));
+        THROW_LENGTH_ERROR_IF(n > static_cast<size_type>(-1) / sizeof(T), "allocator<T>::allocate size too big");
+        return static_cast<T *>(mystl::allocate_bytes(n * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * @brief allocate_at_least函数，至少分配 n 个元素的空间，并返回实际可用的元素个数
+     * @note 返回的 count 可能大于 n，回收时必须把 count 传给 deallocate
+     * */
+
+    template<typename T>
+    allocation_result<T *, typename allocator<T>::size_type> allocator<T>::allocate_at_least(size_type n)
+    {
+        if (n == 0) return {nullptr, 0};
+        THROW_LENGTH_ERROR_IF(n > static_cast<size_type>(-1) / sizeof(T),
+                              "allocator<T>::allocate_at_least size too big");
+        const size_type count = mystl::good_alloc_size(n * sizeof(T)) / sizeof(T);
+        return {static_cast<T *>(mystl::allocate_bytes(count * sizeof(T), alignof(T))), count};
     }
 
     /**
@@ -101,14 +239,14 @@ namespace mystl
     {
         // 全局函数 operator delete，释放内存，但不调用析构函数
         if (ptr == nullptr) return;
-        ::operator delete(ptr);
+        mystl::deallocate_bytes(ptr, sizeof(T), alignof(T));
     }
 
     template<typename T>
     void allocator<T>::deallocate(T *ptr, size_type n)
     {
         if (ptr == nullptr) return;
-        ::operator delete(ptr);
+        mystl::deallocate_bytes(ptr, n * sizeof(T), alignof(T));
     }
 
     /**
@@ -155,6 +293,105 @@ namespace mystl
         mystl::destroy(first, last);
     }
 
+    /// ================================================================================================================
+    /// @brief 比较运算符，无状态的 allocator 总是相等
+    /// ================================================================================================================
+
+    template<typename T1, typename T2>
+    bool operator==(const allocator<T1> &, const allocator<T2> &) noexcept
+    {
+        return true;
+    }
+
+    template<typename T1, typename T2>
+    bool operator!=(const allocator<T1> &, const allocator<T2> &) noexcept
+    {
+        return false;
+    }
+
+    /// ================================================================================================================
+    /// @brief 模板类 malloc_allocator
+    /// ================================================================================================================
+
+    /**
+     * @brief 直接使用 malloc / realloc / free 的无状态分配器
+     * @note 提供 reallocate，元素平凡可复制的 vector 扩容时可以交给 realloc：
+     *       底层能原地扩展时不搬移数据，大块内存(mmap)还可以通过 mremap 重新映射而不是复制
+     * */
+
+    template<typename T>
+    class malloc_allocator
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t),
+                      "malloc_allocator<T> does not support over-aligned types");
+
+    public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef const T *const_pointer;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type is_always_equal;
+
+        template<typename U>
+        struct rebind
+        {
+            typedef malloc_allocator<U> other;
+        };
+
+    public:
+        malloc_allocator() noexcept = default;
+
+        malloc_allocator(const malloc_allocator &) noexcept = default;
+
+        template<typename U>
+        malloc_allocator(const malloc_allocator<U> &) noexcept {}
+
+        static T *allocate(size_type n)
+        {
+            if (n == 0) return nullptr;
+            THROW_LENGTH_ERROR_IF(n > max_size(), "malloc_allocator<T>::allocate size too big");
+            void *ptr = std::malloc(n * sizeof(T));
+            if (ptr == nullptr) throw std::bad_alloc();
+            return static_cast<T *>(ptr);
+        }
+
+        static void deallocate(T *ptr, size_type) noexcept
+        {
+            std::free(ptr);
+        }
+
+        /// @brief 调整为 new_n 个元素，失败时抛出 bad_alloc 且原来的块保持不变
+        static T *reallocate(T *ptr, size_type, size_type new_n)
+        {
+            THROW_LENGTH_ERROR_IF(new_n > max_size(), "malloc_allocator<T>::reallocate size too big");
+            void *new_ptr = std::realloc(ptr, new_n * sizeof(T));
+            if (new_ptr == nullptr && new_n != 0) throw std::bad_alloc();
+            return static_cast<T *>(new_ptr);
+        }
+
+        static size_type max_size() noexcept
+        {
+            return static_cast<size_type>(-1) / sizeof(T);
+        }
+    };
+
+    template<typename T1, typename T2>
+    bool operator==(const malloc_allocator<T1> &, const malloc_allocator<T2> &) noexcept
+    {
+        return true;
+    }
+
+    template<typename T1, typename T2>
+    bool operator!=(const malloc_allocator<T1> &, const malloc_allocator<T2> &) noexcept
+    {
+        return false;
+    }
+
 }
 
 #endif //MYSTL_ALLOCATOR_H
@@ -0,0 +1,506 @@
+/**
+ * @file allocator_traits.h
+ * @brief 实现allocator_traits(统一访问分配器的接口)以及容器保存分配器的辅助类
+ */
+
+#ifndef MYSTL_ALLOCATOR_TRAITS_H
+#define MYSTL_ALLOCATOR_TRAITS_H
+
+#include <cstddef>
+#include <type_traits>
+
+#include "type_traits.h"
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "util.h"
+
+namespace mystl
+{
+    /// ================================================================================================================
+    /// @brief 检测分配器的成员类型，不存在时使用默认类型
+    /// ================================================================================================================
+
+    template<typename Alloc, typename = void>
+    struct alloc_pointer
+    {
+        typedef typename Alloc::value_type *type;
+    };
+
+    template<typename Alloc>
+    struct alloc_pointer<Alloc, void_t<typename Alloc::pointer>>
+    {
+        typedef typename Alloc::pointer type;
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_const_pointer
+    {
+        typedef const typename Alloc::value_type *type;
+    };
+
+    template<typename Alloc>
+    struct alloc_const_pointer<Alloc, void_t<typename Alloc::const_pointer>>
+    {
+        typedef typename Alloc::const_pointer type;
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_size_type
+    {
+        typedef size_t type;
+    };
+
+    template<typename Alloc>
+    struct alloc_size_type<Alloc, void_t<typename Alloc::size_type>>
+    {
+        typedef typename Alloc::size_type type;
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_difference_type
+    {
+        typedef ptrdiff_t type;
+    };
+
+    template<typename Alloc>
+    struct alloc_difference_type<Alloc, void_t<typename Alloc::difference_type>>
+    {
+        typedef typename Alloc::difference_type type;
+    };
+
+    /// @brief 容器拷贝赋值/移动赋值/交换时是否传播分配器，默认都不传播
+    template<typename Alloc, typename = void>
+    struct alloc_pocca : public std::false_type {};
+
+    template<typename Alloc>
+    struct alloc_pocca<Alloc, void_t<typename Alloc::propagate_on_container_copy_assignment>>
+            : public Alloc::propagate_on_container_copy_assignment
+    {
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_pocma : public std::false_type {};
+
+    template<typename Alloc>
+    struct alloc_pocma<Alloc, void_t<typename Alloc::propagate_on_container_move_assignment>>
+            : public Alloc::propagate_on_container_move_assignment
+    {
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_pocs : public std::false_type {};
+
+    template<typename Alloc>
+    struct alloc_pocs<Alloc, void_t<typename Alloc::propagate_on_container_swap>>
+            : public Alloc::propagate_on_container_swap
+    {
+    };
+
+    /// @brief 没有声明 is_always_equal 时，空类型的分配器视为总是相等
+    template<typename Alloc, typename = void>
+    struct alloc_always_equal : public std::is_empty<Alloc> {};
+
+    template<typename Alloc>
+    struct alloc_always_equal<Alloc, void_t<typename Alloc::is_always_equal>>
+            : public Alloc::is_always_equal
+    {
+    };
+
+    /// ================================================================================================================
+    /// @brief rebind，优先使用 Alloc::rebind<U>::other，否则替换 Alloc<T, Args...> 的第一个模板参数
+    /// ================================================================================================================
+
+    template<typename Alloc, typename U>
+    struct alloc_replace_first {};
+
+    template<template<typename, typename...> class Alloc, typename T, typename... Args, typename U>
+    struct alloc_replace_first<Alloc<T, Args...>, U>
+    {
+        typedef Alloc<U, Args...> type;
+    };
+
+    template<typename Alloc, typename U, typename = void>
+    struct alloc_rebind
+    {
+        typedef typename alloc_replace_first<Alloc, U>::type type;
+    };
+
+    template<typename Alloc, typename U>
+    struct alloc_rebind<Alloc, U, void_t<typename Alloc::template rebind<U>::other>>
+    {
+        typedef typename Alloc::template rebind<U>::other type;
+    };
+
+    /// ================================================================================================================
+    /// @brief 检测分配器的成员函数是否存在
+    /// ================================================================================================================
+
+    template<typename, typename Alloc, typename... Args>
+    struct alloc_has_construct_impl : public std::false_type {};
+
+    template<typename Alloc, typename... Args>
+    struct alloc_has_construct_impl<
+            void_t<decltype(std::declval<Alloc &>().construct(std::declval<Args>()...))>, Alloc, Args...>
+            : public std::true_type
+    {
+    };
+
+    template<typename Alloc, typename... Args>
+    struct alloc_has_construct : public alloc_has_construct_impl<void, Alloc, Args...> {};
+
+    template<typename Alloc, typename Ptr, typename = void>
+    struct alloc_has_destroy : public std::false_type {};
+
+    template<typename Alloc, typename Ptr>
+    struct alloc_has_destroy<Alloc, Ptr, void_t<decltype(std::declval<Alloc &>().destroy(std::declval<Ptr>()))>>
+            : public std::true_type
+    {
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_has_allocate_at_least : public std::false_type {};
+
+    template<typename Alloc>
+    struct alloc_has_allocate_at_least<Alloc, void_t<decltype(std::declval<Alloc &>().allocate_at_least(size_t()))>>
+            : public std::true_type
+    {
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_has_expand : public std::false_type {};
+
+    template<typename Alloc>
+    struct alloc_has_expand<Alloc, void_t<decltype(std::declval<Alloc &>().expand(
+            std::declval<typename Alloc::value_type *>(), size_t(), size_t()))>>
+            : public std::true_type
+    {
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_has_reallocate : public std::false_type {};
+
+    template<typename Alloc>
+    struct alloc_has_reallocate<Alloc, void_t<decltype(std::declval<Alloc &>().reallocate(
+            std::declval<typename Alloc::value_type *>(), size_t(), size_t()))>>
+            : public std::true_type
+    {
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_has_max_size : public std::false_type {};
+
+    template<typename Alloc>
+    struct alloc_has_max_size<Alloc, void_t<decltype(std::declval<const Alloc &>().max_size())>>
+            : public std::true_type
+    {
+    };
+
+    template<typename Alloc, typename = void>
+    struct alloc_has_select : public std::false_type {};
+
+    template<typename Alloc>
+    struct alloc_has_select<Alloc,
+            void_t<decltype(std::declval<const Alloc &>().select_on_container_copy_construction())>>
+            : public std::true_type
+    {
+    };
+
+    /// ================================================================================================================
+    /// @brief allocator_traits
+    /// ================================================================================================================
+
+    /**
+     * @brief 容器通过 allocator_traits 访问分配器，分配器只需提供 value_type / allocate / deallocate，
+     * @brief 其余成员缺省时由 allocator_traits 补全。所有操作都作用在分配器实例上，因此支持有状态的分配器
+     * */
+
+    template<typename Alloc>
+    struct allocator_traits
+    {
+        typedef Alloc allocator_type;
+        typedef typename Alloc::value_type value_type;
+        typedef typename alloc_pointer<Alloc>::type pointer;
+        typedef typename alloc_const_pointer<Alloc>::type const_pointer;
+        typedef typename alloc_size_type<Alloc>::type size_type;
+        typedef typename alloc_difference_type<Alloc>::type difference_type;
+
+        typedef alloc_pocca<Alloc> propagate_on_container_copy_assignment;
+        typedef alloc_pocma<Alloc> propagate_on_container_move_assignment;
+        typedef alloc_pocs<Alloc> propagate_on_container_swap;
+        typedef alloc_always_equal<Alloc> is_always_equal;
+
+        /// @brief 分配器能否通过 reallocate 重新分配(可能原地扩展，否则由分配器搬移字节)
+        typedef alloc_has_reallocate<Alloc> has_reallocate;
+
+        template<typename U>
+        using rebind_alloc = typename alloc_rebind<Alloc, U>::type;
+
+        template<typename U>
+        using rebind_traits = allocator_traits<rebind_alloc<U>>;
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief allocate / deallocate
+        /// ------------------------------------------------------------------------------------------------------------
+
+        static pointer allocate(Alloc &a, size_type n)
+        {
+            return a.allocate(n);
+        }
+
+        static void deallocate(Alloc &a, pointer ptr, size_type n)
+        {
+            a.deallocate(ptr, n);
+        }
+
+        /// @brief 至少分配 n 个元素，返回实际可用的个数；分配器没有提供 allocate_at_least 时恰好分配 n 个
+        static allocation_result<pointer, size_type> allocate_at_least(Alloc &a, size_type n)
+        {
+            return allocate_at_least_dispatch(alloc_has_allocate_at_least<Alloc>{}, a, n);
+        }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief expand / reallocate，只能用于平凡可复制的元素
+        /// ------------------------------------------------------------------------------------------------------------
+
+        /// @brief 尝试把 ptr 指向的块原地从 old_n 扩展到 new_n 个元素，失败或分配器不支持时返回 false
+        static bool expand(Alloc &a, pointer ptr, size_type old_n, size_type new_n) noexcept
+        {
+            return expand_dispatch(alloc_has_expand<Alloc>{}, a, ptr, old_n, new_n);
+        }
+
+        /// @brief 把 ptr 指向的块调整为 new_n 个元素并按字节保留原内容，仅当 has_reallocate 为真时可用
+        static pointer reallocate(Alloc &a, pointer ptr, size_type old_n, size_type new_n)
+        {
+            return a.reallocate(ptr, old_n, new_n);
+        }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief construct / destroy，分配器没有提供时直接调用 mystl::construct / mystl::destroy
+        /// ------------------------------------------------------------------------------------------------------------
+
+        template<typename U, typename... Args>
+        static void construct(Alloc &a, U *ptr, Args &&...args)
+        {
+            construct_dispatch(alloc_has_construct<Alloc, U *, Args...>{}, a, ptr, mystl::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        static void destroy(Alloc &a, U *ptr)
+        {
+            destroy_dispatch(alloc_has_destroy<Alloc, U *>{}, a, ptr);
+        }
+
+        template<typename ForwardIter>
+        static void destroy(Alloc &a, ForwardIter first, ForwardIter last)
+        {
+            destroy_range_dispatch(alloc_has_destroy<Alloc, decltype(&*first)>{}, a, first, last);
+        }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief max_size / select_on_container_copy_construction
+        /// ------------------------------------------------------------------------------------------------------------
+
+        static size_type max_size(const Alloc &a) noexcept
+        {
+            return max_size_dispatch(alloc_has_max_size<Alloc>{}, a);
+        }
+
+        static Alloc select_on_container_copy_construction(const Alloc &a)
+        {
+            return select_dispatch(alloc_has_select<Alloc>{}, a);
+        }
+
+    private:
+        static allocation_result<pointer, size_type> allocate_at_least_dispatch(std::true_type, Alloc &a, size_type n)
+        {
+            auto result = a.allocate_at_least(n);
+            return {result.ptr, static_cast<size_type>(result.count)};
+        }
+
+        static allocation_result<pointer, size_type> allocate_at_least_dispatch(std::false_type, Alloc &a, size_type n)
+        {
+            return {a.allocate(n), n};
+        }
+
+        static bool expand_dispatch(std::true_type, Alloc &a, pointer ptr, size_type old_n, size_type new_n) noexcept
+        {
+            return a.expand(ptr, old_n, new_n);
+        }
+
+        static bool expand_dispatch(std::false_type, Alloc &, pointer, size_type, size_type) noexcept
+        {
+            return false;
+        }
+
+        template<typename U, typename... Args>
+        static void construct_dispatch(std::true_type, Alloc &a, U *ptr, Args &&...args)
+        {
+            a.construct(ptr, mystl::forward<Args>(args)...);
+        }
+
+        template<typename U, typename... Args>
+        static void construct_dispatch(std::false_type, Alloc &, U *ptr, Args &&...args)
+        {
+            mystl::construct(ptr, mystl::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        static void destroy_dispatch(std::true_type, Alloc &a, U *ptr)
+        {
+            a.destroy(ptr);
+        }
+
+        template<typename U>
+        static void destroy_dispatch(std::false_type, Alloc &, U *ptr)
+        {
+            mystl::destroy(ptr);
+        }
+
+        template<typename ForwardIter>
+        static void destroy_range_dispatch(std::true_type, Alloc &a, ForwardIter first, ForwardIter last)
+        {
+            for (; first != last; ++first)
+                a.destroy(&*first);
+        }
+
+        template<typename ForwardIter>
+        static void destroy_range_dispatch(std::false_type, Alloc &, ForwardIter first, ForwardIter last)
+        {
+            mystl::destroy(first, last);
+        }
+
+        static size_type max_size_dispatch(std::true_type, const Alloc &a) noexcept
+        {
+            return a.max_size();
+        }
+
+        static size_type max_size_dispatch(std::false_type, const Alloc &) noexcept
+        {
+            return static_cast<size_type>(-1) / sizeof(value_type);
+        }
+
+        static Alloc select_dispatch(std::true_type, const Alloc &a)
+        {
+            return a.select_on_container_copy_construction();
+        }
+
+        static Alloc select_dispatch(std::false_type, const Alloc &a)
+        {
+            return a;
+        }
+    };
+
+    /// ================================================================================================================
+    /// @brief 容器拷贝赋值/移动赋值/交换时传播分配器
+    /// ================================================================================================================
+
+    template<typename Alloc>
+    void alloc_on_copy_dispatch(Alloc &lhs, const Alloc &rhs, std::true_type)
+    {
+        lhs = rhs;
+    }
+
+    template<typename Alloc>
+    void alloc_on_copy_dispatch(Alloc &, const Alloc &, std::false_type) {}
+
+    template<typename Alloc>
+    void alloc_on_copy(Alloc &lhs, const Alloc &rhs)
+    {
+        alloc_on_copy_dispatch(lhs, rhs,
+                               std::integral_constant<bool,
+                                       allocator_traits<Alloc>::propagate_on_container_copy_assignment::value>{});
+    }
+
+    template<typename Alloc>
+    void alloc_on_move_dispatch(Alloc &lhs, Alloc &rhs, std::true_type)
+    {
+        lhs = mystl::move(rhs);
+    }
+
+    template<typename Alloc>
+    void alloc_on_move_dispatch(Alloc &, Alloc &, std::false_type) {}
+
+    template<typename Alloc>
+    void alloc_on_move(Alloc &lhs, Alloc &rhs)
+    {
+        alloc_on_move_dispatch(lhs, rhs,
+                               std::integral_constant<bool,
+                                       allocator_traits<Alloc>::propagate_on_container_move_assignment::value>{});
+    }
+
+    template<typename Alloc>
+    void alloc_on_swap_dispatch(Alloc &lhs, Alloc &rhs, std::true_type)
+    {
+        mystl::swap(lhs, rhs);
+    }
+
+    /// @note 不传播时交换两个分配器不相等的容器是未定义行为
+    template<typename Alloc>
+    void alloc_on_swap_dispatch(Alloc &lhs, Alloc &rhs, std::false_type)
+    {
+        MYSTL_DEBUG(lhs == rhs);
+        (void) lhs;
+        (void) rhs;
+    }
+
+    template<typename Alloc>
+    void alloc_on_swap(Alloc &lhs, Alloc &rhs)
+    {
+        alloc_on_swap_dispatch(lhs, rhs,
+                               std::integral_constant<bool,
+                                       allocator_traits<Alloc>::propagate_on_container_swap::value>{});
+    }
+
+    /// @brief 判断两个分配器是否相等，总是相等时不做比较
+    template<typename Alloc>
+    bool alloc_equal(const Alloc &lhs, const Alloc &rhs)
+    {
+        return allocator_traits<Alloc>::is_always_equal::value || lhs == rhs;
+    }
+
+    /// ================================================================================================================
+    /// @brief alloc_holder 容器保存分配器实例的基类
+    /// ================================================================================================================
+
+    /**
+     * @brief 分配器为空类型时以基类的形式保存(空基类优化，不占用容器的空间)，否则作为成员保存
+     * @note 容器私有继承 alloc_holder，通过 get_alloc() 取得分配器
+     * */
+
+    template<typename Alloc, bool = std::is_empty<Alloc>::value && !std::is_final<Alloc>::value>
+    class alloc_holder : private Alloc
+    {
+    public:
+        alloc_holder() = default;
+
+        explicit alloc_holder(const Alloc &alloc) : Alloc(alloc) {}
+
+        explicit alloc_holder(Alloc &&alloc) noexcept: Alloc(mystl::move(alloc)) {}
+
+        Alloc &get_alloc() noexcept { return *this; }
+
+        const Alloc &get_alloc() const noexcept { return *this; }
+    };
+
+    template<typename Alloc>
+    class alloc_holder<Alloc, false>
+    {
+    private:
+        Alloc alloc_;
+
+    public:
+        alloc_holder() = default;
+
+        explicit alloc_holder(const Alloc &alloc) : alloc_(alloc) {}
+
+        explicit alloc_holder(Alloc &&alloc) noexcept: alloc_(mystl::move(alloc)) {}
+
+        Alloc &get_alloc() noexcept { return alloc_; }
+
+        const Alloc &get_alloc() const noexcept { return alloc_; }
+    };
+
+}
+
+#endif //MYSTL_ALLOCATOR_TRAITS_H
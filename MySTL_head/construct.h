@@ -60,7 +60,7 @@ namespace mystl
      * */
 
     template<typename T>
-    void destory_one(T *, std::true_type) {}
+    void destroy_one(T *, std::true_type) {}
 
     template<typename T>
     void destroy_one(T *pointer, std::false_type)
@@ -71,6 +71,18 @@ namespace mystl
         }
     }
 
+    /**
+     * @brief 模板函数destroy，用于在给定内存处调用析构函数
+     * @param[in] pointer 指向内存空间
+     * */
+
+    template<typename T>
+    void destroy(T *pointer)
+    {
+        // is_trivially_destructible 判断是否易销毁 (返回false_type or true_type类型)
+        destroy_one(pointer, std::is_trivially_destructible<T>{});
+    }
+
     /**
      * @brief 模板函数destroy_cat
      * @param[in] ForwardIter 迭代器
@@ -85,19 +97,7 @@ namespace mystl
     void destroy_cat(ForwardIter first, ForwardIter last, std::false_type)
     {
         for (; first != last; ++first)
-            destroy(&*first);
-    }
-
-    /**
-     * @brief 模板函数destroy，用于在给定内存处调用析构函数
-     * @param[in] pointer 指向内存空间
-     * */
-
-    template<typename T>
-    void destroy(T *pointer)
-    {
-        // is_trivially_destructible 判断是否易销毁 (返回false_type or true_type类型)
-        destroy_one(pointer, std::is_trivially_destructible<T>{});
+            mystl::destroy(&*first);
     }
 
     template<typename ForwardIter>
@@ -13,10 +13,12 @@
 #ifndef MYSTL_DEQUE_H
 #define MYSTL_DEQUE_H
 
+#include <cstring>
 #include <initializer_list>
 
 #include "iterator.h"
 #include "memory.h"
+#include "allocator_traits.h"
 #include "util.h"
 #include "exceptdef.h"
 
@@ -36,20 +38,50 @@ namespace mystl
 #define DEQUE_MAP_INIT_SIZE 8
 #endif
 
-    template<typename T>
+/// @brief deque 每个缓冲区的默认字节数，可以在包含头文件前定义，也可以通过 deque 的模板参数单独指定
+#ifndef DEQUE_BLOCK_BYTES
+#define DEQUE_BLOCK_BYTES 4096
+#endif
+
+/// @brief 每个 deque 最多保留的空闲缓冲区个数：腾空的缓冲区先留着，下次需要新缓冲区时直接复用，为 0 时不保留
+#ifndef DEQUE_SPARE_BLOCKS
+#define DEQUE_SPARE_BLOCKS 2
+#endif
+
+    /// @brief 不超过 n 的最大的 2 的幂，n 不能为 0
+    constexpr size_t deque_floor_pow2(size_t n) noexcept
+    {
+        return (n & (n - 1)) == 0 ? n : deque_floor_pow2(n & (n - 1));
+    }
+
+    constexpr size_t deque_log2(size_t n) noexcept
+    {
+        return n <= 1 ? 0 : 1 + deque_log2(n >> 1);
+    }
+
+    /**
+     * @brief 每个缓冲区的元素个数：BlockBytes 能放下的元素数向下取整到 2 的幂，至少 16 个
+     * @note 元素个数是 2 的幂，迭代器和 operator[] 中的除法、取模都可以换成移位和掩码
+     * */
+    template<typename T, size_t BlockBytes = DEQUE_BLOCK_BYTES>
     struct deque_buf_size
     {
-        static constexpr size_t value = sizeof(T) < 256 ? 4096 / sizeof(T) : 16;
+        static_assert(BlockBytes > 0, "the block size of deque must be positive");
+
+        static constexpr size_t value = deque_floor_pow2(BlockBytes / sizeof(T) < 16 ? 16 : BlockBytes / sizeof(T));
+        static constexpr size_t shift = deque_log2(value);
+        static constexpr size_t mask = value - 1;
     };
 
     /// ================================================================================================================
     /// @brief deque 迭代器
     /// ================================================================================================================
-    template<typename T, typename Ref, typename Ptr>
+    template<typename T, typename Ref, typename Ptr, size_t BlockBytes = DEQUE_BLOCK_BYTES>
     class deque_iterator : public iterator<random_access_iterator_tag, T>
     {
-        typedef deque_iterator<T, T &, T *> iterator;
-        typedef deque_iterator<T, const T &, const T *> const_iterator;
+    public:
+        typedef deque_iterator<T, T &, T *, BlockBytes> iterator;
+        typedef deque_iterator<T, const T &, const T *, BlockBytes> const_iterator;
         typedef deque_iterator self;
 
         typedef T value_type;
@@ -60,7 +92,9 @@ namespace mystl
         typedef T *value_pointer;
         typedef T **map_pointer;
 
-        static const size_type buffer_size = deque_buf_size<T>::value;
+        static const size_type buffer_size = deque_buf_size<T, BlockBytes>::value;
+        static const size_type buffer_shift = deque_buf_size<T, BlockBytes>::shift;
+        static const size_type buffer_mask = deque_buf_size<T, BlockBytes>::mask;
 
         /// 迭代器包含的成员数据
         value_pointer cur;    // 指向所在缓冲区的当前元素
@@ -164,12 +198,13 @@ namespace mystl
             }
             else
             {
-                // 要跳到其他的缓冲区
+                // 要跳到其他的缓冲区：offset 为负时向下取整；块内偏移取低位，负数按补码转换为无符号后同样正确
                 const auto node_offset = offset > 0
-                                         ? offset / static_cast<difference_type>(buffer_size)
-                                         : -static_cast<difference_type>((-offset - 1) / buffer_size) - 1;
+                                         ? offset >> buffer_shift
+                                         : -static_cast<difference_type>(
+                                                 (static_cast<size_type>(-offset) - 1) >> buffer_shift) - 1;
                 set_node(node + node_offset);
-                cur = first + (offset - node_offset * static_cast<difference_type>(buffer_size));
+                cur = first + (static_cast<size_type>(offset) & buffer_mask);
             }
             return *this;
         }
@@ -208,67 +243,134 @@ namespace mystl
 
     };
 
+    /// @brief deque 迭代器是分段迭代器：每个缓冲区是一段，compose 在块尾时转到下一块的开头，与 operator++ 一致
+    template<typename T, typename Ref, typename Ptr, size_t BlockBytes>
+    struct segmented_iterator_traits<deque_iterator<T, Ref, Ptr, BlockBytes>>
+    {
+        typedef std::true_type is_segmented_iterator;
+        typedef deque_iterator<T, Ref, Ptr, BlockBytes> iterator;
+        typedef typename iterator::map_pointer segment_iterator;
+        typedef Ptr local_iterator;
+
+        static segment_iterator segment(const iterator &it) noexcept { return it.node; }
+
+        static local_iterator local(const iterator &it) noexcept { return it.cur; }
+
+        static local_iterator begin(segment_iterator seg) noexcept { return *seg; }
+
+        static local_iterator end(segment_iterator seg) noexcept { return *seg + iterator::buffer_size; }
+
+        static iterator compose(segment_iterator seg, local_iterator local) noexcept
+        {
+            if (local == end(seg))
+            {
+                ++seg;
+                return iterator(*seg, seg);
+            }
+            return iterator(const_cast<T *>(local), seg);
+        }
+    };
+
     /// ================================================================================================================
     /// @brief deque模板类
     /// ================================================================================================================
 
-    template<typename T>
-    class deque
+    /**
+     * @tparam BlockBytes 每个缓冲区的字节数，实际元素个数见 deque_buf_size；
+     * 滑动窗口等大量随机访问的场景可以用 64 KiB、2 MiB 这样的大块减少 map 的跳转
+     * */
+    template<typename T, typename Alloc = mystl::allocator<T>, size_t BlockBytes = DEQUE_BLOCK_BYTES>
+    class deque : private mystl::alloc_holder<Alloc>
     {
+        static_assert(std::is_same<T, typename Alloc::value_type>::value,
+                      "the value_type of Alloc must be the same as T in deque<T, Alloc>");
+
     public:
-        typedef mystl::allocator<T> allocator_type;
-        typedef mystl::allocator<T> data_allocator;
-        typedef mystl::allocator<T *> map_allocator;
-
-        typedef typename allocator_type::value_type value_type;
-        typedef typename allocator_type::pointer pointer;
-        typedef typename allocator_type::const_pointer const_pointer;
-        typedef typename allocator_type::reference reference;
-        typedef typename allocator_type::const_reference const_reference;
-        typedef typename allocator_type::size_type size_type;
-        typedef typename allocator_type::difference_type difference_type;
+        typedef Alloc allocator_type;
+        typedef Alloc data_allocator;
+        typedef typename mystl::allocator_traits<Alloc>::template rebind_alloc<T *> map_allocator;
+        typedef mystl::allocator_traits<data_allocator> data_alloc_traits;
+        typedef mystl::allocator_traits<map_allocator> map_alloc_traits;
+
+        typedef T value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef typename data_alloc_traits::size_type size_type;
+        typedef typename data_alloc_traits::difference_type difference_type;
         typedef pointer *map_pointer;
         typedef const_pointer *const_map_pointer;
 
-        typedef deque_iterator<T, T &, T *> iterator;
-        typedef deque_iterator<T, const T &, const T *> const_iterator;
+        typedef deque_iterator<T, T &, T *, BlockBytes> iterator;
+        typedef deque_iterator<T, const T &, const T *, BlockBytes> const_iterator;
         typedef mystl::reverse_iterator<iterator> reverse_iterator;
         typedef mystl::reverse_iterator<const_iterator> const_reverse_iterator;
 
-        allocator_type get_allocator() { return allocator_type(); }
+        allocator_type get_allocator() const { return get_alloc(); }
 
-        static const size_type buffer_size = deque_buf_size<T>::value;
+        static constexpr size_type buffer_size = deque_buf_size<T, BlockBytes>::value;
+        static constexpr size_type buffer_shift = deque_buf_size<T, BlockBytes>::shift;
+        static constexpr size_type buffer_mask = deque_buf_size<T, BlockBytes>::mask;
 
     private:
+        typedef mystl::alloc_holder<Alloc> holder_type;
+
+        using holder_type::get_alloc;
+
         /// @brief value 用以下四个数据来控制一个 deque
         iterator begin_;     // 指向第一个节点
         iterator end_;       // 指向最后一个结点
         map_pointer map_;       // 指向一块 map，map 中的每个元素都是一个指针，指向一个缓冲区
         size_type map_size_;  // map 内指针的数目
 
+        /// @brief 空闲缓冲区缓存，只有前 spare_count_ 个有效；头尾进出的队列不必反复申请、归还缓冲区
+        static constexpr size_type spare_capacity = DEQUE_SPARE_BLOCKS;
+        pointer spare_[spare_capacity > 0 ? spare_capacity : 1];
+        size_type spare_count_ = 0;
+
     public:
         deque() { fill_init(0, value_type()); }
 
-        explicit deque(size_type n) { fill_init(n, value_type()); }
+        explicit deque(const allocator_type &alloc) : holder_type(alloc) { fill_init(0, value_type()); }
 
-        deque(size_type n, const value_type &value) { fill_init(n, value); }
+        explicit deque(size_type n, const allocator_type &alloc = allocator_type()) : holder_type(alloc)
+        {
+            fill_init(n, value_type());
+        }
+
+        deque(size_type n, const value_type &value, const allocator_type &alloc = allocator_type())
+                : holder_type(alloc)
+        {
+            fill_init(n, value);
+        }
 
         template<class IIter, typename std::enable_if<
                 mystl::is_input_iterator<IIter>::value, int>::type = 0>
-        deque(IIter first, IIter last) { copy_init(first, last, iterator_category(first)); }
+        deque(IIter first, IIter last, const allocator_type &alloc = allocator_type()) : holder_type(alloc)
+        {
+            copy_init(first, last, iterator_category(first));
+        }
 
-        deque(std::initializer_list<value_type> ilist)
+        deque(std::initializer_list<value_type> ilist, const allocator_type &alloc = allocator_type())
+                : holder_type(alloc)
         {
             copy_init(ilist.begin(), ilist.end(), mystl::forward_iterator_tag());
         }
 
-        deque(const deque &rhs)
+        deque(const deque &rhs) : holder_type(data_alloc_traits::select_on_container_copy_construction(rhs.get_alloc()))
+        {
+            copy_init(rhs.begin(), rhs.end(), mystl::forward_iterator_tag());
+        }
+
+        deque(const deque &rhs, const allocator_type &alloc) : holder_type(alloc)
         {
             copy_init(rhs.begin(), rhs.end(), mystl::forward_iterator_tag());
         }
 
         deque(deque &&rhs) noexcept
-                : begin_(mystl::move(rhs.begin_)),
+                : holder_type(mystl::move(rhs.get_alloc())),
+                  begin_(mystl::move(rhs.begin_)),
                   end_(mystl::move(rhs.end_)),
                   map_(rhs.map_),
                   map_size_(rhs.map_size_)
@@ -279,25 +381,19 @@ namespace mystl
 
         deque &operator=(const deque &rhs);
 
-        deque &operator=(deque &&rhs);
+        deque &operator=(deque &&rhs) noexcept(data_alloc_traits::propagate_on_container_move_assignment::value ||
+                                               data_alloc_traits::is_always_equal::value);
 
         deque &operator=(std::initializer_list<value_type> ilist)
         {
-            deque tmp(ilist);
+            deque tmp(ilist, get_alloc());
             swap(tmp);
             return *this;
         }
 
         ~deque()
         {
-            if (map_ != nullptr)
-            {
-                clear();
-                data_allocator::deallocate(*begin_.node, buffer_size);
-                *begin_.node = nullptr;
-                map_allocator::deallocate(map_, map_size_);
-                map_ = nullptr;
-            }
+            free_all();
         }
 
     public:
@@ -333,7 +429,7 @@ namespace mystl
 
         size_type size() const noexcept { return end_ - begin_; }
 
-        size_type max_size() const noexcept { return static_cast<size_type>(-1); }
+        size_type max_size() const noexcept { return data_alloc_traits::max_size(get_alloc()); }
 
         void resize(size_type new_size) { resize(new_size, value_type()); }
 
@@ -341,17 +437,19 @@ namespace mystl
 
         void shrink_to_fit() noexcept;
 
-        // 访问元素相关操作
+        // 访问元素相关操作：n 不会为负，直接用移位和掩码定位缓冲区和块内位置，不经过迭代器的 operator+=
         reference operator[](size_type n)
         {
             MYSTL_DEBUG(n < size());
-            return begin_[n];
+            const size_type offset = n + static_cast<size_type>(begin_.cur - begin_.first);
+            return begin_.node[offset >> buffer_shift][offset & buffer_mask];
         }
 
         const_reference operator[](size_type n) const
         {
             MYSTL_DEBUG(n < size());
-            return begin_[n];
+            const size_type offset = n + static_cast<size_type>(begin_.cur - begin_.first);
+            return begin_.node[offset >> buffer_shift][offset & buffer_mask];
         }
 
         reference at(size_type n)
@@ -465,10 +563,22 @@ namespace mystl
         // create node / destroy node
         map_pointer create_map(size_type size);
 
+        void deallocate_map(map_pointer mp, size_type size);
+
         void create_buffer(map_pointer nstart, map_pointer nfinish);
 
         void destroy_buffer(map_pointer nstart, map_pointer nfinish);
 
+        pointer allocate_buffer();
+
+        void deallocate_buffer(pointer buffer) noexcept;
+
+        void release_spare() noexcept;
+
+        void recycle_outside_buffers() noexcept;
+
+        void free_all();
+
         // initialize
         void map_init(size_type nelem);
 
@@ -510,13 +620,23 @@ namespace mystl
         void reallocate_map_at_front(size_type need);
 
         void reallocate_map_at_back(size_type need);
+
+        void recenter_map(size_type need, bool front) noexcept;
     };
 
-    template<class T>
-    deque<T> &deque<T>::operator=(const deque &rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    deque<T, Alloc, BlockBytes> &deque<T, Alloc, BlockBytes>::operator=(const deque &rhs)
     {
         if (this != &rhs)
         {
+            if (data_alloc_traits::propagate_on_container_copy_assignment::value &&
+                !mystl::alloc_equal(get_alloc(), rhs.get_alloc()))
+            {
+                // 原来的缓冲区和 map 必须由原来的分配器回收
+                free_all();
+                mystl::alloc_on_copy(get_alloc(), rhs.get_alloc());
+                map_init(0);
+            }
             const auto len = size();
             if (len >= rhs.size())
             {
@@ -524,31 +644,50 @@ namespace mystl
             }
             else
             {
-                iterator mid = rhs.begin() + static_cast<difference_type>(len);
-                mystl::copy(rhs.begin_, mid, begin_);
-                insert(end_, mid, rhs.end_);
+                const_iterator mid = rhs.begin() + static_cast<difference_type>(len);
+                mystl::copy(rhs.begin(), mid, begin_);
+                insert(end_, mid, rhs.end());
             }
         }
         return *this;
     }
 
     // 移动赋值运算符
-    template<class T>
-    deque<T> &deque<T>::operator=(deque &&rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    deque<T, Alloc, BlockBytes> &deque<T, Alloc, BlockBytes>::operator=(deque &&rhs)
+    noexcept(data_alloc_traits::propagate_on_container_move_assignment::value ||
+             data_alloc_traits::is_always_equal::value)
     {
-        clear();
-        begin_ = mystl::move(rhs.begin_);
-        end_ = mystl::move(rhs.end_);
-        map_ = rhs.map_;
-        map_size_ = rhs.map_size_;
-        rhs.map_ = nullptr;
-        rhs.map_size_ = 0;
+        if (this == &rhs)
+            return *this;
+        if (data_alloc_traits::propagate_on_container_move_assignment::value ||
+            mystl::alloc_equal(get_alloc(), rhs.get_alloc()))
+        {
+            free_all();
+            mystl::alloc_on_move(get_alloc(), rhs.get_alloc());
+            begin_ = rhs.begin_;
+            end_ = rhs.end_;
+            map_ = rhs.map_;
+            map_size_ = rhs.map_size_;
+            rhs.map_ = nullptr;
+            rhs.map_size_ = 0;
+            rhs.begin_ = iterator();
+            rhs.end_ = iterator();
+        }
+        else
+        {
+            // 分配器不相等，只能逐个移动元素
+            clear();
+            for (auto it = rhs.begin_; it != rhs.end_; ++it)
+                emplace_back(mystl::move(*it));
+            rhs.clear();
+        }
         return *this;
     }
 
     // 重置容器大小
-    template<class T>
-    void deque<T>::resize(size_type new_size, const value_type &value)
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::resize(size_type new_size, const value_type &value)
     {
         const auto len = size();
         if (new_size < len)
@@ -562,30 +701,33 @@ namespace mystl
     }
 
     // 减小容器容量
-    template<class T>
-    void deque<T>::shrink_to_fit() noexcept
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::shrink_to_fit() noexcept
     {
         // 至少会留下头部缓冲区
         for (auto cur = map_; cur < begin_.node; ++cur)
         {
-            data_allocator::deallocate(*cur, buffer_size);
+            if (*cur == nullptr) continue;
+            data_alloc_traits::deallocate(get_alloc(), *cur, buffer_size);
             *cur = nullptr;
         }
         for (auto cur = end_.node + 1; cur < map_ + map_size_; ++cur)
         {
-            data_allocator::deallocate(*cur, buffer_size);
+            if (*cur == nullptr) continue;
+            data_alloc_traits::deallocate(get_alloc(), *cur, buffer_size);
             *cur = nullptr;
         }
+        release_spare();
     }
 
     // 在头部就地构建元素
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class ...Args>
-    void deque<T>::emplace_front(Args &&...args)
+    void deque<T, Alloc, BlockBytes>::emplace_front(Args &&...args)
     {
         if (begin_.cur != begin_.first)
         {
-            data_allocator::construct(begin_.cur - 1, mystl::forward<Args>(args)...);
+            data_alloc_traits::construct(get_alloc(), begin_.cur - 1, mystl::forward<Args>(args)...);
             --begin_.cur;
         }
         else
@@ -594,7 +736,7 @@ namespace mystl
             try
             {
                 --begin_;
-                data_allocator::construct(begin_.cur, mystl::forward<Args>(args)...);
+                data_alloc_traits::construct(get_alloc(), begin_.cur, mystl::forward<Args>(args)...);
             }
             catch (...)
             {
@@ -605,27 +747,27 @@ namespace mystl
     }
 
     // 在尾部就地构建元素
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class ...Args>
-    void deque<T>::emplace_back(Args &&...args)
+    void deque<T, Alloc, BlockBytes>::emplace_back(Args &&...args)
     {
         if (end_.cur != end_.last - 1)
         {
-            data_allocator::construct(end_.cur, mystl::forward<Args>(args)...);
+            data_alloc_traits::construct(get_alloc(), end_.cur, mystl::forward<Args>(args)...);
             ++end_.cur;
         }
         else
         {
             require_capacity(1, false);
-            data_allocator::construct(end_.cur, mystl::forward<Args>(args)...);
+            data_alloc_traits::construct(get_alloc(), end_.cur, mystl::forward<Args>(args)...);
             ++end_;
         }
     }
 
     // 在 pos 位置就地构建元素
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class ...Args>
-    typename deque<T>::iterator deque<T>::emplace(iterator pos, Args &&...args)
+    typename deque<T, Alloc, BlockBytes>::iterator deque<T, Alloc, BlockBytes>::emplace(iterator pos, Args &&...args)
     {
         if (pos.cur == begin_.cur)
         {
@@ -641,12 +783,12 @@ namespace mystl
     }
 
     // 在头部插入元素
-    template<class T>
-    void deque<T>::push_front(const value_type &value)
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::push_front(const value_type &value)
     {
         if (begin_.cur != begin_.first)
         {
-            data_allocator::construct(begin_.cur - 1, value);
+            data_alloc_traits::construct(get_alloc(), begin_.cur - 1, value);
             --begin_.cur;
         }
         else
@@ -655,7 +797,7 @@ namespace mystl
             try
             {
                 --begin_;
-                data_allocator::construct(begin_.cur, value);
+                data_alloc_traits::construct(get_alloc(), begin_.cur, value);
             }
             catch (...)
             {
@@ -666,62 +808,62 @@ namespace mystl
     }
 
     // 在尾部插入元素
-    template<class T>
-    void deque<T>::push_back(const value_type &value)
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::push_back(const value_type &value)
     {
         if (end_.cur != end_.last - 1)
         {
-            data_allocator::construct(end_.cur, value);
+            data_alloc_traits::construct(get_alloc(), end_.cur, value);
             ++end_.cur;
         }
         else
         {
             require_capacity(1, false);
-            data_allocator::construct(end_.cur, value);
+            data_alloc_traits::construct(get_alloc(), end_.cur, value);
             ++end_;
         }
     }
 
     // 弹出头部元素
-    template<class T>
-    void deque<T>::pop_front()
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::pop_front()
     {
         MYSTL_DEBUG(!empty());
         if (begin_.cur != begin_.last - 1)
         {
-            data_allocator::destroy(begin_.cur);
+            data_alloc_traits::destroy(get_alloc(), begin_.cur);
             ++begin_.cur;
         }
         else
         {
-            data_allocator::destroy(begin_.cur);
+            data_alloc_traits::destroy(get_alloc(), begin_.cur);
             ++begin_;
             destroy_buffer(begin_.node - 1, begin_.node - 1);
         }
     }
 
     // 弹出尾部元素
-    template<class T>
-    void deque<T>::pop_back()
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::pop_back()
     {
         MYSTL_DEBUG(!empty());
         if (end_.cur != end_.first)
         {
             --end_.cur;
-            data_allocator::destroy(end_.cur);
+            data_alloc_traits::destroy(get_alloc(), end_.cur);
         }
         else
         {
             --end_;
-            data_allocator::destroy(end_.cur);
+            data_alloc_traits::destroy(get_alloc(), end_.cur);
             destroy_buffer(end_.node + 1, end_.node + 1);
         }
     }
 
     // 在 position 处插入元素
-    template<class T>
-    typename deque<T>::iterator
-    deque<T>::insert(iterator position, const value_type &value)
+    template<class T, class Alloc, size_t BlockBytes>
+    typename deque<T, Alloc, BlockBytes>::iterator
+    deque<T, Alloc, BlockBytes>::insert(iterator position, const value_type &value)
     {
         if (position.cur == begin_.cur)
         {
@@ -741,9 +883,9 @@ namespace mystl
         }
     }
 
-    template<class T>
-    typename deque<T>::iterator
-    deque<T>::insert(iterator position, value_type &&value)
+    template<class T, class Alloc, size_t BlockBytes>
+    typename deque<T, Alloc, BlockBytes>::iterator
+    deque<T, Alloc, BlockBytes>::insert(iterator position, value_type &&value)
     {
         if (position.cur == begin_.cur)
         {
@@ -764,8 +906,8 @@ namespace mystl
     }
 
     // 在 position 位置插入 n 个元素
-    template<class T>
-    void deque<T>::insert(iterator position, size_type n, const value_type &value)
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::insert(iterator position, size_type n, const value_type &value)
     {
         if (position.cur == begin_.cur)
         {
@@ -788,9 +930,9 @@ namespace mystl
     }
 
     // 删除 position 处的元素
-    template<class T>
-    typename deque<T>::iterator
-    deque<T>::erase(iterator position)
+    template<class T, class Alloc, size_t BlockBytes>
+    typename deque<T, Alloc, BlockBytes>::iterator
+    deque<T, Alloc, BlockBytes>::erase(iterator position)
     {
         auto next = position;
         ++next;
@@ -809,9 +951,9 @@ namespace mystl
     }
 
     // 删除[first, last)上的元素
-    template<class T>
-    typename deque<T>::iterator
-    deque<T>::erase(iterator first, iterator last)
+    template<class T, class Alloc, size_t BlockBytes>
+    typename deque<T, Alloc, BlockBytes>::iterator
+    deque<T, Alloc, BlockBytes>::erase(iterator first, iterator last)
     {
         if (first == begin_ && last == end_)
         {
@@ -826,14 +968,14 @@ namespace mystl
             {
                 mystl::copy_backward(begin_, first, last);
                 auto new_begin = begin_ + len;
-                data_allocator::destroy(begin_.cur, new_begin.cur);
+                data_alloc_traits::destroy(get_alloc(), begin_, new_begin);
                 begin_ = new_begin;
             }
             else
             {
                 mystl::copy(last, end_, first);
                 auto new_end = end_ - len;
-                data_allocator::destroy(new_end.cur, end_.cur);
+                data_alloc_traits::destroy(get_alloc(), new_end, end_);
                 end_ = new_end;
             }
             return begin_ + elems_before;
@@ -841,13 +983,13 @@ namespace mystl
     }
 
     // 清空 deque
-    template<class T>
-    void deque<T>::clear()
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::clear()
     {
         // clear 会保留头部的缓冲区
         for (map_pointer cur = begin_.node + 1; cur < end_.node; ++cur)
         {
-            data_allocator::destroy(*cur, *cur + buffer_size);
+            data_alloc_traits::destroy(get_alloc(), *cur, *cur + buffer_size);
         }
         if (begin_.node != end_.node)
         { // 有两个以上的缓冲区
@@ -858,39 +1000,53 @@ namespace mystl
         {
             mystl::destroy(begin_.cur, end_.cur);
         }
-        shrink_to_fit();
+        // 先收缩 end_，shrink_to_fit 才会回收 begin_ 之后的所有缓冲区
         end_ = begin_;
+        shrink_to_fit();
     }
 
     // 交换两个 deque
-    template<class T>
-    void deque<T>::swap(deque &rhs) noexcept
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::swap(deque &rhs) noexcept
     {
         if (this != &rhs)
         {
+            mystl::alloc_on_swap(get_alloc(), rhs.get_alloc());
             mystl::swap(begin_, rhs.begin_);
             mystl::swap(end_, rhs.end_);
             mystl::swap(map_, rhs.map_);
             mystl::swap(map_size_, rhs.map_size_);
+            // 缓存的缓冲区由各自的分配器申请，随分配器一起交换
+            for (size_type i = 0; i < spare_capacity; ++i)
+                mystl::swap(spare_[i], rhs.spare_[i]);
+            mystl::swap(spare_count_, rhs.spare_count_);
         }
     }
 
     // helper function
 
-    template<class T>
-    typename deque<T>::map_pointer
-    deque<T>::create_map(size_type size)
+    template<class T, class Alloc, size_t BlockBytes>
+    typename deque<T, Alloc, BlockBytes>::map_pointer
+    deque<T, Alloc, BlockBytes>::create_map(size_type size)
     {
         map_pointer mp = nullptr;
-        mp = map_allocator::allocate(size);
+        map_allocator alloc(get_alloc());
+        mp = map_alloc_traits::allocate(alloc, size);
         for (size_type i = 0; i < size; ++i)
             *(mp + i) = nullptr;
         return mp;
     }
 
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::deallocate_map(map_pointer mp, size_type size)
+    {
+        map_allocator alloc(get_alloc());
+        map_alloc_traits::deallocate(alloc, mp, size);
+    }
+
     // create_buffer 函数
-    template<class T>
-    void deque<T>::
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::
     create_buffer(map_pointer nstart, map_pointer nfinish)
     {
         map_pointer cur;
@@ -898,7 +1054,9 @@ namespace mystl
         {
             for (cur = nstart; cur <= nfinish; ++cur)
             {
-                *cur = data_allocator::allocate(buffer_size);
+                // erase 之后留在 map 中的缓冲区直接沿用
+                if (*cur == nullptr)
+                    *cur = allocate_buffer();
             }
         }
         catch (...)
@@ -906,7 +1064,7 @@ namespace mystl
             while (cur != nstart)
             {
                 --cur;
-                data_allocator::deallocate(*cur, buffer_size);
+                deallocate_buffer(*cur);
                 *cur = nullptr;
             }
             throw;
@@ -914,20 +1072,81 @@ namespace mystl
     }
 
     // destroy_buffer 函数
-    template<class T>
-    void deque<T>::
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::
     destroy_buffer(map_pointer nstart, map_pointer nfinish)
     {
         for (map_pointer n = nstart; n <= nfinish; ++n)
         {
-            data_allocator::deallocate(*n, buffer_size);
+            deallocate_buffer(*n);
             *n = nullptr;
         }
     }
 
+    // 优先从空闲缓存中取缓冲区
+    template<class T, class Alloc, size_t BlockBytes>
+    typename deque<T, Alloc, BlockBytes>::pointer deque<T, Alloc, BlockBytes>::allocate_buffer()
+    {
+        if (spare_count_ != 0)
+            return spare_[--spare_count_];
+        return data_alloc_traits::allocate(get_alloc(), buffer_size);
+    }
+
+    // 缓存未满时留下缓冲区，否则归还给分配器
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::deallocate_buffer(pointer buffer) noexcept
+    {
+        if (spare_count_ < spare_capacity)
+            spare_[spare_count_++] = buffer;
+        else
+            data_alloc_traits::deallocate(get_alloc(), buffer, buffer_size);
+    }
+
+    // 把空闲缓存中的缓冲区全部归还给分配器
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::release_spare() noexcept
+    {
+        while (spare_count_ != 0)
+            data_alloc_traits::deallocate(get_alloc(), spare_[--spare_count_], buffer_size);
+    }
+
+    // 重新分配 map 前，把旧 map 中 [begin_.node, end_.node] 之外残留的缓冲区收进缓存，新 map 只接手使用中的缓冲区
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::recycle_outside_buffers() noexcept
+    {
+        for (auto cur = map_; cur < begin_.node; ++cur)
+        {
+            if (*cur == nullptr) continue;
+            deallocate_buffer(*cur);
+            *cur = nullptr;
+        }
+        for (auto cur = end_.node + 1; cur < map_ + map_size_; ++cur)
+        {
+            if (*cur == nullptr) continue;
+            deallocate_buffer(*cur);
+            *cur = nullptr;
+        }
+    }
+
+    // free_all 函数，析构所有元素并回收全部缓冲区和 map
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::free_all()
+    {
+        if (map_ != nullptr)
+        {
+            clear();
+            data_alloc_traits::deallocate(get_alloc(), *begin_.node, buffer_size);
+            *begin_.node = nullptr;
+            deallocate_map(map_, map_size_);
+            map_ = nullptr;
+            map_size_ = 0;
+        }
+        release_spare();
+    }
+
     // map_init 函数
-    template<class T>
-    void deque<T>::
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::
     map_init(size_type nElem)
     {
         const size_type nNode = nElem / buffer_size + 1;  // 需要分配的缓冲区个数
@@ -952,7 +1171,7 @@ namespace mystl
         }
         catch (...)
         {
-            map_allocator::deallocate(map_, map_size_);
+            deallocate_map(map_, map_size_);
             map_ = nullptr;
             map_size_ = 0;
             throw;
@@ -964,8 +1183,8 @@ namespace mystl
     }
 
     // fill_init 函数
-    template<class T>
-    void deque<T>::
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::
     fill_init(size_type n, const value_type &value)
     {
         map_init(n);
@@ -980,9 +1199,9 @@ namespace mystl
     }
 
     // copy_init 函数
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class IIter>
-    void deque<T>::
+    void deque<T, Alloc, BlockBytes>::
     copy_init(IIter first, IIter last, input_iterator_tag)
     {
         const size_type n = mystl::distance(first, last);
@@ -991,9 +1210,9 @@ namespace mystl
             emplace_back(*first);
     }
 
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class FIter>
-    void deque<T>::
+    void deque<T, Alloc, BlockBytes>::
     copy_init(FIter first, FIter last, forward_iterator_tag)
     {
         const size_type n = mystl::distance(first, last);
@@ -1009,8 +1228,8 @@ namespace mystl
     }
 
     // fill_assign 函数
-    template<class T>
-    void deque<T>::
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::
     fill_assign(size_type n, const value_type &value)
     {
         if (n > size())
@@ -1026,9 +1245,9 @@ namespace mystl
     }
 
     // copy_assign 函数
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class IIter>
-    void deque<T>::
+    void deque<T, Alloc, BlockBytes>::
     copy_assign(IIter first, IIter last, input_iterator_tag)
     {
         auto first1 = begin();
@@ -1047,9 +1266,9 @@ namespace mystl
         }
     }
 
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class FIter>
-    void deque<T>::
+    void deque<T, Alloc, BlockBytes>::
     copy_assign(FIter first, FIter last, forward_iterator_tag)
     {
         const size_type len1 = size();
@@ -1068,10 +1287,10 @@ namespace mystl
     }
 
     // insert_aux 函数
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class... Args>
-    typename deque<T>::iterator
-    deque<T>::
+    typename deque<T, Alloc, BlockBytes>::iterator
+    deque<T, Alloc, BlockBytes>::
     insert_aux(iterator position, Args &&...args)
     {
         const size_type elems_before = position - begin_;
@@ -1103,8 +1322,8 @@ namespace mystl
     }
 
     // fill_insert 函数
-    template<class T>
-    void deque<T>::fill_insert(iterator position, size_type n, const value_type &value)
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::fill_insert(iterator position, size_type n, const value_type &value)
     {
         const size_type elems_before = position - begin_;
         const size_type len = size();
@@ -1177,9 +1396,9 @@ namespace mystl
     }
 
     // copy_insert
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class FIter>
-    void deque<T>::
+    void deque<T, Alloc, BlockBytes>::
     copy_insert(iterator position, FIter first, FIter last, size_type n)
     {
         const size_type elems_before = position - begin_;
@@ -1256,9 +1475,9 @@ namespace mystl
     }
 
     // insert_dispatch 函数
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class IIter>
-    void deque<T>::
+    void deque<T, Alloc, BlockBytes>::
     insert_dispatch(iterator position, IIter first, IIter last, input_iterator_tag)
     {
         if (last <= first) return;
@@ -1280,9 +1499,9 @@ namespace mystl
         }
     }
 
-    template<class T>
+    template<class T, class Alloc, size_t BlockBytes>
     template<class FIter>
-    void deque<T>::
+    void deque<T, Alloc, BlockBytes>::
     insert_dispatch(iterator position, FIter first, FIter last, forward_iterator_tag)
     {
         if (last <= first) return;
@@ -1326,8 +1545,8 @@ namespace mystl
     }
 
     // require_capacity 函数
-    template<class T>
-    void deque<T>::require_capacity(size_type n, bool front)
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::require_capacity(size_type n, bool front)
     {
         if (front && (static_cast<size_type>(begin_.cur - begin_.first) < n))
         {
@@ -1352,9 +1571,17 @@ namespace mystl
     }
 
     // reallocate_map_at_front 函数
-    template<class T>
-    void deque<T>::reallocate_map_at_front(size_type need_buffer)
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::reallocate_map_at_front(size_type need_buffer)
     {
+        recycle_outside_buffers();
+        if (end_.node - begin_.node + 1 + need_buffer <= map_size_ / 2)
+        {
+            // map 只是用到了一头，另一头还空着大半：在原 map 中居中，不必加倍
+            recenter_map(need_buffer, true);
+            create_buffer(begin_.node - need_buffer, begin_.node - 1);
+            return;
+        }
         const size_type new_map_size = mystl::max(map_size_ << 1,
                                                   map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
         map_pointer new_map = create_map(new_map_size);
@@ -1366,11 +1593,10 @@ namespace mystl
         auto mid = begin + need_buffer;
         auto end = mid + old_buffer;
         create_buffer(begin, mid - 1);
-        for (auto begin1 = mid, begin2 = begin_.node; begin1 != end; ++begin1, ++begin2)
-            *begin1 = *begin2;
+        mystl::uninitialized_relocate(begin_.node, end_.node + 1, mid);
 
         // 更新数据
-        map_allocator::deallocate(map_, map_size_);
+        deallocate_map(map_, map_size_);
         map_ = new_map;
         map_size_ = new_map_size;
         begin_ = iterator(*mid + (begin_.cur - begin_.first), mid);
@@ -1378,9 +1604,17 @@ namespace mystl
     }
 
     // reallocate_map_at_back 函数
-    template<class T>
-    void deque<T>::reallocate_map_at_back(size_type need_buffer)
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::reallocate_map_at_back(size_type need_buffer)
     {
+        recycle_outside_buffers();
+        if (end_.node - begin_.node + 1 + need_buffer <= map_size_ / 2)
+        {
+            // map 只是用到了一头，另一头还空着大半：在原 map 中居中，不必加倍
+            recenter_map(need_buffer, false);
+            create_buffer(end_.node + 1, end_.node + need_buffer);
+            return;
+        }
         const size_type new_map_size = mystl::max(map_size_ << 1,
                                                   map_size_ + need_buffer + DEQUE_MAP_INIT_SIZE);
         map_pointer new_map = create_map(new_map_size);
@@ -1391,60 +1625,77 @@ namespace mystl
         auto begin = new_map + ((new_map_size - new_buffer) / 2);
         auto mid = begin + old_buffer;
         auto end = mid + need_buffer;
-        for (auto begin1 = begin, begin2 = begin_.node; begin1 != mid; ++begin1, ++begin2)
-            *begin1 = *begin2;
+        mystl::uninitialized_relocate(begin_.node, end_.node + 1, begin);
         create_buffer(mid, end - 1);
 
         // 更新数据
-        map_allocator::deallocate(map_, map_size_);
+        deallocate_map(map_, map_size_);
         map_ = new_map;
         map_size_ = new_map_size;
         begin_ = iterator(*begin + (begin_.cur - begin_.first), begin);
         end_ = iterator(*(mid - 1) + (end_.cur - end_.first), mid - 1);
     }
 
+    // recenter_map 函数：把使用中的节点移到 map 中央，并在 front 指定的一侧留出 need_buffer 个空位
+    template<class T, class Alloc, size_t BlockBytes>
+    void deque<T, Alloc, BlockBytes>::recenter_map(size_type need_buffer, bool front) noexcept
+    {
+        const size_type old_buffer = end_.node - begin_.node + 1;
+        const map_pointer nstart = map_ + (map_size_ - old_buffer - need_buffer) / 2 + (front ? need_buffer : 0);
+        if (nstart == begin_.node)
+            return;
+        // 新旧位置可能重叠，节点指针用 memmove 搬移；之后新区间以外的位置全部置空
+        std::memmove(nstart, begin_.node, old_buffer * sizeof(pointer));
+        for (auto cur = map_; cur < nstart; ++cur)
+            *cur = nullptr;
+        for (auto cur = nstart + old_buffer; cur < map_ + map_size_; ++cur)
+            *cur = nullptr;
+        begin_.node = nstart;
+        end_.node = nstart + old_buffer - 1;
+    }
+
     // 重载比较操作符
-    template<class T>
-    bool operator==(const deque<T> &lhs, const deque<T> &rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    bool operator==(const deque<T, Alloc, BlockBytes> &lhs, const deque<T, Alloc, BlockBytes> &rhs)
     {
         return lhs.size() == rhs.size() &&
                mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
-    template<class T>
-    bool operator<(const deque<T> &lhs, const deque<T> &rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    bool operator<(const deque<T, Alloc, BlockBytes> &lhs, const deque<T, Alloc, BlockBytes> &rhs)
     {
         return mystl::lexicographical_compare(
                 lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
-    template<class T>
-    bool operator!=(const deque<T> &lhs, const deque<T> &rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    bool operator!=(const deque<T, Alloc, BlockBytes> &lhs, const deque<T, Alloc, BlockBytes> &rhs)
     {
         return !(lhs == rhs);
     }
 
-    template<class T>
-    bool operator>(const deque<T> &lhs, const deque<T> &rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    bool operator>(const deque<T, Alloc, BlockBytes> &lhs, const deque<T, Alloc, BlockBytes> &rhs)
     {
         return rhs < lhs;
     }
 
-    template<class T>
-    bool operator<=(const deque<T> &lhs, const deque<T> &rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    bool operator<=(const deque<T, Alloc, BlockBytes> &lhs, const deque<T, Alloc, BlockBytes> &rhs)
     {
         return !(rhs < lhs);
     }
 
-    template<class T>
-    bool operator>=(const deque<T> &lhs, const deque<T> &rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    bool operator>=(const deque<T, Alloc, BlockBytes> &lhs, const deque<T, Alloc, BlockBytes> &rhs)
     {
         return !(lhs < rhs);
     }
 
     // 重载 mystl 的 swap
-    template<class T>
-    void swap(deque<T> &lhs, deque<T> &rhs)
+    template<class T, class Alloc, size_t BlockBytes>
+    void swap(deque<T, Alloc, BlockBytes> &lhs, deque<T, Alloc, BlockBytes> &rhs)
     {
         lhs.swap(rhs);
     }
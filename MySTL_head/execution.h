@@ -0,0 +1,563 @@
+/**
+ * @file execution.h
+ * @brief 执行策略 seq / par / par_unseq，以及 sort、fill、copy、equal、transform、reduce、for_each 的带策略版本
+ */
+
+#ifndef MYSTL_EXECUTION_H
+#define MYSTL_EXECUTION_H
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+#include "algo.h"
+#include "algobase.h"
+#include "iterator.h"
+#include "numeric.h"
+#include "thread_pool.h"
+#include "vector.h"
+#include "util.h"
+
+namespace mystl
+{
+    /// ================================================================================================================
+    /// @brief 执行策略
+    /// ================================================================================================================
+
+    /**
+     * @brief seq 在调用线程上顺序执行；par / par_unseq 把区间分块交给线程池并行执行
+     * @note par_unseq 与 par 的执行方式相同，每一块内部的向量化交给编译器
+     * @note 并行执行要求迭代器是随机访问迭代器，否则退化为顺序执行
+     * @note 与 std 不同，并行执行中元素操作抛出的异常不会调用 std::terminate，而是在所有块结束后传播其中一个
+     * */
+
+    namespace execution
+    {
+        class sequenced_policy
+        {
+        };
+
+        /// @brief 并行策略的公共部分：使用的线程池，默认为 thread_pool::default_pool()
+        class parallel_policy_base
+        {
+        private:
+            thread_pool *pool_;
+
+        protected:
+            constexpr explicit parallel_policy_base(thread_pool *pool) noexcept: pool_(pool) {}
+
+        public:
+            thread_pool &pool() const
+            {
+                return pool_ != nullptr ? *pool_ : thread_pool::default_pool();
+            }
+        };
+
+        class parallel_policy : public parallel_policy_base
+        {
+        public:
+            constexpr parallel_policy() noexcept: parallel_policy_base(nullptr) {}
+
+            constexpr explicit parallel_policy(thread_pool &pool) noexcept: parallel_policy_base(&pool) {}
+
+            /// @brief 例如 mystl::sort(mystl::execution::par.on(pool), first, last)
+            parallel_policy on(thread_pool &pool) const noexcept { return parallel_policy(pool); }
+        };
+
+        class parallel_unsequenced_policy : public parallel_policy_base
+        {
+        public:
+            constexpr parallel_unsequenced_policy() noexcept: parallel_policy_base(nullptr) {}
+
+            constexpr explicit parallel_unsequenced_policy(thread_pool &pool) noexcept: parallel_policy_base(&pool) {}
+
+            parallel_unsequenced_policy on(thread_pool &pool) const noexcept
+            {
+                return parallel_unsequenced_policy(pool);
+            }
+        };
+
+        constexpr sequenced_policy seq{};
+        constexpr parallel_policy par{};
+        constexpr parallel_unsequenced_policy par_unseq{};
+    }
+
+    template<typename T>
+    struct is_execution_policy : std::false_type {};
+
+    template<>
+    struct is_execution_policy<execution::sequenced_policy> : std::true_type {};
+
+    template<>
+    struct is_execution_policy<execution::parallel_policy> : std::true_type {};
+
+    template<>
+    struct is_execution_policy<execution::parallel_unsequenced_policy> : std::true_type {};
+
+    /// @brief 只有第一个参数是执行策略时才参与重载决议，避免与 equal(first1, last1, first2, comp) 等重载冲突
+    template<typename Policy, typename R>
+    using enable_if_execution_policy_t =
+            typename std::enable_if<is_execution_policy<typename std::decay<Policy>::type>::value, R>::type;
+
+    /// @brief Policy 是并行策略且所有迭代器都是随机访问迭代器时为 true_type
+    template<typename Policy, typename... Iters>
+    struct use_parallel;
+
+    template<typename Policy>
+    struct use_parallel<Policy> : std::integral_constant<bool, !std::is_same<typename std::decay<Policy>::type,
+            execution::sequenced_policy>::value>
+    {
+    };
+
+    template<typename Policy, typename Iter, typename... Iters>
+    struct use_parallel<Policy, Iter, Iters...>
+            : std::integral_constant<bool, is_random_access_iterator<Iter>::value && use_parallel<Policy, Iters...>::value>
+    {
+    };
+
+    /// ================================================================================================================
+    /// @brief 分块
+    /// ================================================================================================================
+
+    /// @brief 每块至少包含的元素个数，更小的块调度开销超过收益
+    constexpr size_t parallel_min_chunk = 16384;
+
+    /// @brief 每个线程平均分到的块数，块数多于线程数时先完成的线程可以窃取剩余的块
+    constexpr size_t parallel_chunks_per_thread = 4;
+
+    /// @brief n 个元素分成的块数，为 1 时应直接顺序执行
+    inline size_t parallel_chunk_count(const thread_pool &pool, size_t n) noexcept
+    {
+        const size_t by_size = n / parallel_min_chunk;
+        const size_t by_thread = pool.concurrency() == 1 ? 1 : pool.concurrency() * parallel_chunks_per_thread;
+        return by_size < 1 ? 1 : (by_size < by_thread ? by_size : by_thread);
+    }
+
+    /**
+     * @brief 把 [0, n) 均分为 chunks 块，对第 i 块 [begin, end) 调用 f(i, begin, end)
+     * @note 调用线程执行最后一块，然后在等待其它块时帮忙执行池中的任务
+     * */
+    template<typename Function>
+    void parallel_run_chunks(thread_pool &pool, size_t n, size_t chunks, Function f)
+    {
+        task_group group(pool);
+        const size_t base = n / chunks;
+        const size_t extra = n % chunks;
+        size_t begin = 0;
+        for (size_t i = 0; i + 1 < chunks; ++i)
+        {
+            const size_t end = begin + base + (i < extra ? 1 : 0);
+            group.run([f, i, begin, end]() mutable { f(i, begin, end); });
+            begin = end;
+        }
+        f(chunks - 1, begin, n);
+        group.wait();
+    }
+
+    template<typename Function>
+    void parallel_for_chunks(thread_pool &pool, size_t n, Function f)
+    {
+        const size_t chunks = mystl::parallel_chunk_count(pool, n);
+        if (chunks == 1)
+        {
+            f(size_t(0), size_t(0), n);
+            return;
+        }
+        mystl::parallel_run_chunks(pool, n, chunks, f);
+    }
+
+    /// ================================================================================================================
+    /// @brief for_each
+    /// ================================================================================================================
+
+    template<typename Policy, typename ForwardIter, typename Function>
+    void for_each_policy(const Policy &, ForwardIter first, ForwardIter last, Function f, std::false_type)
+    {
+        mystl::for_each(first, last, f);
+    }
+
+    template<typename Policy, typename RandomIter, typename Function>
+    void for_each_policy(const Policy &policy, RandomIter first, RandomIter last, Function f, std::true_type)
+    {
+        mystl::parallel_for_chunks(policy.pool(), static_cast<size_t>(last - first),
+                                   [first, f](size_t, size_t begin, size_t end)
+                                   {
+                                       mystl::for_each(first + begin, first + end, f);
+                                   });
+    }
+
+    /// @brief 对每个元素调用 f，并行执行时 f 会被复制到各个线程，不同元素上的调用没有先后顺序
+    template<typename Policy, typename ForwardIter, typename Function>
+    enable_if_execution_policy_t<Policy, void>
+    for_each(Policy &&policy, ForwardIter first, ForwardIter last, Function f)
+    {
+        mystl::for_each_policy(policy, first, last, f, typename use_parallel<Policy, ForwardIter>::type());
+    }
+
+    /// ================================================================================================================
+    /// @brief fill
+    /// ================================================================================================================
+
+    template<typename Policy, typename ForwardIter, typename T>
+    void fill_policy(const Policy &, ForwardIter first, ForwardIter last, const T &value, std::false_type)
+    {
+        mystl::fill(first, last, value);
+    }
+
+    template<typename Policy, typename RandomIter, typename T>
+    void fill_policy(const Policy &policy, RandomIter first, RandomIter last, const T &value, std::true_type)
+    {
+        mystl::parallel_for_chunks(policy.pool(), static_cast<size_t>(last - first),
+                                   [first, &value](size_t, size_t begin, size_t end)
+                                   {
+                                       mystl::fill(first + begin, first + end, value);
+                                   });
+    }
+
+    template<typename Policy, typename ForwardIter, typename T>
+    enable_if_execution_policy_t<Policy, void>
+    fill(Policy &&policy, ForwardIter first, ForwardIter last, const T &value)
+    {
+        mystl::fill_policy(policy, first, last, value, typename use_parallel<Policy, ForwardIter>::type());
+    }
+
+    /// ================================================================================================================
+    /// @brief copy
+    /// ================================================================================================================
+
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2>
+    ForwardIter2 copy_policy(const Policy &, ForwardIter1 first, ForwardIter1 last, ForwardIter2 result,
+                             std::false_type)
+    {
+        return mystl::copy(first, last, result);
+    }
+
+    template<typename Policy, typename RandomIter1, typename RandomIter2>
+    RandomIter2 copy_policy(const Policy &policy, RandomIter1 first, RandomIter1 last, RandomIter2 result,
+                            std::true_type)
+    {
+        const size_t n = static_cast<size_t>(last - first);
+        mystl::parallel_for_chunks(policy.pool(), n, [first, result](size_t, size_t begin, size_t end)
+        {
+            mystl::copy(first + begin, first + end, result + begin);
+        });
+        return result + n;
+    }
+
+    /// @brief 源区间与目标区间不能重叠
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2>
+    enable_if_execution_policy_t<Policy, ForwardIter2>
+    copy(Policy &&policy, ForwardIter1 first, ForwardIter1 last, ForwardIter2 result)
+    {
+        return mystl::copy_policy(policy, first, last, result,
+                                  typename use_parallel<Policy, ForwardIter1, ForwardIter2>::type());
+    }
+
+    /// ================================================================================================================
+    /// @brief transform
+    /// ================================================================================================================
+
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2, typename UnaryOperation>
+    ForwardIter2 transform_policy(const Policy &, ForwardIter1 first, ForwardIter1 last, ForwardIter2 result,
+                                  UnaryOperation op, std::false_type)
+    {
+        return mystl::transform(first, last, result, op);
+    }
+
+    template<typename Policy, typename RandomIter1, typename RandomIter2, typename UnaryOperation>
+    RandomIter2 transform_policy(const Policy &policy, RandomIter1 first, RandomIter1 last, RandomIter2 result,
+                                 UnaryOperation op, std::true_type)
+    {
+        const size_t n = static_cast<size_t>(last - first);
+        mystl::parallel_for_chunks(policy.pool(), n, [first, result, op](size_t, size_t begin, size_t end)
+        {
+            mystl::transform(first + begin, first + end, result + begin, op);
+        });
+        return result + n;
+    }
+
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2, typename UnaryOperation>
+    enable_if_execution_policy_t<Policy, ForwardIter2>
+    transform(Policy &&policy, ForwardIter1 first, ForwardIter1 last, ForwardIter2 result, UnaryOperation op)
+    {
+        return mystl::transform_policy(policy, first, last, result, op,
+                                       typename use_parallel<Policy, ForwardIter1, ForwardIter2>::type());
+    }
+
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2, typename ForwardIter3,
+            typename BinaryOperation>
+    ForwardIter3 transform_policy(const Policy &, ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2,
+                                  ForwardIter3 result, BinaryOperation op, std::false_type)
+    {
+        return mystl::transform(first1, last1, first2, result, op);
+    }
+
+    template<typename Policy, typename RandomIter1, typename RandomIter2, typename RandomIter3,
+            typename BinaryOperation>
+    RandomIter3 transform_policy(const Policy &policy, RandomIter1 first1, RandomIter1 last1, RandomIter2 first2,
+                                 RandomIter3 result, BinaryOperation op, std::true_type)
+    {
+        const size_t n = static_cast<size_t>(last1 - first1);
+        mystl::parallel_for_chunks(policy.pool(), n, [first1, first2, result, op](size_t, size_t begin, size_t end)
+        {
+            mystl::transform(first1 + begin, first1 + end, first2 + begin, result + begin, op);
+        });
+        return result + n;
+    }
+
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2, typename ForwardIter3,
+            typename BinaryOperation>
+    enable_if_execution_policy_t<Policy, ForwardIter3>
+    transform(Policy &&policy, ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, ForwardIter3 result,
+              BinaryOperation op)
+    {
+        return mystl::transform_policy(policy, first1, last1, first2, result, op,
+                                       typename use_parallel<Policy, ForwardIter1, ForwardIter2, ForwardIter3>::type());
+    }
+
+    /// ================================================================================================================
+    /// @brief equal
+    /// ================================================================================================================
+
+    /**
+     * @brief 把 [0, n) 分块并行比较，每块再按 parallel_min_chunk 分段调用 same(begin, stop)，
+     * @brief 任何一段发现不相等后其余块在下一段开始前停止
+     * */
+    template<typename Policy, typename Same>
+    bool equal_chunks(const Policy &policy, size_t n, Same same)
+    {
+        std::atomic<bool> differ(false);
+        mystl::parallel_for_chunks(policy.pool(), n, [same, &differ](size_t, size_t begin, size_t end)
+        {
+            while (begin < end && !differ.load(std::memory_order_relaxed))
+            {
+                const size_t stop = end - begin > parallel_min_chunk ? begin + parallel_min_chunk : end;
+                if (!same(begin, stop))
+                {
+                    differ.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                begin = stop;
+            }
+        });
+        return !differ.load(std::memory_order_relaxed);
+    }
+
+    /// @brief 不带比较函数的版本调用三参数的 mystl::equal，保留它的 simd / memcmp 以及分段迭代器快速路径
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2>
+    bool equal_policy(const Policy &, ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, std::false_type)
+    {
+        return mystl::equal(first1, last1, first2);
+    }
+
+    template<typename Policy, typename RandomIter1, typename RandomIter2>
+    bool equal_policy(const Policy &policy, RandomIter1 first1, RandomIter1 last1, RandomIter2 first2, std::true_type)
+    {
+        return mystl::equal_chunks(policy, static_cast<size_t>(last1 - first1),
+                                   [first1, first2](size_t begin, size_t stop)
+                                   {
+                                       return mystl::equal(first1 + begin, first1 + stop, first2 + begin);
+                                   });
+    }
+
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2, typename Compared>
+    bool equal_policy(const Policy &, ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, Compared comp,
+                      std::false_type)
+    {
+        return mystl::equal(first1, last1, first2, comp);
+    }
+
+    template<typename Policy, typename RandomIter1, typename RandomIter2, typename Compared>
+    bool equal_policy(const Policy &policy, RandomIter1 first1, RandomIter1 last1, RandomIter2 first2, Compared comp,
+                      std::true_type)
+    {
+        return mystl::equal_chunks(policy, static_cast<size_t>(last1 - first1),
+                                   [first1, first2, comp](size_t begin, size_t stop)
+                                   {
+                                       return mystl::equal(first1 + begin, first1 + stop, first2 + begin, comp);
+                                   });
+    }
+
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2>
+    enable_if_execution_policy_t<Policy, bool>
+    equal(Policy &&policy, ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2)
+    {
+        return mystl::equal_policy(policy, first1, last1, first2,
+                                   typename use_parallel<Policy, ForwardIter1, ForwardIter2>::type());
+    }
+
+    template<typename Policy, typename ForwardIter1, typename ForwardIter2, typename Compared>
+    enable_if_execution_policy_t<Policy, bool>
+    equal(Policy &&policy, ForwardIter1 first1, ForwardIter1 last1, ForwardIter2 first2, Compared comp)
+    {
+        return mystl::equal_policy(policy, first1, last1, first2, comp,
+                                   typename use_parallel<Policy, ForwardIter1, ForwardIter2>::type());
+    }
+
+    /// ================================================================================================================
+    /// @brief reduce
+    /// ================================================================================================================
+
+    template<typename Policy, typename ForwardIter, typename T, typename BinaryOperation>
+    T reduce_policy(const Policy &, ForwardIter first, ForwardIter last, T init, BinaryOperation op, std::false_type)
+    {
+        return mystl::reduce(first, last, mystl::move(init), op);
+    }
+
+    /**
+     * @brief 每块以自己的第一个元素为初值求部分和，最后按块的顺序把部分和合并到 init 上
+     * @note 块的划分只取决于元素个数和线程数，同样的输入和线程池得到的结果(包括浮点舍入)相同
+     * */
+    template<typename Policy, typename RandomIter, typename T, typename BinaryOperation>
+    T reduce_policy(const Policy &policy, RandomIter first, RandomIter last, T init, BinaryOperation op,
+                    std::true_type)
+    {
+        thread_pool &pool = policy.pool();
+        const size_t n = static_cast<size_t>(last - first);
+        const size_t chunks = mystl::parallel_chunk_count(pool, n);
+        if (chunks == 1)
+            return mystl::reduce(first, last, mystl::move(init), op);
+
+        mystl::vector<T> partial(chunks, init);
+        mystl::parallel_run_chunks(pool, n, chunks, [first, op, &partial](size_t i, size_t begin, size_t end)
+        {
+            partial[i] = mystl::accumulate(first + (begin + 1), first + end, static_cast<T>(*(first + begin)), op);
+        });
+        for (size_t i = 0; i < chunks; ++i)
+            init = op(mystl::move(init), mystl::move(partial[i]));
+        return init;
+    }
+
+    template<typename Policy, typename ForwardIter, typename T, typename BinaryOperation>
+    enable_if_execution_policy_t<Policy, T>
+    reduce(Policy &&policy, ForwardIter first, ForwardIter last, T init, BinaryOperation op)
+    {
+        return mystl::reduce_policy(policy, first, last, mystl::move(init), op,
+                                    typename use_parallel<Policy, ForwardIter>::type());
+    }
+
+    template<typename Policy, typename ForwardIter, typename T>
+    enable_if_execution_policy_t<Policy, T>
+    reduce(Policy &&policy, ForwardIter first, ForwardIter last, T init)
+    {
+        return mystl::reduce(policy, first, last, mystl::move(init), mystl::plus<T>());
+    }
+
+    template<typename Policy, typename ForwardIter>
+    enable_if_execution_policy_t<Policy, typename iterator_traits<ForwardIter>::value_type>
+    reduce(Policy &&policy, ForwardIter first, ForwardIter last)
+    {
+        typedef typename iterator_traits<ForwardIter>::value_type T;
+        return mystl::reduce(policy, first, last, T());
+    }
+
+    /// ================================================================================================================
+    /// @brief sort
+    /// ================================================================================================================
+
+    /**
+     * @brief 与 introsort_loop 相同的划分过程，但左侧子区间作为任务交给线程池，当前线程继续处理右侧
+     * @note 区间不超过 cutoff 后交给顺序的 introsort_loop，并保留 bad_allowed 与 leftmost 状态
+     * @note 已放好的枢轴不会再移动，相邻任务只读取它作为插入排序的哨兵
+     * */
+    template<typename RandomIter, typename Compare, typename Branchless>
+    void parallel_introsort_loop(RandomIter first, RandomIter last, Compare comp, int bad_allowed, bool leftmost,
+                                 Branchless branchless,
+                                 typename iterator_traits<RandomIter>::difference_type cutoff, task_group &group)
+    {
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        while (true)
+        {
+            const Distance len = last - first;
+            if (len <= cutoff)
+            {
+                mystl::introsort_loop(first, last, comp, bad_allowed, leftmost, branchless);
+                return;
+            }
+
+            mystl::choose_pivot(first, last, comp);
+            if (!leftmost && !comp(*(first - 1), *first))
+            {
+                first = mystl::partition_left(first, last, comp) + 1;
+                continue;
+            }
+
+            const mystl::pair<RandomIter, bool> part = mystl::partition_right(first, last, comp, branchless);
+            const RandomIter pivot_pos = part.first;
+            const Distance l_size = pivot_pos - first;
+            const Distance r_size = last - (pivot_pos + 1);
+
+            if (l_size < len / 8 || r_size < len / 8)
+            {
+                if (--bad_allowed == 0)
+                {
+                    mystl::make_heap(first, last, comp);
+                    mystl::sort_heap(first, last, comp);
+                    return;
+                }
+                mystl::break_patterns(first, pivot_pos, last);
+            }
+            else if (part.second && mystl::partial_insertion_sort(first, pivot_pos, comp) &&
+                     mystl::partial_insertion_sort(pivot_pos + 1, last, comp))
+            {
+                return;
+            }
+
+            group.run([first, pivot_pos, comp, bad_allowed, leftmost, branchless, cutoff, &group]
+                      {
+                          mystl::parallel_introsort_loop(first, pivot_pos, comp, bad_allowed, leftmost, branchless,
+                                                         cutoff, group);
+                      });
+            first = pivot_pos + 1;
+            leftmost = false;
+        }
+    }
+
+    template<typename Policy, typename RandomIter, typename Compare>
+    void sort_policy(const Policy &, RandomIter first, RandomIter last, Compare comp, std::false_type)
+    {
+        mystl::sort(first, last, comp);
+    }
+
+    template<typename Policy, typename RandomIter, typename Compare>
+    void sort_policy(const Policy &policy, RandomIter first, RandomIter last, Compare comp, std::true_type)
+    {
+        typedef typename iterator_traits<RandomIter>::value_type T;
+        typedef typename iterator_traits<RandomIter>::difference_type Distance;
+        thread_pool &pool = policy.pool();
+        const Distance len = last - first;
+        if (pool.concurrency() == 1 || len <= static_cast<Distance>(parallel_min_chunk))
+        {
+            mystl::sort(first, last, comp);
+            return;
+        }
+        // 叶子区间的大小让每个线程平均分到若干个，划分不均时空闲线程可以窃取
+        Distance cutoff = len / static_cast<Distance>(pool.concurrency() * parallel_chunks_per_thread * 2);
+        if (cutoff < static_cast<Distance>(parallel_min_chunk))
+            cutoff = static_cast<Distance>(parallel_min_chunk);
+        int log2 = 0;
+        for (Distance n = len; n >>= 1;)
+            ++log2;
+        task_group group(pool);
+        mystl::parallel_introsort_loop(first, last, comp, log2, true,
+                                       typename is_branchless_sortable<T, Compare>::type(), cutoff, group);
+        group.wait();
+    }
+
+    template<typename Policy, typename RandomIter, typename Compare>
+    enable_if_execution_policy_t<Policy, void>
+    sort(Policy &&policy, RandomIter first, RandomIter last, Compare comp)
+    {
+        static_assert(is_random_access_iterator<RandomIter>::value, "sort requires random access iterators");
+        mystl::sort_policy(policy, first, last, comp, typename use_parallel<Policy, RandomIter>::type());
+    }
+
+    template<typename Policy, typename RandomIter>
+    enable_if_execution_policy_t<Policy, void>
+    sort(Policy &&policy, RandomIter first, RandomIter last)
+    {
+        mystl::sort(policy, first, last, mystl::less<typename iterator_traits<RandomIter>::value_type>());
+    }
+}
+
+#endif //MYSTL_EXECUTION_H
@@ -34,6 +34,13 @@ namespace mystl
         typedef Result result_type;
     };
 
+    /// @brief 函数对象，加法
+    template<typename T>
+    struct plus : public binary_function<T, T, T>
+    {
+        T operator()(const T &x, const T &y) const { return x + y; }
+    };
+
     /// @brief 函数对象 等于
     template<typename T>
     struct equal_to : public binary_function<T, T, bool>
@@ -47,6 +54,13 @@ namespace mystl
     {
         bool operator()(const T& x, const T& y) const { return x < y; }
     };
+
+    /// @brief 函数对象，大于
+    template<typename T>
+    struct greater : public binary_function<T, T, bool>
+    {
+        bool operator()(const T &x, const T &y) const { return x > y; }
+    };
 }
 
 #endif //MYSTL_FUNCTIONAL_H
@@ -0,0 +1,106 @@
+/**
+ * @file growth_policy.h
+ * @brief vector 的容量增长策略：精确分配、1.5 倍、2 倍、按页取整、按大页取整
+ */
+
+#ifndef MYSTL_GROWTH_POLICY_H
+#define MYSTL_GROWTH_POLICY_H
+
+#include <cstddef>
+
+namespace mystl
+{
+    /// ================================================================================================================
+    /// @brief 增长策略
+    /// ================================================================================================================
+
+    /**
+     * @brief 增长策略是只含静态成员函数的类型，作为 vector 的第三个模板参数：
+     * @brief initial_capacity(n, elem_size, max_cap)            用 n 个元素构造时分配的容量
+     * @brief new_capacity(old_cap, required, elem_size, max_cap) 容量不足时的新容量，至少为 required
+     * @note 调用者保证 required <= max_cap；返回值不会超过 max_cap
+     * */
+
+    /// @brief 精确分配：需要多少分配多少(不少于 MinCap)，最省内存，但逐个 push_back 时每次都要重新分配
+    template<size_t MinCap = 0>
+    struct growth_exact
+    {
+        static size_t initial_capacity(size_t n, size_t, size_t max_cap) noexcept
+        {
+            return n < MinCap && MinCap <= max_cap ? MinCap : n;
+        }
+
+        static size_t new_capacity(size_t, size_t required, size_t, size_t max_cap) noexcept
+        {
+            return required < MinCap && MinCap <= max_cap ? MinCap : required;
+        }
+    };
+
+    /// @brief 按 Num / Den 倍增长，第一次分配至少 MinCap 个元素
+    template<size_t Num, size_t Den, size_t MinCap = 16>
+    struct growth_factor
+    {
+        static_assert(Num > Den && Den > 0, "growth factor must be greater than 1");
+
+        static size_t initial_capacity(size_t n, size_t elem_size, size_t max_cap) noexcept
+        {
+            return growth_exact<MinCap>::initial_capacity(n, elem_size, max_cap);
+        }
+
+        static size_t new_capacity(size_t old_cap, size_t required, size_t elem_size, size_t max_cap) noexcept
+        {
+            if (old_cap == 0)
+                return growth_exact<MinCap>::new_capacity(0, required, elem_size, max_cap);
+            // old_cap * Num / Den 会超过 max_cap 时直接取 max_cap
+            const size_t grown = old_cap > max_cap / Num * Den ? max_cap : old_cap / Den * Num + old_cap % Den * Num / Den;
+            return grown < required ? required : grown;
+        }
+    };
+
+    template<size_t MinCap = 16>
+    using growth_1_5x = growth_factor<3, 2, MinCap>;
+
+    template<size_t MinCap = 16>
+    using growth_2x = growth_factor<2, 1, MinCap>;
+
+    /**
+     * @brief 在 Base 策略的基础上，把不小于一页的分配向上取整到整页，避免尾页被浪费
+     * @note 小于一页的分配保持 Base 的结果，大量小 vector 不会因此膨胀
+     * */
+
+    template<typename Base = growth_2x<>, size_t PageSize = 4096>
+    struct growth_page_rounded
+    {
+        static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of 2");
+
+        static size_t initial_capacity(size_t n, size_t elem_size, size_t max_cap) noexcept
+        {
+            return round(Base::initial_capacity(n, elem_size, max_cap), elem_size, max_cap);
+        }
+
+        static size_t new_capacity(size_t old_cap, size_t required, size_t elem_size, size_t max_cap) noexcept
+        {
+            return round(Base::new_capacity(old_cap, required, elem_size, max_cap), elem_size, max_cap);
+        }
+
+    private:
+        static size_t round(size_t cap, size_t elem_size, size_t max_cap) noexcept
+        {
+            if (elem_size == 0 || cap > (static_cast<size_t>(-1) - PageSize) / elem_size) return cap;
+            const size_t bytes = cap * elem_size;
+            if (bytes < PageSize) return cap;
+            const size_t rounded = ((bytes + PageSize - 1) & ~(PageSize - 1)) / elem_size;
+            return rounded > max_cap ? cap : rounded;
+        }
+    };
+
+    /// @brief 按 2MiB 大页取整，适合几十 MB 以上、希望由透明大页承载的缓冲区
+    template<typename Base = growth_2x<>>
+    using growth_huge_page_rounded = growth_page_rounded<Base, 2 * 1024 * 1024>;
+
+    /// @brief vector 默认的增长策略：第一次至少 16 个元素，之后按 1.5 倍增长
+    typedef growth_1_5x<16> default_growth;
+
+}
+
+#endif //MYSTL_GROWTH_POLICY_H
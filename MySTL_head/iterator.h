@@ -182,6 +182,25 @@ namespace mystl
     {
     };
 
+    /// ================================================================================================================
+    /// @brief 分段迭代器
+    /// ================================================================================================================
+
+    /**
+     * @brief 分段迭代器遍历的是若干段连续存储(例如 deque 的各个缓冲区)，算法可以逐段在原始指针区间上执行，
+     * @brief 省去每一步的段边界检查，平凡类型还能每段一次 memmove / memset
+     * @note 特化需要提供 segment_iterator、local_iterator 两个类型，以及静态函数
+     * @note segment(it)、local(it)、begin(seg)、end(seg)、compose(seg, local)
+     * */
+    template<typename Iterator>
+    struct segmented_iterator_traits
+    {
+        typedef std::false_type is_segmented_iterator;
+    };
+
+    template<typename Iterator>
+    struct is_segmented_iterator : public segmented_iterator_traits<Iterator>::is_segmented_iterator {};
+
     /// ================================================================================================================
     /// @brief 迭代器traits -> 萃取category distance_type value_type
     /// ================================================================================================================
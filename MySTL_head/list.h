@@ -17,9 +17,12 @@
 #include "util.h"
 #include "iterator.h"
 #include "allocator.h"
+#include "allocator_traits.h"
 #include "memory.h"
+#include "pool_allocator.h"
 #include "exceptdef.h"
 #include "functional.h"
+#include "algo.h"
 
 namespace mystl
 {
@@ -208,7 +211,7 @@ namespace mystl
 
         explicit list_const_iterator(node_ptr x) : node_(x->as_base()) {}
 
-        explicit list_const_iterator(const list_iterator<T> &lhs) : node_(lhs.node_) {}
+        list_const_iterator(const list_iterator<T> &lhs) : node_(lhs.node_) {}
 
         list_const_iterator(const list_const_iterator &lhs) : node_(lhs.node_) {}
 
@@ -265,25 +268,42 @@ namespace mystl
         }
     };
 
+    /// ================================================================================================================
+    /// @brief list::sort 的策略
+    /// ================================================================================================================
+
+    /**
+     * @brief relink   自底向上的归并：只修改节点的指针，不分配内存
+     * @brief buffered 先把节点(平凡可复制的小元素连同值一起)收集到连续的缓冲区，在缓冲区上 stable_sort 后一次性重新链接；
+     * @brief          节点很多时避免了归并过程中沿链表的指针追逐，缓冲区申请失败时退回 relink
+     * */
+    enum class list_sort_mode
+    {
+        relink, buffered
+    };
+
     /// ================================================================================================================
     /// @brief 模板类 list
     /// ================================================================================================================
-    template<typename T>
-    class list
+    template<typename T, typename Alloc = mystl::allocator<T>>
+    class list : private mystl::alloc_holder<
+            typename mystl::allocator_traits<Alloc>::template rebind_alloc<list_node<T>>>
     {
+        static_assert(std::is_same<T, typename Alloc::value_type>::value,
+                      "the value_type of Alloc must be the same as T in list<T, Alloc>");
+
     public:
-        typedef mystl::allocator<T> allocator_type;
-        typedef mystl::allocator<T> data_allocator;
-        typedef mystl::allocator<list_node_base<T>> base_allocator;
-        typedef mystl::allocator<list_node<T>> node_allocator;
-
-        typedef typename allocator_type::value_type value_type;
-        typedef typename allocator_type::pointer pointer;
-        typedef typename allocator_type::const_pointer const_pointer;
-        typedef typename allocator_type::reference reference;
-        typedef typename allocator_type::const_reference const_reference;
-        typedef typename allocator_type::size_type size_type;
-        typedef typename allocator_type::difference_type difference_type;
+        typedef Alloc allocator_type;
+        typedef typename mystl::allocator_traits<Alloc>::template rebind_alloc<list_node<T>> node_allocator;
+        typedef mystl::allocator_traits<node_allocator> node_alloc_traits;
+
+        typedef T value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef typename node_alloc_traits::size_type size_type;
+        typedef typename node_alloc_traits::difference_type difference_type;
 
         typedef list_iterator<T> iterator;
         typedef list_const_iterator<T> const_iterator;
@@ -293,51 +313,70 @@ namespace mystl
         typedef typename node_traits<T>::base_ptr base_ptr;
         typedef typename node_traits<T>::node_ptr node_ptr;
 
-        allocator_type get_allocator() { return node_allocator(); }
+        allocator_type get_allocator() const { return allocator_type(get_alloc()); }
 
     private:
-        // 指向末尾节点
-        base_ptr node_;
+        typedef mystl::alloc_holder<node_allocator> holder_type;
+
+        using holder_type::get_alloc;
+
+        // 哨兵节点直接放在 list 对象中：空链表不需要分配，构造、移动、交换都不会抛出异常
+        list_node_base<T> sentinel_;
         size_type size_;
 
     public:
         /// ------------------------------------------------------------------------------------------------------------
         /// @brief 构造函数
         /// ------------------------------------------------------------------------------------------------------------
-        list()
+        list() noexcept: size_(0)
         {
-            fill_init(0, value_type());
+            sentinel_.unlink();
         }
 
-        explicit list(size_type n)
+        explicit list(const allocator_type &alloc) noexcept: holder_type(node_allocator(alloc)), size_(0)
+        {
+            sentinel_.unlink();
+        }
+
+        explicit list(size_type n, const allocator_type &alloc = allocator_type())
+                : holder_type(node_allocator(alloc))
         {
             fill_init(n, value_type());
         }
 
-        list(size_type n, const T &value)
+        list(size_type n, const T &value, const allocator_type &alloc = allocator_type())
+                : holder_type(node_allocator(alloc))
         {
             fill_init(n, value);
         }
 
         template<class Iter, typename std::enable_if<mystl::is_input_iterator<Iter>::value, int>::type = 0>
-        list(Iter first, Iter last)
+        list(Iter first, Iter last, const allocator_type &alloc = allocator_type())
+                : holder_type(node_allocator(alloc))
         {
             copy_init(first, last);
         }
 
-        list(std::initializer_list<T> ilist)
+        list(std::initializer_list<T> ilist, const allocator_type &alloc = allocator_type())
+                : holder_type(node_allocator(alloc))
         {
             copy_init(ilist.begin(), ilist.end());
         }
 
         list(const list &lhs)
+                : holder_type(node_alloc_traits::select_on_container_copy_construction(lhs.get_alloc()))
         {
             copy_init(lhs.cbegin(), lhs.cend());
         }
 
-        list(list &&rhs) noexcept: node_(rhs.node_), size_(rhs.size_)
+        list(const list &lhs, const allocator_type &alloc) : holder_type(node_allocator(alloc))
         {
-            rhs.node_ = nullptr;
+            copy_init(lhs.cbegin(), lhs.cend());
+        }
+
+        list(list &&rhs) noexcept: holder_type(mystl::move(rhs.get_alloc())), size_(rhs.size_)
+        {
+            take_links(sentinel(), rhs.sentinel());
             rhs.size_ = 0;
         }
 
@@ -349,34 +388,56 @@ namespace mystl
         {
             if (this != &lhs)
             {
+                if (node_alloc_traits::propagate_on_container_copy_assignment::value &&
+                    !mystl::alloc_equal(get_alloc(), lhs.get_alloc()))
+                {
+                    // 节点需要由原来的分配器回收
+                    clear();
+                    mystl::alloc_on_copy(get_alloc(), lhs.get_alloc());
+                }
                 assign(lhs.begin(), lhs.end());
             }
             return *this;
         }
 
-        list &operator=(list &&rhs) noexcept
+        list &operator=(list &&rhs) noexcept(node_alloc_traits::propagate_on_container_move_assignment::value ||
+                                             node_alloc_traits::is_always_equal::value)
         {
+            if (this == &rhs)
+                return *this;
             clear();
-            splice(end(), rhs);
+            if (mystl::alloc_equal(get_alloc(), rhs.get_alloc()))
+            {
+                splice(end(), rhs);
+            }
+            else if (node_alloc_traits::propagate_on_container_move_assignment::value)
+            {
+                // 分配器不相等但需要传播，直接接管 rhs 的节点
+                mystl::alloc_on_move(get_alloc(), rhs.get_alloc());
+                take_links(sentinel(), rhs.sentinel());
+                size_ = rhs.size_;
+                rhs.size_ = 0;
+            }
+            else
+            {
+                // 分配器不相等，只能逐个移动元素
+                for (auto &value: rhs)
+                    emplace_back(mystl::move(value));
+                rhs.clear();
+            }
             return *this;
         }
 
         list &operator=(std::initializer_list<T> ilist)
         {
-            list tmp(ilist.begin(), ilist.end());
+            list tmp(ilist.begin(), ilist.end(), get_allocator());
             swap(tmp);
             return *this;
         }
 
         ~list()
         {
-            if (node_)
-            {
-                clear();
-                base_allocator::deallocate(node_);
-                node_ = nullptr;
-                size_ = 0;
-            }
+            clear();
         }
 
     public:
@@ -385,21 +446,21 @@ namespace mystl
         /// @brief 迭代器相关操作
         /// ------------------------------------------------------------------------------------------------------------
 
-        iterator begin() noexcept { return node_->next; }
+        iterator begin() noexcept { return iterator(sentinel()->next); }
 
-        const_iterator begin() const noexcept { return node_->next; }
+        const_iterator begin() const noexcept { return const_iterator(sentinel()->next); }
 
-        iterator end() noexcept { return node_; }
+        iterator end() noexcept { return iterator(sentinel()); }
 
-        const_iterator end() const noexcept { return node_; }
+        const_iterator end() const noexcept { return const_iterator(sentinel()); }
 
         reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
 
-        const_reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
 
         reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
 
-        const_reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
 
         const_iterator cbegin() const noexcept { return begin(); }
 
@@ -415,7 +476,7 @@ namespace mystl
 
         bool empty() const noexcept
         {
-            return node_->next == node_;
+            return sentinel()->next == sentinel();
         }
 
         size_type size() const noexcept
@@ -425,7 +486,7 @@ namespace mystl
 
         size_type max_size() const noexcept
         {
-            return static_cast<size_type>(-1);
+            return node_alloc_traits::max_size(get_alloc());
         }
 
         /// ------------------------------------------------------------------------------------------------------------
@@ -583,7 +644,7 @@ namespace mystl
         void pop_front()
         {
             MYSTL_DEBUG(!empty());
-            auto n = node_->next;
+            auto n = sentinel()->next;
             unlink_nodes(n, n);
             destroy_node(n->as_node());
             --size_;
@@ -592,7 +653,7 @@ namespace mystl
         void pop_back()
         {
             MYSTL_DEBUG(!empty());
-            auto n = node_->prev;
+            auto n = sentinel()->prev;
             unlink_nodes(n, n);
             destroy_node(n->as_node());
             --size_;
@@ -621,7 +682,13 @@ namespace mystl
 
         void swap(list &rhs) noexcept
         {
-            mystl::swap(node_, rhs.node_);
+            if (this == &rhs) return;
+            mystl::alloc_on_swap(get_alloc(), rhs.get_alloc());
+            // 首尾节点指向各自的哨兵，交换时需要借助一个临时哨兵改接
+            list_node_base<T> tmp;
+            take_links(&tmp, sentinel());
+            take_links(sentinel(), rhs.sentinel());
+            take_links(rhs.sentinel(), &tmp);
             mystl::swap(size_, rhs.size_);
         }
 
@@ -656,10 +723,16 @@ namespace mystl
         template<class Compare>
         void merge(list &x, Compare comp);
 
-        void sort() { list_sort(begin(), end(), size(), mystl::less<T>()); }
+        /// @brief 稳定排序，相等元素保持原来的相对顺序
+        void sort() { relink_sort(mystl::less<T>()); }
+
+        template<class Compared>
+        void sort(Compared comp) { relink_sort(comp); }
+
+        void sort(list_sort_mode mode) { sort(mystl::less<T>(), mode); }
 
         template<class Compared>
-        void sort(Compared comp) { list_sort(begin(), end(), size(), comp); }
+        void sort(Compared comp, list_sort_mode mode);
 
         void reverse();
 
@@ -677,6 +750,11 @@ namespace mystl
 
         void destroy_node(node_ptr p);
 
+        /// @brief 哨兵节点的地址；const 成员函数也要用它构造迭代器，所以返回非 const 指针
+        base_ptr sentinel() const noexcept { return const_cast<base_ptr>(&sentinel_); }
+
+        static void take_links(base_ptr to, base_ptr from) noexcept;
+
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
         /// @brief 初始化/回收函数
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -698,6 +776,8 @@ namespace mystl
 
         void link_nodes_at_back(base_ptr first, base_ptr last);
 
+        void unlink_nodes(base_ptr first, base_ptr last);
+
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
         /// @brief assign
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -719,8 +799,23 @@ namespace mystl
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
         /// @brief sort
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief 平凡可复制且不超过两个指针大小的元素，buffered 模式下把值一起复制到缓冲区
+        typedef std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                             sizeof(T) <= 2 * sizeof(void *)> copy_values_for_sort;
+
         template<class Compared>
-        iterator list_sort(iterator first, iterator last, size_type n, Compared comp);
+        void relink_sort(Compared comp);
+
+        template<class Compared>
+        bool buffered_sort(Compared comp, std::false_type);
+
+        template<class Compared>
+        bool buffered_sort(Compared comp, std::true_type);
+
+        template<class Compared>
+        static void merge_chains(base_ptr &a, base_ptr b, Compared &comp);
+
+        void relink_chain(base_ptr first) noexcept;
 
     };
 
@@ -730,8 +825,8 @@ namespace mystl
 
     /// @brief erase
 
-    template<typename T>
-    typename list<T>::iterator list<T>::erase(const_iterator pos)
+    template<typename T, typename Alloc>
+    typename list<T, Alloc>::iterator list<T, Alloc>::erase(const_iterator pos)
     {
         MYSTL_DEBUG(pos != cend());
         auto n = pos.node_;
@@ -742,8 +837,8 @@ namespace mystl
         return iterator(next);
     }
 
-    template<typename T>
-    typename list<T>::iterator list<T>::erase(const_iterator first, const_iterator last)
+    template<typename T, typename Alloc>
+    typename list<T, Alloc>::iterator list<T, Alloc>::erase(const_iterator first, const_iterator last)
     {
         if (first != last)
         {
@@ -762,25 +857,25 @@ namespace mystl
 
     /// @brief clear, 用于清空链表
 
-    template<typename T>
-    void list<T>::clear()
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::clear()
     {
         if (size_ != 0)
         {
-            auto cur = node_->next;
-            for (base_ptr next = cur->next; cur != node_; cur = next, next = cur->next)
+            auto cur = sentinel()->next;
+            for (base_ptr next = cur->next; cur != sentinel(); cur = next, next = cur->next)
             {
                 destroy_node(cur->as_node());
             }
-            node_->unlink();
+            sentinel()->unlink();
             size_ = 0;
         }
     }
 
     /// @brief resize
 
-    template<typename T>
-    void list<T>::resize(size_type new_size, const value_type &value)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::resize(size_type new_size, const value_type &value)
     {
         auto i = begin();
         size_type len = 0;
@@ -791,11 +886,11 @@ namespace mystl
         }
         if (len == new_size)
         {
-            erase(i, node_);
+            erase(i, end());
         }
         else
         {
-            insert(node_, new_size - len, value);
+            insert(end(), new_size - len, value);
         }
     }
 
@@ -803,16 +898,16 @@ namespace mystl
     /// @brief list相关操作
     /// ================================================================================================================
 
-    template<typename T>
-    void list<T>::splice(const_iterator pos, list &x)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list &x)
     {
         MYSTL_DEBUG(this != &x);
         if (!x.empty())
         {
             THROW_LENGTH_ERROR_IF(size_ > max_size() - x.size_, "list<T>'s size too big");
 
-            auto f = x.node_->next;
-            auto l = x.node_->prev;
+            auto f = x.sentinel()->next;
+            auto l = x.sentinel()->prev;
 
             x.unlink_nodes(f, l);
             link_nodes(pos.node_, f, l);
@@ -822,8 +917,8 @@ namespace mystl
         }
     }
 
-    template<typename T>
-    void list<T>::splice(const_iterator pos, list &x, const_iterator it)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list &x, const_iterator it)
     {
         if (pos.node_ != it.node_ && pos.node_ != it.node_->next)
         {
@@ -839,8 +934,8 @@ namespace mystl
         }
     }
 
-    template<typename T>
-    void list<T>::splice(const_iterator pos, list &x, const_iterator first, const_iterator last)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list &x, const_iterator first, const_iterator last)
     {
         if (first != last && this != &x)
         {
@@ -857,9 +952,9 @@ namespace mystl
         }
     }
 
-    template<typename T>
+    template<typename T, typename Alloc>
     template<typename UnaryPredicate>
-    void list<T>::remove_if(UnaryPredicate pred)
+    void list<T, Alloc>::remove_if(UnaryPredicate pred)
     {
         auto f = begin();
         auto l = end();
@@ -873,9 +968,9 @@ namespace mystl
         }
     }
 
-    template<typename T>
+    template<typename T, typename Alloc>
     template<typename BinaryPredicate>
-    void list<T>::unique(BinaryPredicate pred)
+    void list<T, Alloc>::unique(BinaryPredicate pred)
     {
         auto i = begin();
         auto e = end();
@@ -896,9 +991,9 @@ namespace mystl
         }
     }
 
-    template<typename T>
+    template<typename T, typename Alloc>
     template<typename Compare>
-    void list<T>::merge(list &x, Compare comp)
+    void list<T, Alloc>::merge(list &x, Compare comp)
     {
         if (this != &x)
         {
@@ -945,8 +1040,8 @@ namespace mystl
         }
     }
 
-    template<typename T>
-    void list<T>::reverse()
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::reverse()
     {
         if (size_ <= 1)
         {
@@ -968,20 +1063,20 @@ namespace mystl
 
     /// @brief creator_node
 
-    template<typename T>
+    template<typename T, typename Alloc>
     template<typename ...Args>
-    typename list<T>::node_ptr list<T>::create_node(Args &&...args)
+    typename list<T, Alloc>::node_ptr list<T, Alloc>::create_node(Args &&...args)
     {
-        node_ptr p = node_allocator::allocate(1);
+        node_ptr p = node_alloc_traits::allocate(get_alloc(), 1);
         try
         {
-            data_allocator::construct(mystl::address_of(p->value), mystl::forward<Args>(args)...);
+            node_alloc_traits::construct(get_alloc(), mystl::address_of(p->value), mystl::forward<Args>(args)...);
             p->prev = nullptr;
             p->next = nullptr;
         }
         catch (...)
         {
-            node_allocator::deallocate(p);
+            node_alloc_traits::deallocate(get_alloc(), p, 1);
             throw;
         }
         return p;
@@ -989,20 +1084,36 @@ namespace mystl
 
     /// @brief destroy_node
 
-    template<typename T>
-    void list<T>::destroy_node(node_ptr p)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::destroy_node(node_ptr p)
     {
-        data_allocator::destroy(mystl::address_of(p->value));
-        node_allocator::deallocate(p);
+        node_alloc_traits::destroy(get_alloc(), mystl::address_of(p->value));
+        node_alloc_traits::deallocate(get_alloc(), p, 1);
+    }
+
+    /// @brief take_links 把 from 哨兵上的整条链表改接到 to 上，from 变为空链表
+
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::take_links(base_ptr to, base_ptr from) noexcept
+    {
+        if (from->next == from)
+        {
+            to->unlink();
+            return;
+        }
+        to->next = from->next;
+        to->prev = from->prev;
+        to->next->prev = to;
+        to->prev->next = to;
+        from->unlink();
     }
 
     /// @brief fill init
 
-    template<typename T>
-    void list<T>::fill_init(size_type n, const value_type &value)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::fill_init(size_type n, const value_type &value)
     {
-        node_ = base_allocator::allocate(1);
-        node_->unlink();
+        sentinel_.unlink();
         size_ = n;
         try
         {
@@ -1015,20 +1126,17 @@ namespace mystl
         catch (...)
         {
             clear();
-            base_allocator::deallocate(node_);
-            node_ = nullptr;
             throw;
         }
     }
 
     /// @brief copy init
 
-    template<typename T>
+    template<typename T, typename Alloc>
     template<typename Iter>
-    void list<T>::copy_init(Iter first, Iter last)
+    void list<T, Alloc>::copy_init(Iter first, Iter last)
     {
-        node_ = base_allocator::allocate(1);
-        node_->unlink();
+        sentinel_.unlink();
         size_type n = mystl::distance(first, last);
         size_ = n;
         try
@@ -1042,22 +1150,20 @@ namespace mystl
         catch (...)
         {
             clear();
-            base_allocator::deallocate(node_);
-            node_ = nullptr;
             throw;
         }
     }
 
     /// @brief link_iter_node
 
-    template<typename T>
-    typename list<T>::iterator list<T>::link_iter_node(const_iterator pos, base_ptr link_node)
+    template<typename T, typename Alloc>
+    typename list<T, Alloc>::iterator list<T, Alloc>::link_iter_node(const_iterator pos, base_ptr link_node)
     {
-        if (pos == node_->next)
+        if (pos.node_ == sentinel()->next)
         {
             link_nodes_at_front(link_node, link_node);
         }
-        else if (pos == node_)
+        else if (pos.node_ == sentinel())
         {
             link_nodes_at_back(link_node, link_node);
         }
@@ -1070,41 +1176,50 @@ namespace mystl
 
     /// @brief link_nodes
 
-    template<typename T>
-    void list<T>::link_nodes(base_ptr pos, base_ptr first, base_ptr last)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::link_nodes(base_ptr pos, base_ptr first, base_ptr last)
     {
         pos->prev->next = first;
-        first->prev = pos->pre;
+        first->prev = pos->prev;
         pos->prev = last;
         last->next = pos;
     }
 
     /// @brief link_node_at_front
 
-    template<typename T>
-    void list<T>::link_nodes_at_front(base_ptr first, base_ptr last)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::link_nodes_at_front(base_ptr first, base_ptr last)
     {
-        first->prev = node_;
-        last->next = node_->next;
-        node_->next->prev = last;
-        node_->next = first;
+        first->prev = sentinel();
+        last->next = sentinel()->next;
+        sentinel()->next->prev = last;
+        sentinel()->next = first;
     }
 
     /// @brief link_node_at_back，将一段插入节点到末尾， node_prev是最后一个有效节点
 
-    template<typename T>
-    void list<T>::link_nodes_at_back(base_ptr first, base_ptr last)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::link_nodes_at_back(base_ptr first, base_ptr last)
     {
-        last->next = node_;
-        first->prev = node_->prev;
+        last->next = sentinel();
+        first->prev = sentinel()->prev;
         first->prev->next = first;
-        node_->prev = last;
+        sentinel()->prev = last;
+    }
+
+    /// @brief unlink_nodes，将 [first, last] 之间的节点从链表中断开
+
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::unlink_nodes(base_ptr first, base_ptr last)
+    {
+        first->prev->next = last->next;
+        last->next->prev = first->prev;
     }
 
     /// @brief fill_assign，用n个value为容器赋值
 
-    template<typename T>
-    void list<T>::fill_assign(size_type n, const value_type &value)
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::fill_assign(size_type n, const value_type &value)
     {
         auto b = begin();
         auto e = end();
@@ -1124,9 +1239,9 @@ namespace mystl
 
     /// @brief copy_assign
 
-    template<typename T>
+    template<typename T, typename Alloc>
     template<typename Iter>
-    void list<T>::copy_assign(Iter f2, Iter l2)
+    void list<T, Alloc>::copy_assign(Iter f2, Iter l2)
     {
         auto f1 = begin();
         auto l1 = end();
@@ -1144,8 +1259,8 @@ namespace mystl
         }
     }
 
-    template<typename T>
-    typename list<T>::iterator list<T>::fill_insert(const_iterator pos, size_type n, const value_type &value)
+    template<typename T, typename Alloc>
+    typename list<T, Alloc>::iterator list<T, Alloc>::fill_insert(const_iterator pos, size_type n, const value_type &value)
     {
         iterator r(pos.node_);
         if (n != 0)
@@ -1184,9 +1299,9 @@ namespace mystl
         return r;
     }
 
-    template<typename T>
+    template<typename T, typename Alloc>
     template<typename Iter>
-    typename list<T>::iterator list<T>::copy_insert(const_iterator pos, size_type n, Iter first)
+    typename list<T, Alloc>::iterator list<T, Alloc>::copy_insert(const_iterator pos, size_type n, Iter first)
     {
         iterator r(pos.node_);
         if (n != 0)
@@ -1224,85 +1339,219 @@ namespace mystl
         return r;
     }
 
-    template<typename T>
+    /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    /// @brief sort
+    /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    template<typename T, typename Alloc>
     template<typename Compared>
-    typename list<T>::iterator list<T>::list_sort(iterator f1, iterator l2, size_type n, Compared comp)
+    void list<T, Alloc>::sort(Compared comp, list_sort_mode mode)
     {
-        if (n < 2)
-            return f1;
+        if (size_ < 2)
+            return;
+        if (mode == list_sort_mode::buffered && buffered_sort(comp, copy_values_for_sort()))
+            return;
+        relink_sort(comp);
+    }
 
-        if (n == 2)
+    /**
+     * @brief 合并两条以 nullptr 结尾、按 next 链接的有序链，结果存入 a；相等时 a 中的节点在前
+     * @note comp 抛出异常时 a 仍然包含两条链的全部节点(顺序未定义)，然后重新抛出
+     * */
+    template<typename T, typename Alloc>
+    template<typename Compared>
+    void list<T, Alloc>::merge_chains(base_ptr &a, base_ptr b, Compared &comp)
+    {
+        list_node_base<T> head;
+        base_ptr tail = &head;
+        base_ptr x = a;
+        try
         {
-            if (comp(*--l2, *f1))
+            while (x != nullptr && b != nullptr)
             {
-                auto ln = l2.node_;
-                unlink_nodes(ln, ln);
-                link_nodes(f1.node_, ln, ln);
-                return l2;
+                if (comp(b->as_node()->value, x->as_node()->value))
+                {
+                    tail->next = b;
+                    b = b->next;
+                }
+                else
+                {
+                    tail->next = x;
+                    x = x->next;
+                }
+                tail = tail->next;
             }
-            return f1;
-        }
-
-        auto n2 = n / 2;
-        auto l1 = f1;
-        mystl::advance(l1, n2);
-        auto result = f1 = list_sort(f1, l1, n2, comp);  // 前半段的最小位置
-        auto f2 = l1 = list_sort(l1, l2, n - n2, comp);  // 后半段的最小位置
-
-        // 把较小的一段区间移到前面
-        if (comp(*f2, *f1))
-        {
-            auto m = f2;
-            ++m;
-            for (; m != l2 && comp(*m, *f1); ++m);
-            auto f = f2.node_;
-            auto l = m.node_->prev;
-            result = f2;
-            l1 = f2 = m;
-            unlink_nodes(f, l);
-            m = f1;
-            ++m;
-            link_nodes(f1.node_, f, l);
-            f1 = m;
         }
-        else
+        catch (...)
         {
-            ++f1;
+            tail->next = x;
+            while (tail->next != nullptr)
+                tail = tail->next;
+            tail->next = b;
+            a = head.next;
+            throw;
+        }
+        tail->next = x != nullptr ? x : b;
+        a = head.next;
+    }
+
+    /// @brief 按 next 顺序把以 nullptr 结尾的链接回哨兵节点，并重建 prev 指针
+    template<typename T, typename Alloc>
+    void list<T, Alloc>::relink_chain(base_ptr first) noexcept
+    {
+        base_ptr prev = sentinel();
+        for (base_ptr cur = first; cur != nullptr; cur = cur->next)
+        {
+            prev->next = cur;
+            cur->prev = prev;
+            prev = cur;
         }
+        prev->next = sentinel();
+        sentinel()->prev = prev;
+    }
+
+    /**
+     * @brief 自底向上的归并排序：节点逐个取下，bins[i] 为空或保存一条长度为 2^i 的有序链，
+     * @brief 新节点像二进制加一那样与各级 bin 逐级合并进位；最后从低到高把所有 bin 合并起来
+     * @note 排序期间只维护 next 指针，结束后一次遍历重建 prev；不需要查找中点，也没有递归
+     * @note comp 抛出异常时所有节点都会重新链接回链表，顺序未定义
+     * */
+    template<typename T, typename Alloc>
+    template<typename Compared>
+    void list<T, Alloc>::relink_sort(Compared comp)
+    {
+        if (size_ < 2)
+            return;
 
-        // 合并两段有序区间
-        while (f1 != l1 && f2 != l2)
+        base_ptr bins[sizeof(size_type) * 8] = {};
+        size_t used = 0;          // bins[used] 及以后都为空
+        base_ptr carry = nullptr;
+        base_ptr rest = sentinel()->next;
+        sentinel()->prev->next = nullptr;
+        try
         {
-            if (comp(*f2, *f1))
+            while (rest != nullptr)
             {
-                auto m = f2;
-                ++m;
-                for (; m != l2 && comp(*m, *f1); ++m);
-                auto f = f2.node_;
-                auto l = m.node_->prev;
-                if (l1 == f2)
-                    l1 = m;
-                f2 = m;
-                unlink_nodes(f, l);
-                m = f1;
-                ++m;
-                link_nodes(f1.node_, f, l);
-                f1 = m;
+                carry = rest;
+                rest = rest->next;
+                carry->next = nullptr;
+                size_t i = 0;
+                for (; bins[i] != nullptr; ++i)
+                {
+                    // bins[i] 中的节点都在 carry 之前，作为第一个参数以保持稳定
+                    base_ptr b = carry;
+                    carry = nullptr;
+                    merge_chains(bins[i], b, comp);
+                    carry = bins[i];
+                    bins[i] = nullptr;
+                }
+                bins[i] = carry;
+                carry = nullptr;
+                if (i >= used)
+                    used = i + 1;
             }
-            else
+            for (size_t i = 1; i < used; ++i)
             {
-                ++f1;
+                // 低位的 bin 中是较晚取下的节点
+                base_ptr later = bins[i - 1];
+                bins[i - 1] = nullptr;
+                if (bins[i] == nullptr)
+                    bins[i] = later;
+                else if (later != nullptr)
+                    merge_chains(bins[i], later, comp);
             }
         }
-        return result;
+        catch (...)
+        {
+            // 把散落在各处的链首尾相接，全部节点重新挂回链表
+            base_ptr first = rest;
+            for (size_t i = 0; i <= used && i < sizeof(size_type) * 8; ++i)
+            {
+                base_ptr chain = i < used ? bins[i] : carry;
+                if (chain == nullptr)
+                    continue;
+                base_ptr last = chain;
+                while (last->next != nullptr)
+                    last = last->next;
+                last->next = first;
+                first = chain;
+            }
+            relink_chain(first);
+            throw;
+        }
+        relink_chain(bins[used - 1]);
+    }
+
+    /// @brief 收集节点指针，在指针数组上 stable_sort，链表本身直到最后才修改，comp 抛出异常时链表不变
+    template<typename T, typename Alloc>
+    template<typename Compared>
+    bool list<T, Alloc>::buffered_sort(Compared comp, std::false_type)
+    {
+        mystl::temporary_buffer<base_ptr> buffer(size_);
+        if (buffer.size() < size_)
+            return false;
+        base_ptr *const nodes = buffer.data();
+        size_type i = 0;
+        for (base_ptr cur = sentinel()->next; cur != sentinel(); cur = cur->next)
+            nodes[i++] = cur;
+        mystl::stable_sort(nodes, nodes + size_, [&comp](base_ptr a, base_ptr b)
+        {
+            return comp(a->as_node()->value, b->as_node()->value);
+        });
+        base_ptr prev = sentinel();
+        for (i = 0; i < size_; ++i)
+        {
+            prev->next = nodes[i];
+            nodes[i]->prev = prev;
+            prev = nodes[i];
+        }
+        prev->next = sentinel();
+        sentinel()->prev = prev;
+        return true;
+    }
+
+    /// @brief 值与节点指针一起放入缓冲区，排序时的比较只访问连续内存，不再解引用节点
+    template<typename T, typename Alloc>
+    template<typename Compared>
+    bool list<T, Alloc>::buffered_sort(Compared comp, std::true_type)
+    {
+        struct entry
+        {
+            T value;
+            base_ptr node;
+        };
+        mystl::temporary_buffer<entry> buffer(size_);
+        if (buffer.size() < size_)
+            return false;
+        entry *const entries = buffer.data();
+        size_type i = 0;
+        for (base_ptr cur = sentinel()->next; cur != sentinel(); cur = cur->next, ++i)
+        {
+            mystl::construct(&entries[i].value, cur->as_node()->value);
+            entries[i].node = cur;
+        }
+        mystl::stable_sort(entries, entries + size_, [&comp](const entry &a, const entry &b)
+        {
+            return comp(a.value, b.value);
+        });
+        base_ptr prev = sentinel();
+        for (i = 0; i < size_; ++i)
+        {
+            prev->next = entries[i].node;
+            entries[i].node->prev = prev;
+            prev = entries[i].node;
+        }
+        prev->next = sentinel();
+        sentinel()->prev = prev;
+        return true;
     }
 
     /// ================================================================================================================
     /// @brief 重载操作符
     /// ================================================================================================================
 
-    template<typename T>
-    bool operator==(const list<T> &lhs, const list<T> &rhs)
+    template<typename T, typename Alloc>
+    bool operator==(const list<T, Alloc> &lhs, const list<T, Alloc> &rhs)
     {
         auto f1 = lhs.cbegin();
         auto f2 = rhs.cbegin();
@@ -1312,41 +1561,48 @@ namespace mystl
         return f1 == l1 && f2 == l2;
     }
 
-    template<typename T>
-    bool operator<(const list<T> &lhs, const list<T> &rhs)
+    template<typename T, typename Alloc>
+    bool operator<(const list<T, Alloc> &lhs, const list<T, Alloc> &rhs)
     {
         return mystl::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
     }
 
-    template<typename T>
-    bool operator!=(const list<T> &lhs, const list<T> &rhs)
+    template<typename T, typename Alloc>
+    bool operator!=(const list<T, Alloc> &lhs, const list<T, Alloc> &rhs)
     {
         return !(lhs == rhs);
     }
 
-    template<typename T>
-    bool operator>(const list<T> &lhs, const list<T> &rhs)
+    template<typename T, typename Alloc>
+    bool operator>(const list<T, Alloc> &lhs, const list<T, Alloc> &rhs)
     {
         return rhs < lhs;
     }
 
-    template<typename T>
-    bool operator<=(const list<T> &lhs, const list<T> &rhs)
+    template<typename T, typename Alloc>
+    bool operator<=(const list<T, Alloc> &lhs, const list<T, Alloc> &rhs)
     {
         return !(rhs < lhs);
     }
 
-    template<typename T>
-    bool operator>=(const list<T> &lhs, const list<T> &rhs)
+    template<typename T, typename Alloc>
+    bool operator>=(const list<T, Alloc> &lhs, const list<T, Alloc> &rhs)
     {
         return !(lhs < rhs);
     }
 
-    template<typename T>
-    void swap(list<T> &lhs, list<T> &rhs) noexcept
+    template<typename T, typename Alloc>
+    void swap(list<T, Alloc> &lhs, list<T, Alloc> &rhs) noexcept
     {
         lhs.swap(rhs);
     }
+
+    /// ================================================================================================================
+    /// @brief pooled_list 节点从 pool_allocator 的内存池中分配
+    /// ================================================================================================================
+
+    template<typename T>
+    using pooled_list = mystl::list<T, mystl::pool_allocator<T>>;
 }
 
 #endif //MYSTL_LIST_H
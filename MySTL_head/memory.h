@@ -34,6 +34,55 @@ namespace mystl
         return &value;
     }
 
+    /// ================================================================================================================
+    /// @brief temporary_buffer
+    /// ================================================================================================================
+
+    /**
+     * @brief 算法内部使用的临时缓冲区：尽量申请 requested 个元素的未初始化内存，失败时减半重试，最终可能为空
+     * @note 只管理内存，元素的构造与析构由使用者负责；析构时归还内存
+     * */
+
+    template<typename T>
+    class temporary_buffer
+    {
+    private:
+        T *data_;
+        size_t size_;
+
+    public:
+        explicit temporary_buffer(size_t requested) noexcept: data_(nullptr), size_(0)
+        {
+            while (requested > 0)
+            {
+                try
+                {
+                    const auto result = mystl::allocator<T>::allocate_at_least(requested);
+                    data_ = result.ptr;
+                    size_ = result.count;
+                    return;
+                }
+                catch (...)
+                {
+                    requested /= 2;
+                }
+            }
+        }
+
+        temporary_buffer(const temporary_buffer &) = delete;
+
+        temporary_buffer &operator=(const temporary_buffer &) = delete;
+
+        ~temporary_buffer()
+        {
+            mystl::allocator<T>::deallocate(data_, size_);
+        }
+
+        T *data() const noexcept { return data_; }
+
+        /// @brief 实际得到的元素个数，可能小于请求的个数
+        size_t size() const noexcept { return size_; }
+    };
 }
 
 #endif //MYSTL_MEMORY_H
@@ -0,0 +1,283 @@
+/**
+ * @file memory_resource.h
+ * @brief 实现单调递增的内存资源monotonic_buffer_resource(bump pointer)以及对应的分配器arena_allocator
+ */
+
+#ifndef MYSTL_MEMORY_RESOURCE_H
+#define MYSTL_MEMORY_RESOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include "construct.h"
+#include "exceptdef.h"
+#include "util.h"
+
+namespace mystl
+{
+    /// ================================================================================================================
+    /// @brief monotonic_buffer_resource
+    /// ================================================================================================================
+
+    /**
+     * @brief 从一串大块内存中顺序切分空间，deallocate 不做任何事，release 或析构时一次性归还全部内存
+     * @note 适合生命周期一致的一批短期对象(例如一次请求中创建的容器)，避免逐个调用 operator new/delete
+     * @note 非线程安全，也不可拷贝
+     * */
+
+    class monotonic_buffer_resource
+    {
+    private:
+        /// @brief 每个从上游分配的块头部保存链表指针和块大小
+        struct block_header
+        {
+            block_header *next;
+            size_t size;
+        };
+
+        enum : size_t
+        {
+            default_block_size = 4096,
+            max_align = alignof(std::max_align_t)
+        };
+
+        block_header *blocks_;     // 已分配块组成的链表
+        char *cur_;                // 当前块中下一个可用字节
+        char *end_;                // 当前块的尾部
+        size_t next_block_size_;   // 下一次向上游申请的块大小
+
+        char *initial_buffer_;     // 用户提供的初始缓冲区(不归本类释放)
+        size_t initial_size_;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造/析构函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        monotonic_buffer_resource() noexcept
+                : blocks_(nullptr), cur_(nullptr), end_(nullptr), next_block_size_(default_block_size),
+                  initial_buffer_(nullptr), initial_size_(0) {}
+
+        /// @param[in] initial_size 第一次向上游申请的块大小
+        explicit monotonic_buffer_resource(size_t initial_size) noexcept
+                : blocks_(nullptr), cur_(nullptr), end_(nullptr),
+                  next_block_size_(initial_size < sizeof(block_header) ? size_t(default_block_size) : initial_size),
+                  initial_buffer_(nullptr), initial_size_(0) {}
+
+        /// @param[in] buffer 先使用调用者提供的缓冲区(例如栈上的数组)，用完后再向上游申请
+        monotonic_buffer_resource(void *buffer, size_t size) noexcept
+                : blocks_(nullptr), cur_(static_cast<char *>(buffer)), end_(static_cast<char *>(buffer) + size),
+                  next_block_size_(size < default_block_size ? size_t(default_block_size) : size * 2),
+                  initial_buffer_(static_cast<char *>(buffer)), initial_size_(size) {}
+
+        monotonic_buffer_resource(const monotonic_buffer_resource &) = delete;
+
+        monotonic_buffer_resource &operator=(const monotonic_buffer_resource &) = delete;
+
+        ~monotonic_buffer_resource()
+        {
+            release();
+        }
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief allocate / deallocate / release
+        /// ------------------------------------------------------------------------------------------------------------
+
+        void *allocate(size_t bytes, size_t alignment = max_align);
+
+        /// @brief 单调资源不回收单个分配
+        void deallocate(void *, size_t, size_t = max_align) noexcept {}
+
+        bool expand(void *ptr, size_t old_bytes, size_t new_bytes) noexcept;
+
+        void release() noexcept;
+
+        /// @brief 两个资源只有是同一个对象时才相等
+        bool is_equal(const monotonic_buffer_resource &other) const noexcept
+        {
+            return this == &other;
+        }
+
+    private:
+        void new_block(size_t bytes, size_t alignment);
+
+        static char *align_up(char *ptr, size_t alignment) noexcept
+        {
+            const auto p = reinterpret_cast<std::uintptr_t>(ptr);
+            return reinterpret_cast<char *>((p + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1));
+        }
+    };
+
+    /**
+     * @brief 在当前块中对齐后切分 bytes 字节，不够时向上游申请新的块
+     * @param[in] bytes 需要的字节数
+     * @param[in] alignment 对齐要求，必须是 2 的幂
+     * */
+
+    inline void *monotonic_buffer_resource::allocate(size_t bytes, size_t alignment)
+    {
+        MYSTL_DEBUG(alignment != 0 && (alignment & (alignment - 1)) == 0);
+        if (bytes == 0) bytes = 1;
+        char *p = cur_ == nullptr ? nullptr : align_up(cur_, alignment);
+        if (p == nullptr || p > end_ || static_cast<size_t>(end_ - p) < bytes)
+        {
+            new_block(bytes, alignment);
+            p = align_up(cur_, alignment);
+        }
+        cur_ = p + bytes;
+        return p;
+    }
+
+    /**
+     * @brief 如果 ptr 是最近一次分配且当前块剩余空间足够，直接把它原地扩展到 new_bytes 字节
+     * @return 是否扩展成功，失败时不做任何修改
+     * */
+
+    inline bool monotonic_buffer_resource::expand(void *ptr, size_t old_bytes, size_t new_bytes) noexcept
+    {
+        char *p = static_cast<char *>(ptr);
+        if (p == nullptr || p + old_bytes != cur_ || new_bytes < old_bytes)
+            return false;
+        if (static_cast<size_t>(end_ - p) < new_bytes)
+            return false;
+        cur_ = p + new_bytes;
+        return true;
+    }
+
+    /// @brief 归还所有从上游申请的块，之后可以继续使用(重新从初始缓冲区开始)
+    inline void monotonic_buffer_resource::release() noexcept
+    {
+        while (blocks_ != nullptr)
+        {
+            block_header *next = blocks_->next;
+            ::operator delete(static_cast<void *>(blocks_));
+            blocks_ = next;
+        }
+        cur_ = initial_buffer_;
+        end_ = initial_buffer_ == nullptr ? nullptr : initial_buffer_ + initial_size_;
+    }
+
+    /// @brief 申请一个至少能容纳 bytes 字节(含对齐余量)的新块，块大小按 2 倍增长
+    inline void monotonic_buffer_resource::new_block(size_t bytes, size_t alignment)
+    {
+        const size_t need = sizeof(block_header) + bytes + alignment;
+        THROW_LENGTH_ERROR_IF(need < bytes, "monotonic_buffer_resource::allocate size too big");
+        size_t size = next_block_size_;
+        while (size < need) size *= 2;
+        auto block = static_cast<block_header *>(::operator new(size));
+        block->next = blocks_;
+        block->size = size;
+        blocks_ = block;
+        cur_ = reinterpret_cast<char *>(block) + sizeof(block_header);
+        end_ = reinterpret_cast<char *>(block) + size;
+        next_block_size_ = size * 2;
+    }
+
+    /// ================================================================================================================
+    /// @brief arena_allocator
+    /// ================================================================================================================
+
+    /**
+     * @brief 从 monotonic_buffer_resource 分配内存的有状态分配器，可以作为 vector / list / deque 的 Alloc 参数
+     * @note 容器拷贝赋值/移动赋值/交换时不传播分配器，保证元素始终来自容器构造时指定的资源
+     * */
+
+    template<typename T>
+    class arena_allocator
+    {
+    public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef const T *const_pointer;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        typedef std::false_type propagate_on_container_copy_assignment;
+        typedef std::false_type propagate_on_container_move_assignment;
+        typedef std::false_type propagate_on_container_swap;
+        typedef std::false_type is_always_equal;
+
+        template<typename U>
+        struct rebind
+        {
+            typedef arena_allocator<U> other;
+        };
+
+    private:
+        template<typename U>
+        friend class arena_allocator;
+
+        monotonic_buffer_resource *resource_;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        arena_allocator(monotonic_buffer_resource *resource) noexcept: resource_(resource)
+        {
+            MYSTL_DEBUG(resource != nullptr);
+        }
+
+        arena_allocator(const arena_allocator &) noexcept = default;
+
+        template<typename U>
+        arena_allocator(const arena_allocator<U> &other) noexcept: resource_(other.resource_) {}
+
+        arena_allocator &operator=(const arena_allocator &) = default;
+
+        monotonic_buffer_resource *resource() const noexcept { return resource_; }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief allocate / deallocate
+        /// ------------------------------------------------------------------------------------------------------------
+
+        T *allocate(size_type n)
+        {
+            THROW_LENGTH_ERROR_IF(n > max_size(), "arena_allocator<T>::allocate size too big");
+            return static_cast<T *>(resource_->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *ptr, size_type n) noexcept
+        {
+            resource_->deallocate(ptr, n * sizeof(T), alignof(T));
+        }
+
+        /// @brief 最后一次分配的块可以在资源的当前块内原地扩展
+        bool expand(T *ptr, size_type old_n, size_type new_n) noexcept
+        {
+            return resource_->expand(ptr, old_n * sizeof(T), new_n * sizeof(T));
+        }
+
+        size_type max_size() const noexcept
+        {
+            return static_cast<size_type>(-1) / sizeof(T);
+        }
+
+        /// @brief 拷贝构造容器时沿用同一个资源
+        arena_allocator select_on_container_copy_construction() const noexcept
+        {
+            return *this;
+        }
+    };
+
+    template<typename T1, typename T2>
+    bool operator==(const arena_allocator<T1> &lhs, const arena_allocator<T2> &rhs) noexcept
+    {
+        return lhs.resource() == rhs.resource();
+    }
+
+    template<typename T1, typename T2>
+    bool operator!=(const arena_allocator<T1> &lhs, const arena_allocator<T2> &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+}
+
+#endif //MYSTL_MEMORY_RESOURCE_H
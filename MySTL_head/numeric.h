@@ -0,0 +1,66 @@
+/**
+ * @file numeric.h
+ * @brief 数值算法：accumulate、reduce
+ */
+
+#ifndef MYSTL_NUMERIC_H
+#define MYSTL_NUMERIC_H
+
+#include "iterator.h"
+#include "functional.h"
+#include "util.h"
+
+namespace mystl
+{
+    /// ================================================================================================================
+    /// @brief accumulate
+    /// ================================================================================================================
+
+    /// @brief 从 init 开始按顺序依次累加 [first, last) 中的元素
+    template<typename InputIter, typename T>
+    T accumulate(InputIter first, InputIter last, T init)
+    {
+        for (; first != last; ++first)
+            init = mystl::move(init) + *first;
+        return init;
+    }
+
+    /// @brief 按顺序计算 op(...op(op(init, *first), *(first + 1))..., *(last - 1))
+    template<typename InputIter, typename T, typename BinaryOperation>
+    T accumulate(InputIter first, InputIter last, T init, BinaryOperation op)
+    {
+        for (; first != last; ++first)
+            init = op(mystl::move(init), *first);
+        return init;
+    }
+
+    /// ================================================================================================================
+    /// @brief reduce
+    /// ================================================================================================================
+
+    /**
+     * @brief 与 accumulate 相同，但不保证求值顺序：op 必须满足结合律和交换律
+     * @note 顺序版本按 accumulate 的顺序计算；带执行策略的版本(见 execution.h)分块并行计算后再合并
+     * */
+
+    template<typename InputIter, typename T, typename BinaryOperation>
+    T reduce(InputIter first, InputIter last, T init, BinaryOperation op)
+    {
+        return mystl::accumulate(first, last, mystl::move(init), op);
+    }
+
+    template<typename InputIter, typename T>
+    T reduce(InputIter first, InputIter last, T init)
+    {
+        return mystl::accumulate(first, last, mystl::move(init), mystl::plus<T>());
+    }
+
+    template<typename InputIter>
+    typename iterator_traits<InputIter>::value_type reduce(InputIter first, InputIter last)
+    {
+        typedef typename iterator_traits<InputIter>::value_type T;
+        return mystl::reduce(first, last, T());
+    }
+}
+
+#endif //MYSTL_NUMERIC_H
@@ -0,0 +1,335 @@
+/**
+ * @file pool_allocator.h
+ * @brief 实现按尺寸分级的内存池以及对应的分配器pool_allocator，主要用于 list 等基于节点的容器
+ */
+
+#ifndef MYSTL_POOL_ALLOCATOR_H
+#define MYSTL_POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#include "allocator.h"
+#include "construct.h"
+#include "exceptdef.h"
+#include "util.h"
+
+namespace mystl
+{
+    /// ================================================================================================================
+    /// @brief 内存池实现细节
+    /// ================================================================================================================
+
+    /**
+     * @brief 两级结构：每个线程有自己的缓存(无锁)，缓存为空或过满时与全局的中心池批量交换空闲块
+     * @note 中心池以 slab(大块)为单位向 operator new 申请内存，再切分成同一尺寸级别的小块
+     * @note slab 在程序运行期间不归还给系统(和 SGI STL 的二级配置器相同)，空闲块会被后续分配重复使用
+     * */
+
+    namespace pool_detail
+    {
+        /// @brief 尺寸级别的粒度，同时也是池中块的对齐保证
+        constexpr size_t pool_align = alignof(std::max_align_t) < 16 ? 16 : alignof(std::max_align_t);
+        /// @brief 超过该大小的请求直接交给 operator new
+        constexpr size_t pool_max_bytes = 512;
+        constexpr size_t pool_class_count = pool_max_bytes / pool_align;
+        /// @brief 每个 slab 的大小
+        constexpr size_t pool_slab_bytes = 64 * 1024;
+
+        /// @brief 空闲块复用自身的空间作为链表指针
+        struct free_block
+        {
+            free_block *next;
+        };
+
+        constexpr size_t class_index(size_t bytes) noexcept
+        {
+            return (bytes + pool_align - 1) / pool_align - 1;
+        }
+
+        constexpr size_t class_bytes(size_t index) noexcept
+        {
+            return (index + 1) * pool_align;
+        }
+
+        /// @brief 线程缓存与中心池之间一次交换的块数，小块多换，大块少换
+        constexpr size_t batch_count(size_t index) noexcept
+        {
+            return class_bytes(index) <= 64 ? 64 : 4096 / class_bytes(index) < 8 ? 8 : 4096 / class_bytes(index);
+        }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief central_pool 全局中心池
+        /// ------------------------------------------------------------------------------------------------------------
+
+        class central_pool
+        {
+        private:
+            std::mutex mutex_[pool_class_count];
+            free_block *free_[pool_class_count];
+            size_t count_[pool_class_count];
+
+            central_pool() noexcept: free_(), count_() {}
+
+        public:
+            central_pool(const central_pool &) = delete;
+
+            central_pool &operator=(const central_pool &) = delete;
+
+            /// @brief 中心池故意不析构，保证在静态对象析构阶段归还的节点仍然有效
+            static central_pool &instance()
+            {
+                static central_pool *pool = new central_pool();
+                return *pool;
+            }
+
+            /**
+             * @brief 取出最多 n 个空闲块组成的链表，中心池为空时切分一个新的 slab
+             * @param[out] got 实际取出的块数(至少为 1)
+             * */
+            free_block *fetch(size_t index, size_t n, size_t &got)
+            {
+                std::lock_guard<std::mutex> lock(mutex_[index]);
+                if (free_[index] == nullptr)
+                    carve_slab(index);
+                free_block *head = free_[index];
+                free_block *tail = head;
+                got = 1;
+                while (got < n && tail->next != nullptr)
+                {
+                    tail = tail->next;
+                    ++got;
+                }
+                free_[index] = tail->next;
+                count_[index] -= got;
+                tail->next = nullptr;
+                return head;
+            }
+
+            /// @brief 把 [first, last] 这 n 个块组成的链表还给中心池
+            void give_back(size_t index, free_block *first, free_block *last, size_t n) noexcept
+            {
+                std::lock_guard<std::mutex> lock(mutex_[index]);
+                last->next = free_[index];
+                free_[index] = first;
+                count_[index] += n;
+            }
+
+        private:
+            /// @brief 申请一个 slab 并把它切分成 index 级别的块，全部挂到空闲链表上(调用者持有锁)
+            void carve_slab(size_t index)
+            {
+                const size_t bytes = class_bytes(index);
+                const size_t n = pool_slab_bytes / bytes;
+                char *slab = static_cast<char *>(::operator new(pool_slab_bytes));
+                for (size_t i = 0; i + 1 < n; ++i)
+                    reinterpret_cast<free_block *>(slab + i * bytes)->next =
+                            reinterpret_cast<free_block *>(slab + (i + 1) * bytes);
+                reinterpret_cast<free_block *>(slab + (n - 1) * bytes)->next = free_[index];
+                free_[index] = reinterpret_cast<free_block *>(slab);
+                count_[index] += n;
+            }
+        };
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief thread_cache 线程本地缓存
+        /// ------------------------------------------------------------------------------------------------------------
+
+        /**
+         * @brief 线程缓存本身是平凡类型，保证线程退出的析构阶段里(例如静态容器析构时)仍可安全访问
+         * @note 线程退出时由 cache_flusher 把剩余空闲块还给中心池，之后该线程的请求直接走中心池
+         * */
+
+        struct thread_cache
+        {
+            enum state_type : unsigned char
+            {
+                unregistered, active, flushed
+            };
+
+            free_block *free_[pool_class_count];
+            size_t count_[pool_class_count];
+            state_type state_;
+        };
+
+        inline thread_cache &local_cache() noexcept
+        {
+            static thread_local thread_cache cache;
+            return cache;
+        }
+
+        /// @brief 把线程缓存中 index 级别的前 n 个块还给中心池
+        inline void flush_class(thread_cache &cache, size_t index, size_t n) noexcept
+        {
+            if (n == 0) return;
+            free_block *first = cache.free_[index];
+            free_block *last = first;
+            for (size_t i = 1; i < n; ++i)
+                last = last->next;
+            cache.free_[index] = last->next;
+            cache.count_[index] -= n;
+            central_pool::instance().give_back(index, first, last, n);
+        }
+
+        struct cache_flusher
+        {
+            ~cache_flusher()
+            {
+                thread_cache &cache = local_cache();
+                for (size_t i = 0; i < pool_class_count; ++i)
+                    flush_class(cache, i, cache.count_[i]);
+                cache.state_ = thread_cache::flushed;
+            }
+        };
+
+        /// @brief 第一次使用时注册线程退出时的回收动作
+        inline void register_cache(thread_cache &cache)
+        {
+            static thread_local cache_flusher flusher;
+            (void) flusher;
+            cache.state_ = thread_cache::active;
+        }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief pool_allocate / pool_deallocate
+        /// ------------------------------------------------------------------------------------------------------------
+
+        /// @brief 分配 bytes(<= pool_max_bytes) 字节，优先从线程缓存中取
+        inline void *pool_allocate(size_t bytes)
+        {
+            const size_t index = class_index(bytes);
+            thread_cache &cache = local_cache();
+            if (cache.state_ != thread_cache::active)
+            {
+                if (cache.state_ == thread_cache::flushed)
+                {
+                    size_t got = 0;
+                    return central_pool::instance().fetch(index, 1, got);
+                }
+                register_cache(cache);
+            }
+            free_block *block = cache.free_[index];
+            if (block == nullptr)
+            {
+                size_t got = 0;
+                block = central_pool::instance().fetch(index, batch_count(index), got);
+                cache.count_[index] = got;
+            }
+            cache.free_[index] = block->next;
+            --cache.count_[index];
+            return block;
+        }
+
+        /// @brief 回收到线程缓存，缓存超过两批时把一批还给中心池
+        inline void pool_deallocate(void *ptr, size_t bytes) noexcept
+        {
+            const size_t index = class_index(bytes);
+            auto block = static_cast<free_block *>(ptr);
+            thread_cache &cache = local_cache();
+            if (cache.state_ != thread_cache::active)
+            {
+                central_pool::instance().give_back(index, block, block, 1);
+                return;
+            }
+            block->next = cache.free_[index];
+            cache.free_[index] = block;
+            if (++cache.count_[index] > 2 * batch_count(index))
+                flush_class(cache, index, batch_count(index));
+        }
+    }
+
+    /// ================================================================================================================
+    /// @brief pool_allocator
+    /// ================================================================================================================
+
+    /**
+     * @brief 从全局内存池分配的无状态分配器，小对象(单个节点)走池，数组或大对象走 operator new
+     * @note 适合作为 list 的分配器：mystl::list<T, mystl::pool_allocator<T>>，节点的分配/回收大多无锁且内存连续
+     * @note 内存池是全局的，因此任意两个 pool_allocator 都相等，一个线程分配的节点可以在另一个线程回收
+     * */
+
+    template<typename T>
+    class pool_allocator
+    {
+    public:
+        typedef T value_type;
+        typedef T *pointer;
+        typedef const T *const_pointer;
+        typedef T &reference;
+        typedef const T &const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type is_always_equal;
+
+        template<typename U>
+        struct rebind
+        {
+            typedef pool_allocator<U> other;
+        };
+
+    private:
+        /// @brief 只有单个对象且大小、对齐都在池的范围内时才使用池
+        static constexpr bool use_pool(size_type n) noexcept
+        {
+            return n == 1 && sizeof(T) <= pool_detail::pool_max_bytes && alignof(T) <= pool_detail::pool_align;
+        }
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        pool_allocator() noexcept = default;
+
+        pool_allocator(const pool_allocator &) noexcept = default;
+
+        template<typename U>
+        pool_allocator(const pool_allocator<U> &) noexcept {}
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief allocate / deallocate
+        /// ------------------------------------------------------------------------------------------------------------
+
+        static T *allocate(size_type n)
+        {
+            if (n == 0) return nullptr;
+            THROW_LENGTH_ERROR_IF(n > max_size(), "pool_allocator<T>::allocate size too big");
+            if (use_pool(n))
+                return static_cast<T *>(pool_detail::pool_allocate(sizeof(T)));
+            return static_cast<T *>(mystl::allocate_bytes(n * sizeof(T), alignof(T)));
+        }
+
+        static void deallocate(T *ptr, size_type n) noexcept
+        {
+            if (ptr == nullptr) return;
+            if (use_pool(n))
+                pool_detail::pool_deallocate(ptr, sizeof(T));
+            else
+                mystl::deallocate_bytes(ptr, n * sizeof(T), alignof(T));
+        }
+
+        static size_type max_size() noexcept
+        {
+            return static_cast<size_type>(-1) / sizeof(T);
+        }
+    };
+
+    template<typename T1, typename T2>
+    bool operator==(const pool_allocator<T1> &, const pool_allocator<T2> &) noexcept
+    {
+        return true;
+    }
+
+    template<typename T1, typename T2>
+    bool operator!=(const pool_allocator<T1> &, const pool_allocator<T2> &) noexcept
+    {
+        return false;
+    }
+
+}
+
+#endif //MYSTL_POOL_ALLOCATOR_H
@@ -4,7 +4,7 @@
 
 /**
  * @file queue.h
- * @brief 实现模板类queue 和 priority queue
+ * @brief 实现模板类queue 和 priority queue，以及支持句柄修改/删除的 addressable_priority_queue
  *
  * @date 2023年5月26日
  * @author ZYK
@@ -13,4 +13,783 @@
 #ifndef MYSTL_QUEUE_H
 #define MYSTL_QUEUE_H
 
+#include <initializer_list>
+#include <type_traits>
+
+#include "deque.h"
+#include "vector.h"
+#include "exceptdef.h"
+#include "functional.h"
+#include "iterator.h"
+#include "util.h"
+
+namespace mystl
+{
+    /// ================================================================================================================
+    /// @brief queue
+    /// ================================================================================================================
+
+    /**
+     * @brief 先进先出的容器适配器，默认以 mystl::deque 作为底层容器
+     * @param Container 需要提供 front / back / push_back / emplace_back / pop_front / size / empty / clear / swap
+     * */
+
+    template<typename T, typename Container = mystl::deque<T>>
+    class queue
+    {
+    public:
+        typedef Container container_type;
+        typedef typename Container::value_type value_type;
+        typedef typename Container::size_type size_type;
+        typedef typename Container::reference reference;
+        typedef typename Container::const_reference const_reference;
+
+        static_assert(std::is_same<T, value_type>::value,
+                      "the value_type of Container must be the same as T in queue<T, Container>");
+
+    private:
+        container_type c_;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        queue() = default;
+
+        explicit queue(size_type n) : c_(n) {}
+
+        queue(size_type n, const value_type &value) : c_(n, value) {}
+
+        template<typename IIter, typename std::enable_if<mystl::is_input_iterator<IIter>::value, int>::type = 0>
+        queue(IIter first, IIter last) : c_(first, last) {}
+
+        queue(std::initializer_list<T> ilist) : c_(ilist.begin(), ilist.end()) {}
+
+        explicit queue(const Container &c) : c_(c) {}
+
+        explicit queue(Container &&c) noexcept(std::is_nothrow_move_constructible<Container>::value)
+                : c_(mystl::move(c)) {}
+
+        queue(const queue &rhs) = default;
+
+        queue(queue &&rhs) noexcept(std::is_nothrow_move_constructible<Container>::value) = default;
+
+        queue &operator=(const queue &rhs) = default;
+
+        queue &operator=(queue &&rhs) noexcept(std::is_nothrow_move_assignable<Container>::value) = default;
+
+        queue &operator=(std::initializer_list<T> ilist)
+        {
+            c_ = ilist;
+            return *this;
+        }
+
+        ~queue() = default;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 访问元素
+        /// ------------------------------------------------------------------------------------------------------------
+
+        reference front() { return c_.front(); }
+
+        const_reference front() const { return c_.front(); }
+
+        reference back() { return c_.back(); }
+
+        const_reference back() const { return c_.back(); }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 容量
+        /// ------------------------------------------------------------------------------------------------------------
+
+        bool empty() const noexcept { return c_.empty(); }
+
+        size_type size() const noexcept { return c_.size(); }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 修改容器
+        /// ------------------------------------------------------------------------------------------------------------
+
+        template<typename ...Args>
+        void emplace(Args &&...args) { c_.emplace_back(mystl::forward<Args>(args)...); }
+
+        void push(const value_type &value) { c_.push_back(value); }
+
+        void push(value_type &&value) { c_.emplace_back(mystl::move(value)); }
+
+        void pop() { c_.pop_front(); }
+
+        void clear() { c_.clear(); }
+
+        void swap(queue &rhs) noexcept(noexcept(mystl::swap(c_, rhs.c_))) { mystl::swap(c_, rhs.c_); }
+
+    public:
+        friend bool operator==(const queue &lhs, const queue &rhs) { return lhs.c_ == rhs.c_; }
+
+        friend bool operator<(const queue &lhs, const queue &rhs) { return lhs.c_ < rhs.c_; }
+    };
+
+    template<typename T, typename Container>
+    bool operator!=(const queue<T, Container> &lhs, const queue<T, Container> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template<typename T, typename Container>
+    bool operator>(const queue<T, Container> &lhs, const queue<T, Container> &rhs)
+    {
+        return rhs < lhs;
+    }
+
+    template<typename T, typename Container>
+    bool operator<=(const queue<T, Container> &lhs, const queue<T, Container> &rhs)
+    {
+        return !(rhs < lhs);
+    }
+
+    template<typename T, typename Container>
+    bool operator>=(const queue<T, Container> &lhs, const queue<T, Container> &rhs)
+    {
+        return !(lhs < rhs);
+    }
+
+    template<typename T, typename Container>
+    void swap(queue<T, Container> &lhs, queue<T, Container> &rhs) noexcept(noexcept(lhs.swap(rhs)))
+    {
+        lhs.swap(rhs);
+    }
+
+    /// ================================================================================================================
+    /// @brief d 叉堆算法
+    /// ================================================================================================================
+
+    /**
+     * @brief 以 [first, first + len) 为存储的 D 叉最大堆(按 comp 比较)，下标 i 的孩子为 D*i+1 ... D*i+D，父节点为 (i-1)/D
+     * @note 与二叉堆相比，D 叉堆的高度只有 log_D(n)，pop 时每层比较 D 个相邻的孩子，
+     * @note 这些孩子在内存中连续，一层通常只触及一条缓存行，因此大堆上的缓存缺失明显减少
+     * @note 所有操作都把空位(hole)沿路径移动，元素只移动不交换
+     * */
+
+    /// @brief 把 value 放入空位 hole 并向上调整，top 为堆顶下标(不会越过它)
+    template<size_t D, typename RandomIter, typename Distance, typename T, typename Compare>
+    void dary_sift_up(RandomIter first, Distance hole, Distance top, T &&value, Compare comp)
+    {
+        while (hole > top)
+        {
+            const Distance parent = (hole - 1) / static_cast<Distance>(D);
+            if (!comp(*(first + parent), value))
+                break;
+            *(first + hole) = mystl::move(*(first + parent));
+            hole = parent;
+        }
+        *(first + hole) = mystl::forward<T>(value);
+    }
+
+    /// @brief 把 value 放入空位 hole 并向下调整，len 为堆的大小
+    template<size_t D, typename RandomIter, typename Distance, typename T, typename Compare>
+    void dary_sift_down(RandomIter first, Distance hole, Distance len, T &&value, Compare comp)
+    {
+        while (true)
+        {
+            const Distance child = static_cast<Distance>(D) * hole + 1;
+            if (child >= len)
+                break;
+            // 在至多 D 个连续的孩子中找出最大的一个
+            const Distance last = len - child < static_cast<Distance>(D) ? len : child + static_cast<Distance>(D);
+            Distance best = child;
+            for (Distance i = child + 1; i < last; ++i)
+            {
+                if (comp(*(first + best), *(first + i)))
+                    best = i;
+            }
+            if (!comp(value, *(first + best)))
+                break;
+            *(first + hole) = mystl::move(*(first + best));
+            hole = best;
+        }
+        *(first + hole) = mystl::forward<T>(value);
+    }
+
+    /// @brief [first, last - 1) 已经是堆，把 *(last - 1) 加入堆
+    template<size_t D, typename RandomIter, typename Compare>
+    void dary_push_heap(RandomIter first, RandomIter last, Compare comp)
+    {
+        typedef typename mystl::iterator_traits<RandomIter>::difference_type Distance;
+        typedef typename mystl::iterator_traits<RandomIter>::value_type T;
+        const Distance hole = last - first - 1;
+        if (hole <= 0) return;
+        T value = mystl::move(*(first + hole));
+        mystl::dary_sift_up<D>(first, hole, Distance(0), mystl::move(value), comp);
+    }
+
+    /// @brief 把堆顶移到 *(last - 1)，[first, last - 1) 重新成为堆
+    template<size_t D, typename RandomIter, typename Compare>
+    void dary_pop_heap(RandomIter first, RandomIter last, Compare comp)
+    {
+        typedef typename mystl::iterator_traits<RandomIter>::difference_type Distance;
+        typedef typename mystl::iterator_traits<RandomIter>::value_type T;
+        const Distance len = last - first - 1;
+        if (len <= 0) return;
+        T value = mystl::move(*(first + len));
+        *(first + len) = mystl::move(*first);
+        mystl::dary_sift_down<D>(first, Distance(0), len, mystl::move(value), comp);
+    }
+
+    /// @brief 自底向上建堆，从最后一个非叶节点开始逐个向下调整，O(n)
+    template<size_t D, typename RandomIter, typename Compare>
+    void dary_make_heap(RandomIter first, RandomIter last, Compare comp)
+    {
+        typedef typename mystl::iterator_traits<RandomIter>::difference_type Distance;
+        typedef typename mystl::iterator_traits<RandomIter>::value_type T;
+        const Distance len = last - first;
+        if (len < 2) return;
+        for (Distance hole = (len - 2) / static_cast<Distance>(D) + 1; hole-- > 0;)
+        {
+            T value = mystl::move(*(first + hole));
+            mystl::dary_sift_down<D>(first, hole, len, mystl::move(value), comp);
+        }
+    }
+
+    /// ================================================================================================================
+    /// @brief priority_queue
+    /// ================================================================================================================
+
+    /**
+     * @brief 优先队列，top() 为按 Compare 最大的元素；默认以 mystl::vector 存储 4 叉堆
+     * @param Arity 堆的叉数，越大树越矮、pop 时每层比较越多；4 在百万级元素时通常最快
+     * @note 与 std::priority_queue 相同，Container 需要提供随机访问迭代器以及 push_back / emplace_back / pop_back
+     * */
+
+    template<typename T, typename Container = mystl::vector<T>,
+            typename Compare = mystl::less<typename Container::value_type>, size_t Arity = 4>
+    class priority_queue
+    {
+    public:
+        typedef Container container_type;
+        typedef Compare value_compare;
+        typedef typename Container::value_type value_type;
+        typedef typename Container::size_type size_type;
+        typedef typename Container::reference reference;
+        typedef typename Container::const_reference const_reference;
+
+        static constexpr size_t arity = Arity;
+
+        static_assert(std::is_same<T, value_type>::value,
+                      "the value_type of Container must be the same as T in priority_queue<T, Container>");
+        static_assert(Arity >= 2, "the arity of priority_queue must be at least 2");
+
+    private:
+        container_type c_;
+        value_compare comp_;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        priority_queue() = default;
+
+        explicit priority_queue(const Compare &comp) : c_(), comp_(comp) {}
+
+        priority_queue(const Compare &comp, const Container &c) : c_(c), comp_(comp)
+        {
+            make_heap();
+        }
+
+        priority_queue(const Compare &comp, Container &&c) : c_(mystl::move(c)), comp_(comp)
+        {
+            make_heap();
+        }
+
+        template<typename IIter, typename std::enable_if<mystl::is_input_iterator<IIter>::value, int>::type = 0>
+        priority_queue(IIter first, IIter last, const Compare &comp = Compare()) : c_(first, last), comp_(comp)
+        {
+            make_heap();
+        }
+
+        priority_queue(std::initializer_list<T> ilist, const Compare &comp = Compare())
+                : c_(ilist.begin(), ilist.end()), comp_(comp)
+        {
+            make_heap();
+        }
+
+        priority_queue(const priority_queue &rhs) = default;
+
+        priority_queue(priority_queue &&rhs) = default;
+
+        priority_queue &operator=(const priority_queue &rhs) = default;
+
+        priority_queue &operator=(priority_queue &&rhs) = default;
+
+        priority_queue &operator=(std::initializer_list<T> ilist)
+        {
+            c_ = ilist;
+            make_heap();
+            return *this;
+        }
+
+        ~priority_queue() = default;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 访问元素 / 容量
+        /// ------------------------------------------------------------------------------------------------------------
+
+        const_reference top() const
+        {
+            MYSTL_DEBUG(!empty());
+            return c_.front();
+        }
+
+        bool empty() const noexcept { return c_.empty(); }
+
+        size_type size() const noexcept { return c_.size(); }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 修改容器
+        /// ------------------------------------------------------------------------------------------------------------
+
+        template<typename ...Args>
+        void emplace(Args &&...args)
+        {
+            c_.emplace_back(mystl::forward<Args>(args)...);
+            mystl::dary_push_heap<Arity>(c_.begin(), c_.end(), comp_);
+        }
+
+        void push(const value_type &value)
+        {
+            c_.push_back(value);
+            mystl::dary_push_heap<Arity>(c_.begin(), c_.end(), comp_);
+        }
+
+        void push(value_type &&value)
+        {
+            c_.emplace_back(mystl::move(value));
+            mystl::dary_push_heap<Arity>(c_.begin(), c_.end(), comp_);
+        }
+
+        /// @brief 用最后一个元素填补堆顶的空位再向下调整，不需要先把堆顶换到末尾
+        void pop()
+        {
+            MYSTL_DEBUG(!empty());
+            if (c_.size() > 1)
+            {
+                value_type value = mystl::move(c_.back());
+                c_.pop_back();
+                mystl::dary_sift_down<Arity>(c_.begin(), static_cast<typename Container::difference_type>(0),
+                                             static_cast<typename Container::difference_type>(c_.size()),
+                                             mystl::move(value), comp_);
+            }
+            else
+            {
+                c_.pop_back();
+            }
+        }
+
+        void clear() { c_.clear(); }
+
+        void swap(priority_queue &rhs) noexcept(noexcept(mystl::swap(c_, rhs.c_)) &&
+                                                noexcept(mystl::swap(comp_, rhs.comp_)))
+        {
+            mystl::swap(c_, rhs.c_);
+            mystl::swap(comp_, rhs.comp_);
+        }
+
+    private:
+        void make_heap()
+        {
+            mystl::dary_make_heap<Arity>(c_.begin(), c_.end(), comp_);
+        }
+
+    public:
+        friend bool operator==(const priority_queue &lhs, const priority_queue &rhs) { return lhs.c_ == rhs.c_; }
+
+        friend bool operator!=(const priority_queue &lhs, const priority_queue &rhs) { return lhs.c_ != rhs.c_; }
+    };
+
+    template<typename T, typename Container, typename Compare, size_t Arity>
+    constexpr size_t priority_queue<T, Container, Compare, Arity>::arity;
+
+    template<typename T, typename Container, typename Compare, size_t Arity>
+    void swap(priority_queue<T, Container, Compare, Arity> &lhs, priority_queue<T, Container, Compare, Arity> &rhs)
+    noexcept(noexcept(lhs.swap(rhs)))
+    {
+        lhs.swap(rhs);
+    }
+
+    /// ================================================================================================================
+    /// @brief addressable_priority_queue
+    /// ================================================================================================================
+
+    /**
+     * @brief 可寻址的优先队列：push 返回稳定的句柄，之后可以通过句柄 O(log n) 地修改或删除任意元素
+     * @note 堆本身是 Arity 叉堆，元素和它的槽位编号一起存放在 mystl::vector 中；
+     * @note 另一个 vector 按槽位编号记录元素当前在堆中的下标，元素每次移动时同步更新
+     * @note 元素被删除后槽位回收复用，槽位的版本号随之改变，旧句柄因此失效，contains() 返回 false
+     * @note 典型用法是定时器和 Dijkstra：Compare 取 mystl::greater 得到最小堆，用 decrease_key 提前到期时间/缩短距离
+     * */
+
+    template<typename T, typename Compare = mystl::less<T>, size_t Arity = 4>
+    class addressable_priority_queue
+    {
+    public:
+        typedef T value_type;
+        typedef Compare value_compare;
+        typedef size_t size_type;
+        typedef const T &const_reference;
+
+        static constexpr size_t arity = Arity;
+
+        static_assert(Arity >= 2, "the arity of addressable_priority_queue must be at least 2");
+
+        /// @brief 元素的句柄，默认构造的句柄不指向任何元素
+        class handle
+        {
+            friend class addressable_priority_queue;
+
+            size_type index_;
+            size_type version_;
+
+            handle(size_type index, size_type version) noexcept: index_(index), version_(version) {}
+
+        public:
+            handle() noexcept: index_(static_cast<size_type>(-1)), version_(0) {}
+
+            friend bool operator==(const handle &lhs, const handle &rhs) noexcept
+            {
+                return lhs.index_ == rhs.index_ && lhs.version_ == rhs.version_;
+            }
+
+            friend bool operator!=(const handle &lhs, const handle &rhs) noexcept { return !(lhs == rhs); }
+        };
+
+    private:
+        static constexpr size_type npos = static_cast<size_type>(-1);
+
+        /// @brief 堆中的节点：元素以及它占用的槽位
+        struct node
+        {
+            T value;
+            size_type slot;
+
+            template<typename ...Args>
+            node(size_type s, Args &&...args) : value(mystl::forward<Args>(args)...), slot(s) {}
+        };
+
+        /**
+         * @brief 槽位：使用中时 pos 为元素在堆中的下标；空闲时 pos 为下一个空闲槽位，组成空闲链表
+         * @note 版本号为偶数表示使用中，奇数表示空闲；每次分配和回收都加一，因此旧句柄的版本号不会再匹配
+         * */
+        struct slot_type
+        {
+            size_type pos;
+            size_type version;
+        };
+
+        mystl::vector<node> heap_;
+        mystl::vector<slot_type> slots_;
+        size_type free_head_ = npos;   // 空闲链表头
+        value_compare comp_;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        addressable_priority_queue() = default;
+
+        explicit addressable_priority_queue(const Compare &comp) : comp_(comp) {}
+
+        addressable_priority_queue(const addressable_priority_queue &rhs) = default;
+
+        addressable_priority_queue(addressable_priority_queue &&rhs) = default;
+
+        addressable_priority_queue &operator=(const addressable_priority_queue &rhs) = default;
+
+        addressable_priority_queue &operator=(addressable_priority_queue &&rhs) = default;
+
+        ~addressable_priority_queue() = default;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 访问元素 / 容量
+        /// ------------------------------------------------------------------------------------------------------------
+
+        const_reference top() const
+        {
+            MYSTL_DEBUG(!empty());
+            return heap_.front().value;
+        }
+
+        handle top_handle() const
+        {
+            MYSTL_DEBUG(!empty());
+            return make_handle(heap_.front().slot);
+        }
+
+        /// @brief 句柄对应的元素，句柄必须有效
+        const_reference value(handle h) const
+        {
+            MYSTL_DEBUG(contains(h));
+            return heap_[slots_[h.index_].pos].value;
+        }
+
+        const_reference operator[](handle h) const { return value(h); }
+
+        /// @brief 句柄是否仍指向队列中的元素(元素被弹出或删除后返回 false)
+        bool contains(handle h) const noexcept
+        {
+            return h.index_ < slots_.size() && slots_[h.index_].version == h.version_;
+        }
+
+        bool empty() const noexcept { return heap_.empty(); }
+
+        size_type size() const noexcept { return heap_.size(); }
+
+        void reserve(size_type n)
+        {
+            heap_.reserve(n);
+            slots_.reserve(n);
+        }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 修改容器
+        /// ------------------------------------------------------------------------------------------------------------
+
+        template<typename ...Args>
+        handle emplace(Args &&...args);
+
+        handle push(const value_type &value) { return emplace(value); }
+
+        handle push(value_type &&value) { return emplace(mystl::move(value)); }
+
+        void pop();
+
+        void erase(handle h);
+
+        /// @brief 把句柄对应的元素改为 value，根据新值上浮或下沉
+        void update(handle h, const value_type &value) { assign(h, value_type(value)); }
+
+        void update(handle h, value_type &&value) { assign(h, mystl::move(value)); }
+
+        /**
+         * @brief 提高元素的优先级，只上浮(按最小堆的习惯命名：Compare = mystl::greater 时 value 不大于旧值)
+         * @note value 的优先级必须不低于旧值，即 !comp(value, 旧值)
+         * */
+        void decrease_key(handle h, value_type value)
+        {
+            MYSTL_DEBUG(contains(h) && !comp_(value, heap_[slots_[h.index_].pos].value));
+            const size_type pos = slots_[h.index_].pos;
+            heap_[pos].value = mystl::move(value);
+            sift_up(pos);
+        }
+
+        /// @brief 降低元素的优先级，只下沉；value 的优先级必须不高于旧值
+        void increase_key(handle h, value_type value)
+        {
+            MYSTL_DEBUG(contains(h) && !comp_(heap_[slots_[h.index_].pos].value, value));
+            const size_type pos = slots_[h.index_].pos;
+            heap_[pos].value = mystl::move(value);
+            sift_down(pos);
+        }
+
+        void clear();
+
+        void swap(addressable_priority_queue &rhs) noexcept
+        {
+            heap_.swap(rhs.heap_);
+            slots_.swap(rhs.slots_);
+            mystl::swap(free_head_, rhs.free_head_);
+            mystl::swap(comp_, rhs.comp_);
+        }
+
+    private:
+        handle make_handle(size_type slot) const noexcept { return handle(slot, slots_[slot].version); }
+
+        size_type acquire_slot();
+
+        void release_slot(size_type slot) noexcept;
+
+        void assign(handle h, value_type &&value);
+
+        /// @brief 把 heap_[pos] 放到正确位置(先尝试上浮，不需要再下沉)
+        void restore(size_type pos)
+        {
+            if (pos > 0 && comp_(heap_[(pos - 1) / Arity].value, heap_[pos].value))
+                sift_up(pos);
+            else
+                sift_down(pos);
+        }
+
+        void sift_up(size_type pos);
+
+        void sift_down(size_type pos);
+    };
+
+    template<typename T, typename Compare, size_t Arity>
+    constexpr size_t addressable_priority_queue<T, Compare, Arity>::arity;
+
+    template<typename T, typename Compare, size_t Arity>
+    constexpr typename addressable_priority_queue<T, Compare, Arity>::size_type
+            addressable_priority_queue<T, Compare, Arity>::npos;
+
+    /// ================================================================================================================
+    /// @brief addressable_priority_queue 成员函数定义
+    /// ================================================================================================================
+
+    template<typename T, typename Compare, size_t Arity>
+    template<typename ...Args>
+    typename addressable_priority_queue<T, Compare, Arity>::handle
+    addressable_priority_queue<T, Compare, Arity>::emplace(Args &&...args)
+    {
+        const size_type slot = acquire_slot();
+        try
+        {
+            heap_.emplace_back(slot, mystl::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            release_slot(slot);
+            throw;
+        }
+        slots_[slot].pos = heap_.size() - 1;
+        sift_up(heap_.size() - 1);
+        return make_handle(slot);
+    }
+
+    template<typename T, typename Compare, size_t Arity>
+    void addressable_priority_queue<T, Compare, Arity>::pop()
+    {
+        MYSTL_DEBUG(!empty());
+        release_slot(heap_.front().slot);
+        if (heap_.size() > 1)
+        {
+            heap_.front() = mystl::move(heap_.back());
+            heap_.pop_back();
+            slots_[heap_.front().slot].pos = 0;
+            sift_down(0);
+        }
+        else
+        {
+            heap_.pop_back();
+        }
+    }
+
+    /// @brief 删除任意元素：用最后一个节点填补空位，再按需上浮或下沉
+    template<typename T, typename Compare, size_t Arity>
+    void addressable_priority_queue<T, Compare, Arity>::erase(handle h)
+    {
+        MYSTL_DEBUG(contains(h));
+        const size_type pos = slots_[h.index_].pos;
+        release_slot(h.index_);
+        if (pos + 1 == heap_.size())
+        {
+            heap_.pop_back();
+            return;
+        }
+        heap_[pos] = mystl::move(heap_.back());
+        heap_.pop_back();
+        slots_[heap_[pos].slot].pos = pos;
+        restore(pos);
+    }
+
+    template<typename T, typename Compare, size_t Arity>
+    void addressable_priority_queue<T, Compare, Arity>::assign(handle h, value_type &&value)
+    {
+        MYSTL_DEBUG(contains(h));
+        const size_type pos = slots_[h.index_].pos;
+        heap_[pos].value = mystl::move(value);
+        restore(pos);
+    }
+
+    /// @brief 清空元素，所有槽位回收，已发出的句柄全部失效
+    template<typename T, typename Compare, size_t Arity>
+    void addressable_priority_queue<T, Compare, Arity>::clear()
+    {
+        for (const auto &n: heap_)
+            release_slot(n.slot);
+        heap_.clear();
+    }
+
+    template<typename T, typename Compare, size_t Arity>
+    typename addressable_priority_queue<T, Compare, Arity>::size_type
+    addressable_priority_queue<T, Compare, Arity>::acquire_slot()
+    {
+        if (free_head_ != npos)
+        {
+            const size_type slot = free_head_;
+            free_head_ = slots_[slot].pos;
+            ++slots_[slot].version;
+            return slot;
+        }
+        slots_.push_back(slot_type{npos, 0});
+        return slots_.size() - 1;
+    }
+
+    template<typename T, typename Compare, size_t Arity>
+    void addressable_priority_queue<T, Compare, Arity>::release_slot(size_type slot) noexcept
+    {
+        slots_[slot].pos = free_head_;
+        ++slots_[slot].version;
+        free_head_ = slot;
+    }
+
+    /// @brief 节点沿父节点链上浮，移动的每个节点都同步更新槽位中的下标
+    template<typename T, typename Compare, size_t Arity>
+    void addressable_priority_queue<T, Compare, Arity>::sift_up(size_type pos)
+    {
+        if (pos == 0) return;
+        node moving = mystl::move(heap_[pos]);
+        while (pos > 0)
+        {
+            const size_type parent = (pos - 1) / Arity;
+            if (!comp_(heap_[parent].value, moving.value))
+                break;
+            heap_[pos] = mystl::move(heap_[parent]);
+            slots_[heap_[pos].slot].pos = pos;
+            pos = parent;
+        }
+        heap_[pos] = mystl::move(moving);
+        slots_[heap_[pos].slot].pos = pos;
+    }
+
+    template<typename T, typename Compare, size_t Arity>
+    void addressable_priority_queue<T, Compare, Arity>::sift_down(size_type pos)
+    {
+        const size_type len = heap_.size();
+        if (Arity * pos + 1 >= len) return;
+        node moving = mystl::move(heap_[pos]);
+        while (true)
+        {
+            const size_type child = Arity * pos + 1;
+            if (child >= len)
+                break;
+            const size_type last = len - child < Arity ? len : child + Arity;
+            size_type best = child;
+            for (size_type i = child + 1; i < last; ++i)
+            {
+                if (comp_(heap_[best].value, heap_[i].value))
+                    best = i;
+            }
+            if (!comp_(moving.value, heap_[best].value))
+                break;
+            heap_[pos] = mystl::move(heap_[best]);
+            slots_[heap_[pos].slot].pos = pos;
+            pos = best;
+        }
+        heap_[pos] = mystl::move(moving);
+        slots_[heap_[pos].slot].pos = pos;
+    }
+
+    template<typename T, typename Compare, size_t Arity>
+    void swap(addressable_priority_queue<T, Compare, Arity> &lhs, addressable_priority_queue<T, Compare, Arity> &rhs)
+    noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+}
+
 #endif //MYSTL_QUEUE_H
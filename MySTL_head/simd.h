@@ -0,0 +1,730 @@
+/**
+ * @file simd.h
+ * @brief 连续内存上算术类型的向量化内核：fill、mismatch、find、count
+ * @note x86 上使用 SSE2，GCC/Clang 下运行时检测到 AVX2 时改用 256 位版本；其它平台退化为标量循环
+ * @note 定义 MYSTL_NO_SIMD 可关闭全部向量化内核
+ */
+
+#ifndef MYSTL_SIMD_H
+#define MYSTL_SIMD_H
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if !defined(MYSTL_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || \
+    (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MYSTL_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define MYSTL_SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+namespace mystl
+{
+    namespace simd
+    {
+        /// ============================================================================================================
+        /// @brief 类型萃取
+        /// ============================================================================================================
+
+        /// @brief 可以交给向量化内核的元素类型：1/2/4/8 字节的算术类型
+        template<typename T>
+        struct is_vectorizable : public std::integral_constant<bool,
+                std::is_arithmetic<T>::value &&
+                (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>
+        {
+        };
+
+        /**
+         * @brief 相等当且仅当二进制表示相同的类型，可以直接比较字节(memcmp)
+         * @note 浮点数不满足：+0.0 == -0.0，NaN != NaN
+         * */
+        template<typename T>
+        struct is_bitwise_comparable : public std::integral_constant<bool,
+                std::is_integral<T>::value && is_vectorizable<T>::value>
+        {
+        };
+
+        /// @brief [first1, last1) 与 first2 起的序列可以走向量化路径：去掉 const 后类型相同且可向量化
+        template<typename Tp, typename Up>
+        struct is_simd_pair : public std::integral_constant<bool,
+                std::is_same<typename std::remove_const<Tp>::type, typename std::remove_const<Up>::type>::value &&
+                is_vectorizable<typename std::remove_const<Tp>::type>::value>
+        {
+        };
+
+        /**
+         * @brief 在 Tp 元素中查找 U 类型的值时可以走向量化路径：整数之间任意组合，浮点数只接受同类型的值
+         * @note 整数与浮点数混合比较时会发生浮点转换，不做向量化
+         * */
+        template<typename Tp, typename U>
+        struct is_simd_key : public std::integral_constant<bool,
+                is_vectorizable<typename std::remove_const<Tp>::type>::value && std::is_arithmetic<U>::value &&
+                ((std::is_integral<typename std::remove_const<Tp>::type>::value && std::is_integral<U>::value) ||
+                 std::is_same<typename std::remove_const<Tp>::type, U>::value)>
+        {
+        };
+
+        /**
+         * @brief 把要查找的值转换为元素类型 T
+         * @return value 不可能与任何元素相等时返回 false，例如在 unsigned char 中查找 -1
+         * @note 元素与 value 按常用算术转换后的公共类型比较；T 到公共类型的转换是单射，
+         * @note 所以只要 key 与 value 在公共类型下相等，element == value 就等价于 element == key
+         * */
+        template<typename T, typename U>
+        bool make_key(const U &value, T &key) noexcept
+        {
+            typedef typename std::common_type<T, U>::type common;
+            key = static_cast<T>(value);
+            return static_cast<common>(key) == static_cast<common>(value);
+        }
+
+        /// ============================================================================================================
+        /// @brief 辅助函数
+        /// ============================================================================================================
+
+        /// @brief 最低位 1 的下标，mask 不能为 0
+        inline unsigned count_trailing_zeros(unsigned mask) noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+            unsigned n = 0;
+            for (; (mask & 1u) == 0; mask >>= 1) ++n;
+            return n;
+#endif
+        }
+
+#ifdef MYSTL_SIMD_AVX2
+
+        /// @brief 运行时检测 CPU 是否支持 AVX2，结果只计算一次
+        inline bool cpu_has_avx2() noexcept
+        {
+            static const bool result = []
+            {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") != 0;
+            }();
+            return result;
+        }
+
+#endif
+
+        /// ============================================================================================================
+        /// @brief fill
+        /// ============================================================================================================
+
+        /// @brief 把 value 的字节重复铺满 32 字节，作为向量存储的模板
+        template<typename T>
+        void make_fill_pattern(unsigned char (&pattern)[32], const T &value) noexcept
+        {
+            for (size_t i = 0; i < 32; i += sizeof(T))
+                std::memcpy(pattern + i, &value, sizeof(T));
+        }
+
+#ifdef MYSTL_SIMD_SSE2
+
+        /// @param[in] n 字节数，pattern 中的字节按 16 字节为周期重复
+        inline unsigned char *fill_bytes_sse2(unsigned char *first, size_t n, const unsigned char *pattern) noexcept
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pattern));
+            for (; n >= 64; n -= 64, first += 64)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(first), v);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(first + 16), v);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(first + 32), v);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(first + 48), v);
+            }
+            for (; n >= 16; n -= 16, first += 16)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(first), v);
+            return first;
+        }
+
+#endif
+#ifdef MYSTL_SIMD_AVX2
+
+        __attribute__((target("avx2")))
+        inline unsigned char *fill_bytes_avx2(unsigned char *first, size_t n, const unsigned char *pattern) noexcept
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pattern));
+            for (; n >= 128; n -= 128, first += 128)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(first), v);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(first + 32), v);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(first + 64), v);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(first + 96), v);
+            }
+            for (; n >= 32; n -= 32, first += 32)
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(first), v);
+            return first;
+        }
+
+#endif
+
+        /**
+         * @brief 把 [first, first + n) 赋值为 value
+         * @note 1 字节类型直接 memset；其余类型按字节模板整块存储，剩余不足一个向量的元素逐个赋值
+         * */
+        template<typename T>
+        T *fill(T *first, size_t n, T value) noexcept
+        {
+            static_assert(is_vectorizable<T>::value, "simd::fill requires a vectorizable arithmetic type");
+            if (sizeof(T) == 1)
+            {
+                if (n != 0) std::memset(first, *reinterpret_cast<const unsigned char *>(&value), n);
+                return first + n;
+            }
+            T *last = first + n;
+#ifdef MYSTL_SIMD_SSE2
+            unsigned char pattern[32];
+            make_fill_pattern(pattern, value);
+            unsigned char *bytes = reinterpret_cast<unsigned char *>(first);
+#ifdef MYSTL_SIMD_AVX2
+            if (n * sizeof(T) >= 64 && cpu_has_avx2())
+                bytes = fill_bytes_avx2(bytes, n * sizeof(T), pattern);
+            else
+#endif
+                bytes = fill_bytes_sse2(bytes, n * sizeof(T), pattern);
+            first = reinterpret_cast<T *>(bytes);
+#endif
+            for (; first != last; ++first)
+                *first = value;
+            return last;
+        }
+
+        /// ============================================================================================================
+        /// @brief mismatch
+        /// ============================================================================================================
+
+        /// @brief 标量版本，也用于处理向量化之后剩余的尾部
+        template<typename T>
+        size_t mismatch_scalar(const T *first1, const T *first2, size_t i, size_t n) noexcept
+        {
+            for (; i < n && first1[i] == first2[i]; ++i) {}
+            return i;
+        }
+
+#ifdef MYSTL_SIMD_SSE2
+
+        inline size_t mismatch_bytes_sse2(const unsigned char *a, const unsigned char *b, size_t n) noexcept
+        {
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16)
+            {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+                const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+                if (mask != 0xFFFFu)
+                    return i + count_trailing_zeros(~mask);
+            }
+            return mismatch_scalar(a, b, i, n);
+        }
+
+        /// @note _mm_cmpeq_ps 按 IEEE 语义比较：+0.0 与 -0.0 相等，NaN 与任何值都不相等，与 operator== 一致
+        inline size_t mismatch_float_sse2(const float *a, const float *b, size_t n) noexcept
+        {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const unsigned mask = static_cast<unsigned>(
+                        _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))));
+                if (mask != 0xFu)
+                    return i + count_trailing_zeros(~mask);
+            }
+            return mismatch_scalar(a, b, i, n);
+        }
+
+        inline size_t mismatch_double_sse2(const double *a, const double *b, size_t n) noexcept
+        {
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+            {
+                const unsigned mask = static_cast<unsigned>(
+                        _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))));
+                if (mask != 0x3u)
+                    return i + count_trailing_zeros(~mask);
+            }
+            return mismatch_scalar(a, b, i, n);
+        }
+
+#endif
+#ifdef MYSTL_SIMD_AVX2
+
+        /// @brief 每轮比较 64 字节，两次比较结果先合并，全部相等时只需要一次 movemask
+        __attribute__((target("avx2")))
+        inline size_t mismatch_bytes_avx2(const unsigned char *a, const unsigned char *b, size_t n) noexcept
+        {
+            size_t i = 0;
+            for (; i + 64 <= n; i += 64)
+            {
+                const __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                                                     _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+                const __m256i e1 = _mm256_cmpeq_epi8(
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i + 32)),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i + 32)));
+                if (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(e0, e1))) != 0xFFFFFFFFu)
+                {
+                    const unsigned m0 = static_cast<unsigned>(_mm256_movemask_epi8(e0));
+                    if (m0 != 0xFFFFFFFFu)
+                        return i + count_trailing_zeros(~m0);
+                    return i + 32 + count_trailing_zeros(~static_cast<unsigned>(_mm256_movemask_epi8(e1)));
+                }
+            }
+            for (; i + 32 <= n; i += 32)
+            {
+                const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)))));
+                if (mask != 0xFFFFFFFFu)
+                    return i + count_trailing_zeros(~mask);
+            }
+            return mismatch_scalar(a, b, i, n);
+        }
+
+        __attribute__((target("avx2")))
+        inline size_t mismatch_float_avx2(const float *a, const float *b, size_t n) noexcept
+        {
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(
+                        _mm256_cmp_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_EQ_OQ)));
+                if (mask != 0xFFu)
+                    return i + count_trailing_zeros(~mask);
+            }
+            return mismatch_scalar(a, b, i, n);
+        }
+
+        __attribute__((target("avx2")))
+        inline size_t mismatch_double_avx2(const double *a, const double *b, size_t n) noexcept
+        {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                const unsigned mask = static_cast<unsigned>(_mm256_movemask_pd(
+                        _mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_EQ_OQ)));
+                if (mask != 0xFu)
+                    return i + count_trailing_zeros(~mask);
+            }
+            return mismatch_scalar(a, b, i, n);
+        }
+
+#endif
+
+        /// @brief 首个不同字节的下标，全部相同时返回 n
+        inline size_t mismatch_bytes(const void *first1, const void *first2, size_t n) noexcept
+        {
+            const unsigned char *a = static_cast<const unsigned char *>(first1);
+            const unsigned char *b = static_cast<const unsigned char *>(first2);
+            if (n < 16)
+                return mismatch_scalar(a, b, 0, n);
+#ifdef MYSTL_SIMD_AVX2
+            if (n >= 64 && cpu_has_avx2())
+                return mismatch_bytes_avx2(a, b, n);
+#endif
+#ifdef MYSTL_SIMD_SSE2
+            return mismatch_bytes_sse2(a, b, n);
+#else
+            return mismatch_scalar(a, b, 0, n);
+#endif
+        }
+
+        /// @brief 整数类型：二进制相同即相等，按字节查找后换算为元素下标
+        template<typename T>
+        size_t mismatch_cat(const T *first1, const T *first2, size_t n, std::true_type) noexcept
+        {
+            return mismatch_bytes(first1, first2, n * sizeof(T)) / sizeof(T);
+        }
+
+        /// @brief 浮点类型：按 operator== 的语义逐元素比较
+        template<typename T>
+        size_t mismatch_cat(const T *first1, const T *first2, size_t n, std::false_type) noexcept
+        {
+            return mismatch_scalar(first1, first2, 0, n);
+        }
+
+        inline size_t mismatch_cat(const float *first1, const float *first2, size_t n, std::false_type) noexcept
+        {
+#ifdef MYSTL_SIMD_AVX2
+            if (n >= 16 && cpu_has_avx2())
+                return mismatch_float_avx2(first1, first2, n);
+#endif
+#ifdef MYSTL_SIMD_SSE2
+            return mismatch_float_sse2(first1, first2, n);
+#else
+            return mismatch_scalar(first1, first2, 0, n);
+#endif
+        }
+
+        inline size_t mismatch_cat(const double *first1, const double *first2, size_t n, std::false_type) noexcept
+        {
+#ifdef MYSTL_SIMD_AVX2
+            if (n >= 8 && cpu_has_avx2())
+                return mismatch_double_avx2(first1, first2, n);
+#endif
+#ifdef MYSTL_SIMD_SSE2
+            return mismatch_double_sse2(first1, first2, n);
+#else
+            return mismatch_scalar(first1, first2, 0, n);
+#endif
+        }
+
+        /// @brief 第一个 first1[i] != first2[i] 的下标 i，全部相等时返回 n
+        template<typename T>
+        size_t mismatch(const T *first1, const T *first2, size_t n) noexcept
+        {
+            static_assert(is_vectorizable<T>::value, "simd::mismatch requires a vectorizable arithmetic type");
+            return mismatch_cat(first1, first2, n, is_bitwise_comparable<T>());
+        }
+
+        /// ============================================================================================================
+        /// @brief find / count
+        /// ============================================================================================================
+
+        /**
+         * @brief 每种元素类型的广播与逐元素相等比较，相等的元素所有字节置为 0xFF
+         * @note 8 字节整数在 SSE2 下没有 64 位比较：先按 32 位比较，再要求两个半边都相等
+         * */
+
+#ifdef MYSTL_SIMD_SSE2
+
+        template<typename T, size_t Size = sizeof(T), bool Floating = std::is_floating_point<T>::value>
+        struct sse2_lanes;
+
+        template<typename T>
+        struct sse2_lanes<T, 1, false>
+        {
+            static __m128i broadcast(T v) noexcept { return _mm_set1_epi8(static_cast<char>(v)); }
+
+            static __m128i equal(__m128i a, __m128i b) noexcept { return _mm_cmpeq_epi8(a, b); }
+        };
+
+        template<typename T>
+        struct sse2_lanes<T, 2, false>
+        {
+            static __m128i broadcast(T v) noexcept { return _mm_set1_epi16(static_cast<short>(v)); }
+
+            static __m128i equal(__m128i a, __m128i b) noexcept { return _mm_cmpeq_epi16(a, b); }
+        };
+
+        template<typename T>
+        struct sse2_lanes<T, 4, false>
+        {
+            static __m128i broadcast(T v) noexcept { return _mm_set1_epi32(static_cast<int>(v)); }
+
+            static __m128i equal(__m128i a, __m128i b) noexcept { return _mm_cmpeq_epi32(a, b); }
+        };
+
+        template<typename T>
+        struct sse2_lanes<T, 8, false>
+        {
+            static __m128i broadcast(T v) noexcept { return _mm_set1_epi64x(static_cast<long long>(v)); }
+
+            static __m128i equal(__m128i a, __m128i b) noexcept
+            {
+                const __m128i e = _mm_cmpeq_epi32(a, b);
+                return _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+            }
+        };
+
+        template<typename T>
+        struct sse2_lanes<T, 4, true>
+        {
+            static __m128i broadcast(T v) noexcept { return _mm_castps_si128(_mm_set1_ps(v)); }
+
+            static __m128i equal(__m128i a, __m128i b) noexcept
+            {
+                return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+            }
+        };
+
+        template<typename T>
+        struct sse2_lanes<T, 8, true>
+        {
+            static __m128i broadcast(T v) noexcept { return _mm_castpd_si128(_mm_set1_pd(v)); }
+
+            static __m128i equal(__m128i a, __m128i b) noexcept
+            {
+                return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+            }
+        };
+
+        template<typename T>
+        size_t find_sse2(const T *first, size_t n, T value) noexcept
+        {
+            typedef sse2_lanes<T> lanes;
+            const size_t per = 16 / sizeof(T);
+            const __m128i v = lanes::broadcast(value);
+            size_t i = 0;
+            for (; i + per <= n; i += per)
+            {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(lanes::equal(x, v)));
+                if (mask != 0)
+                    return i + count_trailing_zeros(mask) / sizeof(T);
+            }
+            for (; i < n && !(first[i] == value); ++i) {}
+            return i;
+        }
+
+        /**
+         * @brief 相等元素的每个字节在 8 位计数器上减去 0xFF(即加 1)，计数器溢出前用 _mm_sad_epu8 汇总到 64 位，
+         * @brief 最后的字节数除以 sizeof(T) 就是元素个数
+         * */
+        template<typename T>
+        size_t count_sse2(const T *first, size_t n, T value) noexcept
+        {
+            typedef sse2_lanes<T> lanes;
+            const size_t per = 16 / sizeof(T);
+            const __m128i v = lanes::broadcast(value);
+            const __m128i zero = _mm_setzero_si128();
+            __m128i total = zero;
+            size_t i = 0;
+            while (i + per <= n)
+            {
+                __m128i acc = zero;
+                for (unsigned round = 0; round < 255 && i + per <= n; ++round, i += per)
+                {
+                    const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+                    acc = _mm_sub_epi8(acc, lanes::equal(x, v));
+                }
+                total = _mm_add_epi64(total, _mm_sad_epu8(acc, zero));
+            }
+            unsigned long long sums[2];
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(sums), total);
+            size_t result = static_cast<size_t>((sums[0] + sums[1]) / sizeof(T));
+            for (; i < n; ++i)
+            {
+                if (first[i] == value) ++result;
+            }
+            return result;
+        }
+
+#endif
+#ifdef MYSTL_SIMD_AVX2
+
+        template<typename T, size_t Size = sizeof(T), bool Floating = std::is_floating_point<T>::value>
+        struct avx2_lanes;
+
+        template<typename T>
+        struct avx2_lanes<T, 1, false>
+        {
+            __attribute__((target("avx2")))
+            static __m256i broadcast(T v) noexcept { return _mm256_set1_epi8(static_cast<char>(v)); }
+
+            __attribute__((target("avx2")))
+            static __m256i equal(__m256i a, __m256i b) noexcept { return _mm256_cmpeq_epi8(a, b); }
+        };
+
+        template<typename T>
+        struct avx2_lanes<T, 2, false>
+        {
+            __attribute__((target("avx2")))
+            static __m256i broadcast(T v) noexcept { return _mm256_set1_epi16(static_cast<short>(v)); }
+
+            __attribute__((target("avx2")))
+            static __m256i equal(__m256i a, __m256i b) noexcept { return _mm256_cmpeq_epi16(a, b); }
+        };
+
+        template<typename T>
+        struct avx2_lanes<T, 4, false>
+        {
+            __attribute__((target("avx2")))
+            static __m256i broadcast(T v) noexcept { return _mm256_set1_epi32(static_cast<int>(v)); }
+
+            __attribute__((target("avx2")))
+            static __m256i equal(__m256i a, __m256i b) noexcept { return _mm256_cmpeq_epi32(a, b); }
+        };
+
+        template<typename T>
+        struct avx2_lanes<T, 8, false>
+        {
+            __attribute__((target("avx2")))
+            static __m256i broadcast(T v) noexcept { return _mm256_set1_epi64x(static_cast<long long>(v)); }
+
+            __attribute__((target("avx2")))
+            static __m256i equal(__m256i a, __m256i b) noexcept { return _mm256_cmpeq_epi64(a, b); }
+        };
+
+        template<typename T>
+        struct avx2_lanes<T, 4, true>
+        {
+            __attribute__((target("avx2")))
+            static __m256i broadcast(T v) noexcept { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+
+            __attribute__((target("avx2")))
+            static __m256i equal(__m256i a, __m256i b) noexcept
+            {
+                return _mm256_castps_si256(
+                        _mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+            }
+        };
+
+        template<typename T>
+        struct avx2_lanes<T, 8, true>
+        {
+            __attribute__((target("avx2")))
+            static __m256i broadcast(T v) noexcept { return _mm256_castpd_si256(_mm256_set1_pd(v)); }
+
+            __attribute__((target("avx2")))
+            static __m256i equal(__m256i a, __m256i b) noexcept
+            {
+                return _mm256_castpd_si256(
+                        _mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+            }
+        };
+
+        template<typename T>
+        __attribute__((target("avx2")))
+        size_t find_avx2(const T *first, size_t n, T value) noexcept
+        {
+            typedef avx2_lanes<T> lanes;
+            const size_t per = 32 / sizeof(T);
+            const __m256i v = lanes::broadcast(value);
+            size_t i = 0;
+            for (; i + per <= n; i += per)
+            {
+                const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + i));
+                const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(lanes::equal(x, v)));
+                if (mask != 0)
+                    return i + count_trailing_zeros(mask) / sizeof(T);
+            }
+            for (; i < n && !(first[i] == value); ++i) {}
+            return i;
+        }
+
+        template<typename T>
+        __attribute__((target("avx2")))
+        size_t count_avx2(const T *first, size_t n, T value) noexcept
+        {
+            typedef avx2_lanes<T> lanes;
+            const size_t per = 32 / sizeof(T);
+            const __m256i v = lanes::broadcast(value);
+            const __m256i zero = _mm256_setzero_si256();
+            __m256i total = zero;
+            size_t i = 0;
+            while (i + per <= n)
+            {
+                __m256i acc = zero;
+                for (unsigned round = 0; round < 255 && i + per <= n; ++round, i += per)
+                {
+                    const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + i));
+                    acc = _mm256_sub_epi8(acc, lanes::equal(x, v));
+                }
+                total = _mm256_add_epi64(total, _mm256_sad_epu8(acc, zero));
+            }
+            unsigned long long sums[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums), total);
+            size_t result = static_cast<size_t>((sums[0] + sums[1] + sums[2] + sums[3]) / sizeof(T));
+            for (; i < n; ++i)
+            {
+                if (first[i] == value) ++result;
+            }
+            return result;
+        }
+
+#endif
+
+        /// @brief 第一个等于 value 的元素下标，没有时返回 n；单字节类型使用 memchr
+        template<typename T>
+        size_t find(const T *first, size_t n, T value) noexcept
+        {
+            static_assert(is_vectorizable<T>::value, "simd::find requires a vectorizable arithmetic type");
+            if (sizeof(T) == 1)
+            {
+                if (n == 0) return 0;
+                const void *p = std::memchr(first, *reinterpret_cast<const unsigned char *>(&value), n);
+                return p == nullptr ? n : static_cast<size_t>(static_cast<const T *>(p) - first);
+            }
+#ifdef MYSTL_SIMD_AVX2
+            if (n * sizeof(T) >= 64 && cpu_has_avx2())
+                return find_avx2(first, n, value);
+#endif
+#ifdef MYSTL_SIMD_SSE2
+            return find_sse2(first, n, value);
+#else
+            size_t i = 0;
+            for (; i < n && !(first[i] == value); ++i) {}
+            return i;
+#endif
+        }
+
+        /// @brief 等于 value 的元素个数
+        template<typename T>
+        size_t count(const T *first, size_t n, T value) noexcept
+        {
+            static_assert(is_vectorizable<T>::value, "simd::count requires a vectorizable arithmetic type");
+#ifdef MYSTL_SIMD_AVX2
+            if (n * sizeof(T) >= 64 && cpu_has_avx2())
+                return count_avx2(first, n, value);
+#endif
+#ifdef MYSTL_SIMD_SSE2
+            return count_sse2(first, n, value);
+#else
+            size_t result = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (first[i] == value) ++result;
+            }
+            return result;
+#endif
+        }
+
+        /// ============================================================================================================
+        /// @brief equal / lexicographical_compare
+        /// ============================================================================================================
+
+        /// @brief 整数类型直接 memcmp(标准库的实现本身已经向量化)，浮点类型使用 mismatch
+        template<typename T>
+        bool equal(const T *first1, const T *first2, size_t n) noexcept
+        {
+            if (is_bitwise_comparable<T>::value)
+                return n == 0 || std::memcmp(first1, first2, n * sizeof(T)) == 0;
+            return simd::mismatch(first1, first2, n) == n;
+        }
+
+        /// @brief 整数类型第一个不相等的元素必然有大小之分
+        template<typename T>
+        bool lexicographical_compare_cat(const T *first1, size_t n1, const T *first2, size_t n2,
+                                         std::true_type) noexcept
+        {
+            const size_t n = n1 < n2 ? n1 : n2;
+            const size_t i = simd::mismatch(first1, first2, n);
+            return i == n ? n1 < n2 : first1[i] < first2[i];
+        }
+
+        /// @brief 浮点类型中 NaN 与任何值既不相等也没有大小关系，这时与逐元素的实现一样继续向后比较
+        template<typename T>
+        bool lexicographical_compare_cat(const T *first1, size_t n1, const T *first2, size_t n2,
+                                         std::false_type) noexcept
+        {
+            const size_t n = n1 < n2 ? n1 : n2;
+            for (size_t i = 0;; ++i)
+            {
+                i += simd::mismatch(first1 + i, first2 + i, n - i);
+                if (i == n) return n1 < n2;
+                if (first1[i] < first2[i]) return true;
+                if (first2[i] < first1[i]) return false;
+            }
+        }
+
+        /// @brief 字典序比较 [first1, first1 + n1) 与 [first2, first2 + n2)：先用 mismatch 跳过相等的前缀
+        template<typename T>
+        bool lexicographical_compare(const T *first1, size_t n1, const T *first2, size_t n2) noexcept
+        {
+            return lexicographical_compare_cat(first1, n1, first2, n2, is_bitwise_comparable<T>());
+        }
+    }
+}
+
+#endif //MYSTL_SIMD_H
@@ -0,0 +1,916 @@
+/**
+ * @file small_vector.h
+ * @brief 实现模板类small_vector：前 N 个元素存放在对象内部的缓冲区中，超过 N 个之后才向分配器申请堆空间
+ */
+
+#ifndef MYSTL_SMALL_VECTOR_H
+#define MYSTL_SMALL_VECTOR_H
+
+#include <initializer_list>
+#include <type_traits>
+
+#include "allocator.h"
+#include "allocator_traits.h"
+#include "algobase.h"
+#include "uninitialized.h"
+#include "exceptdef.h"
+#include "memory.h"
+
+namespace mystl
+{
+    /**
+     * @brief 接口与 vector 相同，元素不超过 N 个时不分配任何堆内存
+     * @note 元素在内部缓冲区时移动/交换需要逐个搬移元素，迭代器在移动之后失效
+     * */
+
+    template<typename T, size_t N, typename Alloc = mystl::allocator<T>>
+    class small_vector : private mystl::alloc_holder<Alloc>
+    {
+        static_assert(N > 0, "the inline capacity of small_vector<T, N> must be greater than 0");
+        static_assert(std::is_same<T, typename Alloc::value_type>::value,
+                      "the value_type of Alloc must be the same as T in small_vector<T, N, Alloc>");
+
+        typedef mystl::alloc_holder<Alloc> holder_type;
+
+    public:
+        typedef Alloc allocator_type;
+        typedef mystl::allocator_traits<Alloc> alloc_traits;
+        typedef T value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef typename alloc_traits::size_type size_type;
+        typedef typename alloc_traits::difference_type difference_type;
+
+        typedef value_type *iterator;
+        typedef const value_type *const_iterator;
+        typedef mystl::reverse_iterator<iterator> reverse_iterator;
+        typedef mystl::reverse_iterator<const_iterator> const_reverse_iterator;
+
+        allocator_type get_allocator() const { return get_alloc(); }
+
+    private:
+        using holder_type::get_alloc;
+
+        iterator begin_;
+        iterator end_;
+        iterator cap_;
+        // 内部缓冲区，能容纳 N 个元素
+        typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type buf_;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        small_vector() noexcept: begin_(inline_data()), end_(begin_), cap_(begin_ + N) {}
+
+        explicit small_vector(const allocator_type &alloc) noexcept
+                : holder_type(alloc), begin_(inline_data()), end_(begin_), cap_(begin_ + N) {}
+
+        explicit small_vector(size_type n, const allocator_type &alloc = allocator_type())
+                : holder_type(alloc), begin_(inline_data()), end_(begin_), cap_(begin_ + N)
+        {
+            fill_init(n, value_type());
+        }
+
+        small_vector(size_type n, const value_type &value, const allocator_type &alloc = allocator_type())
+                : holder_type(alloc), begin_(inline_data()), end_(begin_), cap_(begin_ + N)
+        {
+            fill_init(n, value);
+        }
+
+        template<typename Iter, typename std::enable_if<mystl::is_input_iterator<Iter>::value, int>::type = 0>
+        small_vector(Iter first, Iter last, const allocator_type &alloc = allocator_type())
+                : holder_type(alloc), begin_(inline_data()), end_(begin_), cap_(begin_ + N)
+        {
+            range_init(first, last, iterator_category(first));
+        }
+
+        small_vector(std::initializer_list<value_type> ilist, const allocator_type &alloc = allocator_type())
+                : holder_type(alloc), begin_(inline_data()), end_(begin_), cap_(begin_ + N)
+        {
+            range_init(ilist.begin(), ilist.end(), mystl::forward_iterator_tag());
+        }
+
+        small_vector(const small_vector &rhs)
+                : holder_type(alloc_traits::select_on_container_copy_construction(rhs.get_alloc())),
+                  begin_(inline_data()), end_(begin_), cap_(begin_ + N)
+        {
+            range_init(rhs.begin_, rhs.end_, mystl::forward_iterator_tag());
+        }
+
+        /// @brief rhs 在堆上时直接接管空间，否则把元素逐个搬移到自己的内部缓冲区
+        small_vector(small_vector &&rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+                : holder_type(mystl::move(rhs.get_alloc())), begin_(inline_data()), end_(begin_), cap_(begin_ + N)
+        {
+            if (rhs.is_inline())
+            {
+                end_ = mystl::uninitialized_relocate(rhs.begin_, rhs.end_, begin_);
+                rhs.end_ = rhs.begin_;
+            }
+            else
+            {
+                begin_ = rhs.begin_;
+                end_ = rhs.end_;
+                cap_ = rhs.cap_;
+                rhs.reset_inline();
+            }
+        }
+
+        small_vector &operator=(const small_vector &rhs);
+
+        small_vector &operator=(small_vector &&rhs);
+
+        small_vector &operator=(std::initializer_list<value_type> ilist)
+        {
+            assign(ilist.begin(), ilist.end());
+            return *this;
+        }
+
+        ~small_vector()
+        {
+            alloc_traits::destroy(get_alloc(), begin_, end_);
+            free_heap();
+        }
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 迭代器相关操作
+        /// ------------------------------------------------------------------------------------------------------------
+
+        iterator begin() noexcept { return begin_; }
+
+        const_iterator begin() const noexcept { return begin_; }
+
+        iterator end() noexcept { return end_; }
+
+        const_iterator end() const noexcept { return end_; }
+
+        reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+
+        const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+
+        reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+
+        const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        const_iterator cend() const noexcept { return end(); }
+
+        const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+        const_reverse_iterator crend() const noexcept { return rend(); }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 容量相关函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        bool empty() const noexcept { return begin_ == end_; }
+
+        size_type size() const noexcept { return static_cast<size_type>(end_ - begin_); }
+
+        size_type max_size() const noexcept { return alloc_traits::max_size(get_alloc()); }
+
+        size_type capacity() const noexcept { return static_cast<size_type>(cap_ - begin_); }
+
+        /// @brief 内部缓冲区能容纳的元素个数
+        static constexpr size_type inline_capacity() noexcept { return N; }
+
+        /// @brief 元素是否存放在内部缓冲区中
+        bool is_inline() const noexcept { return begin_ == inline_data(); }
+
+        void reserve(size_type n);
+
+        void shrink_to_fit();
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 访问元素相关函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        reference operator[](size_type n)
+        {
+            MYSTL_DEBUG(n < size());
+            return *(begin_ + n);
+        }
+
+        const_reference operator[](size_type n) const
+        {
+            MYSTL_DEBUG(n < size());
+            return *(begin_ + n);
+        }
+
+        reference at(size_type n)
+        {
+            THROW_OUT_OF_RANGE_IF(!(n < size()), "small_vector<T, N>::at() subscript out of range");
+            return (*this)[n];
+        }
+
+        const_reference at(size_type n) const
+        {
+            THROW_OUT_OF_RANGE_IF(!(n < size()), "small_vector<T, N>::at() subscript out of range");
+            return (*this)[n];
+        }
+
+        reference front()
+        {
+            MYSTL_DEBUG(!empty());
+            return *begin_;
+        }
+
+        const_reference front() const
+        {
+            MYSTL_DEBUG(!empty());
+            return *begin_;
+        }
+
+        reference back()
+        {
+            MYSTL_DEBUG(!empty());
+            return *(end_ - 1);
+        }
+
+        const_reference back() const
+        {
+            MYSTL_DEBUG(!empty());
+            return *(end_ - 1);
+        }
+
+        pointer data() noexcept { return begin_; }
+
+        const_pointer data() const noexcept { return begin_; }
+
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 容器相关函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief assign
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        void assign(size_type n, const value_type &value)
+        {
+            clear();
+            fill_insert(end_, n, value);
+        }
+
+        template<typename Iter, typename std::enable_if<mystl::is_input_iterator<Iter>::value, int>::type = 0>
+        void assign(Iter first, Iter last)
+        {
+            MYSTL_DEBUG(!(last < first));
+            copy_assign(first, last, iterator_category(first));
+        }
+
+        void assign(std::initializer_list<value_type> ilist)
+        {
+            copy_assign(ilist.begin(), ilist.end(), mystl::forward_iterator_tag());
+        }
+
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief emplace/emplace_back
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        template<typename... Args>
+        iterator emplace(const_iterator pos, Args &&...args);
+
+        template<typename... Args>
+        reference emplace_back(Args &&...args)
+        {
+            if (end_ != cap_)
+            {
+                alloc_traits::construct(get_alloc(), mystl::address_of(*end_), mystl::forward<Args>(args)...);
+                ++end_;
+            }
+            else
+            {
+                reallocate_emplace(end_, mystl::forward<Args>(args)...);
+            }
+            return *(end_ - 1);
+        }
+
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief push_back/pop_back
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        void push_back(const value_type &value) { emplace_back(value); }
+
+        void push_back(value_type &&value) { emplace_back(mystl::move(value)); }
+
+        void pop_back()
+        {
+            MYSTL_DEBUG(!empty());
+            alloc_traits::destroy(get_alloc(), end_ - 1);
+            --end_;
+        }
+
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief insert
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        iterator insert(const_iterator pos, const value_type &value) { return emplace(pos, value); }
+
+        iterator insert(const_iterator pos, value_type &&value) { return emplace(pos, mystl::move(value)); }
+
+        iterator insert(const_iterator pos, size_type n, const value_type &value)
+        {
+            MYSTL_DEBUG(pos >= begin() && pos <= end());
+            return fill_insert(const_cast<iterator>(pos), n, value);
+        }
+
+        template<typename Iter, typename std::enable_if<mystl::is_input_iterator<Iter>::value, int>::type = 0>
+        iterator insert(const_iterator pos, Iter first, Iter last)
+        {
+            MYSTL_DEBUG(pos >= begin() && pos <= end() && !(last < first));
+            return copy_insert(const_cast<iterator>(pos), first, last, iterator_category(first));
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<value_type> ilist)
+        {
+            return insert(pos, ilist.begin(), ilist.end());
+        }
+
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief erase/clear
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        iterator erase(const_iterator pos)
+        {
+            MYSTL_DEBUG(pos >= begin() && pos < end());
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last);
+
+        void clear() noexcept
+        {
+            alloc_traits::destroy(get_alloc(), begin_, end_);
+            end_ = begin_;
+        }
+
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief resize/swap
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        void resize(size_type new_size)
+        {
+            resize(new_size, value_type());
+        }
+
+        void resize(size_type new_size, const value_type &value)
+        {
+            if (new_size < size())
+                erase(begin_ + new_size, end_);
+            else
+                fill_insert(end_, new_size - size(), value);
+        }
+
+        void swap(small_vector &rhs);
+
+    private:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief helper function
+        /// ------------------------------------------------------------------------------------------------------------
+
+        pointer inline_data() noexcept
+        {
+            return reinterpret_cast<pointer>(&buf_);
+        }
+
+        const_pointer inline_data() const noexcept
+        {
+            return reinterpret_cast<const_pointer>(&buf_);
+        }
+
+        /// @brief 回到空的内部缓冲区状态，不析构元素也不释放空间
+        void reset_inline() noexcept
+        {
+            begin_ = end_ = inline_data();
+            cap_ = begin_ + N;
+        }
+
+        /// @brief 元素在堆上时释放堆空间(元素需已析构或已搬走)
+        void free_heap() noexcept
+        {
+            if (!is_inline())
+                alloc_traits::deallocate(get_alloc(), begin_, capacity());
+        }
+
+        size_type get_new_cap(size_type add_size) const;
+
+        void fill_init(size_type n, const value_type &value);
+
+        template<typename IIter>
+        void range_init(IIter first, IIter last, input_iterator_tag);
+
+        template<typename FIter>
+        void range_init(FIter first, FIter last, forward_iterator_tag);
+
+        template<typename IIter>
+        void copy_assign(IIter first, IIter last, input_iterator_tag);
+
+        template<typename FIter>
+        void copy_assign(FIter first, FIter last, forward_iterator_tag);
+
+        template<typename... Args>
+        void reallocate_emplace(iterator pos, Args &&...args);
+
+        void reallocate_to(size_type new_cap);
+
+        iterator fill_insert(iterator pos, size_type n, const value_type &value);
+
+        template<typename IIter>
+        iterator copy_insert(iterator pos, IIter first, IIter last, input_iterator_tag);
+
+        template<typename FIter>
+        iterator copy_insert(iterator pos, FIter first, FIter last, forward_iterator_tag);
+
+        void move_from(small_vector &rhs);
+    };
+
+    /// ================================================================================================================
+    /// @brief 赋值运算符
+    /// ================================================================================================================
+
+    template<typename T, size_t N, typename Alloc>
+    small_vector<T, N, Alloc> &small_vector<T, N, Alloc>::operator=(const small_vector &rhs)
+    {
+        if (this != &rhs)
+        {
+            if (alloc_traits::propagate_on_container_copy_assignment::value &&
+                !mystl::alloc_equal(get_alloc(), rhs.get_alloc()))
+            {
+                // 旧空间必须用旧的分配器释放
+                clear();
+                free_heap();
+                reset_inline();
+            }
+            mystl::alloc_on_copy(get_alloc(), rhs.get_alloc());
+            copy_assign(rhs.begin_, rhs.end_, mystl::forward_iterator_tag());
+        }
+        return *this;
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    small_vector<T, N, Alloc> &small_vector<T, N, Alloc>::operator=(small_vector &&rhs)
+    {
+        if (this != &rhs)
+        {
+            clear();
+            const bool propagate = alloc_traits::propagate_on_container_move_assignment::value;
+            if (propagate && !mystl::alloc_equal(get_alloc(), rhs.get_alloc()))
+            {
+                // 分配器要被替换，旧的堆空间必须先用旧的分配器释放
+                free_heap();
+                reset_inline();
+            }
+            // 无论接管堆空间还是逐个搬移元素，POCMA 为 true 时都要传播分配器
+            mystl::alloc_on_move(get_alloc(), rhs.get_alloc());
+            if (!rhs.is_inline() && (propagate || mystl::alloc_equal(get_alloc(), rhs.get_alloc())))
+            {
+                free_heap();
+                begin_ = rhs.begin_;
+                end_ = rhs.end_;
+                cap_ = rhs.cap_;
+                rhs.reset_inline();
+            }
+            else
+            {
+                move_from(rhs);
+            }
+        }
+        return *this;
+    }
+
+    /// @brief 把 rhs 的元素逐个搬移过来(*this 已为空)，rhs 变为空
+    template<typename T, size_t N, typename Alloc>
+    void small_vector<T, N, Alloc>::move_from(small_vector &rhs)
+    {
+        reserve(rhs.size());
+        end_ = mystl::uninitialized_relocate(rhs.begin_, rhs.end_, begin_);
+        rhs.end_ = rhs.begin_;
+    }
+
+    /// ================================================================================================================
+    /// @brief 容量相关函数定义
+    /// ================================================================================================================
+
+    template<typename T, size_t N, typename Alloc>
+    void small_vector<T, N, Alloc>::reserve(size_type n)
+    {
+        if (capacity() < n)
+        {
+            THROW_LENGTH_ERROR_IF(n > max_size(), "n can not larger than max_size() in small_vector<T, N>::reserve(n)");
+            reallocate_to(n);
+        }
+    }
+
+    /// @brief 元素个数不超过 N 时搬回内部缓冲区，否则把堆空间缩小到 size()
+    template<typename T, size_t N, typename Alloc>
+    void small_vector<T, N, Alloc>::shrink_to_fit()
+    {
+        if (is_inline() || end_ == cap_) return;
+        if (size() <= N)
+        {
+            const auto old_begin = begin_;
+            const auto old_cap = capacity();
+            const auto new_end = mystl::uninitialized_relocate(begin_, end_, inline_data());
+            alloc_traits::deallocate(get_alloc(), old_begin, old_cap);
+            begin_ = inline_data();
+            end_ = new_end;
+            cap_ = begin_ + N;
+        }
+        else
+        {
+            reallocate_to(size());
+        }
+    }
+
+    /// ================================================================================================================
+    /// @brief 容器相关函数定义
+    /// ================================================================================================================
+
+    template<typename T, size_t N, typename Alloc>
+    template<typename... Args>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::emplace(const_iterator pos, Args &&...args)
+    {
+        MYSTL_DEBUG(pos >= begin() && pos <= end());
+        auto xpos = const_cast<iterator>(pos);
+        const size_type n = xpos - begin_;
+        if (end_ != cap_ && xpos == end_)
+        {
+            alloc_traits::construct(get_alloc(), mystl::address_of(*end_), mystl::forward<Args>(args)...);
+            ++end_;
+        }
+        else if (end_ != cap_)
+        {
+            // 先构造新元素，args 可能引用容器内的元素
+            value_type value_copy(mystl::forward<Args>(args)...);
+            alloc_traits::construct(get_alloc(), mystl::address_of(*end_), mystl::move(*(end_ - 1)));
+            ++end_;
+            mystl::move_backward(xpos, end_ - 2, end_ - 1);
+            *xpos = mystl::move(value_copy);
+        }
+        else
+        {
+            reallocate_emplace(xpos, mystl::forward<Args>(args)...);
+        }
+        return begin_ + n;
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::erase(const_iterator first, const_iterator last)
+    {
+        MYSTL_DEBUG(first >= begin() && last <= end() && !(last < first));
+        auto xfirst = const_cast<iterator>(first);
+        if (first != last)
+        {
+            auto new_end = mystl::move(const_cast<iterator>(last), end_, xfirst);
+            alloc_traits::destroy(get_alloc(), new_end, end_);
+            end_ = new_end;
+        }
+        return xfirst;
+    }
+
+    /// @brief 双方都在堆上时交换指针，否则借助一个临时对象逐个搬移
+    template<typename T, size_t N, typename Alloc>
+    void small_vector<T, N, Alloc>::swap(small_vector &rhs)
+    {
+        if (this == &rhs) return;
+        if (!is_inline() && !rhs.is_inline())
+        {
+            mystl::alloc_on_swap(get_alloc(), rhs.get_alloc());
+            mystl::swap(begin_, rhs.begin_);
+            mystl::swap(end_, rhs.end_);
+            mystl::swap(cap_, rhs.cap_);
+            return;
+        }
+        small_vector tmp(mystl::move(*this));
+        *this = mystl::move(rhs);
+        rhs = mystl::move(tmp);
+    }
+
+    /// ================================================================================================================
+    /// @brief helper function 定义
+    /// ================================================================================================================
+
+    /// @brief 按 1.5 倍增长，且至少能再放下 add_size 个元素
+    template<typename T, size_t N, typename Alloc>
+    typename small_vector<T, N, Alloc>::size_type small_vector<T, N, Alloc>::get_new_cap(size_type add_size) const
+    {
+        const auto old_cap = capacity();
+        THROW_LENGTH_ERROR_IF(size() > max_size() - add_size, "small_vector<T, N>'s size too big");
+        if (old_cap > max_size() - old_cap / 2)
+            return size() + add_size;
+        return mystl::max(old_cap + old_cap / 2, size() + add_size);
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    void small_vector<T, N, Alloc>::fill_init(size_type n, const value_type &value)
+    {
+        if (n > N)
+            reallocate_to(n);
+        try
+        {
+            end_ = mystl::uninitialized_fill_n(begin_, n, value);
+        }
+        catch (...)
+        {
+            free_heap();
+            throw;
+        }
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    template<typename IIter>
+    void small_vector<T, N, Alloc>::range_init(IIter first, IIter last, input_iterator_tag)
+    {
+        try
+        {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+        catch (...)
+        {
+            clear();
+            free_heap();
+            throw;
+        }
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    template<typename FIter>
+    void small_vector<T, N, Alloc>::range_init(FIter first, FIter last, forward_iterator_tag)
+    {
+        const size_type n = mystl::distance(first, last);
+        if (n > N)
+            reallocate_to(n);
+        try
+        {
+            end_ = mystl::uninitialized_copy(first, last, begin_);
+        }
+        catch (...)
+        {
+            free_heap();
+            throw;
+        }
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    template<typename IIter>
+    void small_vector<T, N, Alloc>::copy_assign(IIter first, IIter last, input_iterator_tag)
+    {
+        auto cur = begin_;
+        for (; first != last && cur != end_; ++first, ++cur)
+            *cur = *first;
+        if (first == last)
+            erase(cur, end_);
+        else
+            copy_insert(end_, first, last, input_iterator_tag());
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    template<typename FIter>
+    void small_vector<T, N, Alloc>::copy_assign(FIter first, FIter last, forward_iterator_tag)
+    {
+        const size_type len = mystl::distance(first, last);
+        if (len > capacity())
+        {
+            clear();
+            reallocate_to(len);
+            end_ = mystl::uninitialized_copy(first, last, begin_);
+        }
+        else if (len > size())
+        {
+            auto mid = first;
+            mystl::advance(mid, size());
+            mystl::copy(first, mid, begin_);
+            end_ = mystl::uninitialized_copy(mid, last, end_);
+        }
+        else
+        {
+            erase(mystl::copy(first, last, begin_), end_);
+        }
+    }
+
+    /**
+     * @brief 空间已满时在堆上分配新空间：先在新位置构造新元素，再把 [begin, pos) 和 [pos, end) 搬过去
+     * */
+
+    template<typename T, size_t N, typename Alloc>
+    template<typename... Args>
+    void small_vector<T, N, Alloc>::reallocate_emplace(iterator pos, Args &&...args)
+    {
+        const auto result = alloc_traits::allocate_at_least(get_alloc(), get_new_cap(1));
+        auto new_begin = result.ptr;
+        auto new_pos = new_begin + (pos - begin_);
+        auto new_end = new_begin;
+        int constructed = 0;
+        try
+        {
+            alloc_traits::construct(get_alloc(), new_pos, mystl::forward<Args>(args)...);
+            constructed = 1;
+            mystl::uninitialized_move(begin_, pos, new_begin);
+            constructed = 2;
+            new_end = mystl::uninitialized_move(pos, end_, new_pos + 1);
+        }
+        catch (...)
+        {
+            if (constructed == 2) alloc_traits::destroy(get_alloc(), new_begin, new_pos);
+            if (constructed >= 1) alloc_traits::destroy(get_alloc(), new_pos);
+            alloc_traits::deallocate(get_alloc(), new_begin, result.count);
+            throw;
+        }
+        alloc_traits::destroy(get_alloc(), begin_, end_);
+        free_heap();
+        begin_ = new_begin;
+        end_ = new_end;
+        cap_ = new_begin + result.count;
+    }
+
+    /// @brief 把全部元素搬到一块能容纳至少 new_cap 个元素的堆空间上
+    template<typename T, size_t N, typename Alloc>
+    void small_vector<T, N, Alloc>::reallocate_to(size_type new_cap)
+    {
+        const auto result = alloc_traits::allocate_at_least(get_alloc(), new_cap);
+        iterator new_end;
+        try
+        {
+            new_end = mystl::uninitialized_relocate(begin_, end_, result.ptr);
+        }
+        catch (...)
+        {
+            alloc_traits::deallocate(get_alloc(), result.ptr, result.count);
+            throw;
+        }
+        free_heap();
+        begin_ = result.ptr;
+        end_ = new_end;
+        cap_ = begin_ + result.count;
+    }
+
+    /// @brief fill_insert 在 pos 处插入 n 个 value
+    template<typename T, size_t N, typename Alloc>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::fill_insert(iterator pos, size_type n, const value_type &value)
+    {
+        const size_type xpos = pos - begin_;
+        if (n == 0) return pos;
+        const value_type value_copy = value;
+        if (static_cast<size_type>(cap_ - end_) >= n)
+        {
+            const size_type after_elems = end_ - pos;
+            auto old_end = end_;
+            if (after_elems > n)
+            {
+                end_ = mystl::uninitialized_move(end_ - n, end_, end_);
+                mystl::move_backward(pos, old_end - n, old_end);
+                mystl::fill_n(pos, n, value_copy);
+            }
+            else
+            {
+                end_ = mystl::uninitialized_fill_n(end_, n - after_elems, value_copy);
+                end_ = mystl::uninitialized_move(pos, old_end, end_);
+                mystl::fill_n(pos, after_elems, value_copy);
+            }
+        }
+        else
+        {
+            const auto result = alloc_traits::allocate_at_least(get_alloc(), get_new_cap(n));
+            auto new_begin = result.ptr;
+            auto new_pos = new_begin + xpos;
+            try
+            {
+                mystl::uninitialized_fill_n(new_pos, n, value_copy);
+            }
+            catch (...)
+            {
+                alloc_traits::deallocate(get_alloc(), new_begin, result.count);
+                throw;
+            }
+            // 元素移动构造抛出异常时只保证基本的异常安全
+            mystl::uninitialized_relocate(begin_, pos, new_begin);
+            auto new_end = mystl::uninitialized_relocate(pos, end_, new_pos + n);
+            free_heap();
+            begin_ = new_begin;
+            end_ = new_end;
+            cap_ = new_begin + result.count;
+        }
+        return begin_ + xpos;
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    template<typename IIter>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::copy_insert(iterator pos, IIter first, IIter last, input_iterator_tag)
+    {
+        const size_type xpos = pos - begin_;
+        for (auto cur = pos; first != last; ++first, ++cur)
+            cur = emplace(cur, *first);
+        return begin_ + xpos;
+    }
+
+    /// @brief copy_insert 在 pos 处插入 [first, last)
+    template<typename T, size_t N, typename Alloc>
+    template<typename FIter>
+    typename small_vector<T, N, Alloc>::iterator
+    small_vector<T, N, Alloc>::copy_insert(iterator pos, FIter first, FIter last, forward_iterator_tag)
+    {
+        const size_type xpos = pos - begin_;
+        const size_type n = mystl::distance(first, last);
+        if (n == 0) return pos;
+        if (static_cast<size_type>(cap_ - end_) >= n)
+        {
+            const size_type after_elems = end_ - pos;
+            auto old_end = end_;
+            if (after_elems > n)
+            {
+                end_ = mystl::uninitialized_move(end_ - n, end_, end_);
+                mystl::move_backward(pos, old_end - n, old_end);
+                mystl::copy(first, last, pos);
+            }
+            else
+            {
+                auto mid = first;
+                mystl::advance(mid, after_elems);
+                end_ = mystl::uninitialized_copy(mid, last, end_);
+                end_ = mystl::uninitialized_move(pos, old_end, end_);
+                mystl::copy(first, mid, pos);
+            }
+        }
+        else
+        {
+            const auto result = alloc_traits::allocate_at_least(get_alloc(), get_new_cap(n));
+            auto new_begin = result.ptr;
+            auto new_pos = new_begin + xpos;
+            try
+            {
+                mystl::uninitialized_copy(first, last, new_pos);
+            }
+            catch (...)
+            {
+                alloc_traits::deallocate(get_alloc(), new_begin, result.count);
+                throw;
+            }
+            mystl::uninitialized_relocate(begin_, pos, new_begin);
+            auto new_end = mystl::uninitialized_relocate(pos, end_, new_pos + n);
+            free_heap();
+            begin_ = new_begin;
+            end_ = new_end;
+            cap_ = new_begin + result.count;
+        }
+        return begin_ + xpos;
+    }
+
+    /// ================================================================================================================
+    /// @brief 重载比较操作符
+    /// ================================================================================================================
+
+    template<typename T, size_t N, typename Alloc>
+    bool operator==(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs)
+    {
+        return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    bool operator!=(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    bool operator<(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs)
+    {
+        return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    bool operator>(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs)
+    {
+        return rhs < lhs;
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    bool operator<=(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs)
+    {
+        return !(rhs < lhs);
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    bool operator>=(const small_vector<T, N, Alloc> &lhs, const small_vector<T, N, Alloc> &rhs)
+    {
+        return !(lhs < rhs);
+    }
+
+    template<typename T, size_t N, typename Alloc>
+    void swap(small_vector<T, N, Alloc> &lhs, small_vector<T, N, Alloc> &rhs)
+    {
+        lhs.swap(rhs);
+    }
+
+}
+
+#endif //MYSTL_SMALL_VECTOR_H
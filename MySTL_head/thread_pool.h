@@ -0,0 +1,318 @@
+/**
+ * @file thread_pool.h
+ * @brief 工作窃取(work-stealing)线程池 thread_pool 以及 fork-join 用的 task_group
+ */
+
+#ifndef MYSTL_THREAD_POOL_H
+#define MYSTL_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "deque.h"
+#include "vector.h"
+#include "util.h"
+
+namespace mystl
+{
+    /// ================================================================================================================
+    /// @brief thread_pool
+    /// ================================================================================================================
+
+    /**
+     * @brief 每个工作线程有自己的任务队列：本线程提交的任务压入自己队列的尾部并从尾部取出(LIFO，缓存友好)，
+     * @brief 自己的队列为空时从其它队列的头部窃取(FIFO，偷到的通常是较大的任务)
+     * @note 非工作线程提交的任务轮流放入各个队列
+     * @note 等待任务完成的线程(见 task_group::wait)也会执行队列中的任务，所以工作线程数为 0 的线程池同样可用：
+     * @note 全部任务都由等待者自己执行
+     * @note 直接 submit 的任务不能抛出异常，需要传播异常时使用 task_group
+     * */
+
+    class thread_pool
+    {
+    public:
+        typedef std::function<void()> task_type;
+
+    private:
+        struct worker_queue
+        {
+            std::mutex mutex;
+            mystl::deque<task_type> tasks;
+        };
+
+        /// @brief 当前线程所属的线程池及其队列下标，非工作线程的 pool 为 nullptr
+        struct worker_context
+        {
+            const thread_pool *pool;
+            size_t index;
+        };
+
+        mystl::vector<std::thread> threads_;
+        std::unique_ptr<worker_queue[]> queues_;
+        size_t queue_count_;                   // 至少为 1，工作线程数为 0 时任务放在唯一的队列中
+        std::atomic<size_t> pending_;          // 已入队但还未被取走的任务数
+        std::atomic<size_t> next_queue_;       // 非工作线程提交时轮流选择队列
+        std::mutex sleep_mutex_;
+        std::condition_variable sleep_cv_;
+        bool stop_;
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 构造/析构函数
+        /// ------------------------------------------------------------------------------------------------------------
+
+        /// @param[in] threads 工作线程数
+        explicit thread_pool(size_t threads)
+                : queues_(new worker_queue[threads == 0 ? 1 : threads]), queue_count_(threads == 0 ? 1 : threads),
+                  pending_(0), next_queue_(0), stop_(false)
+        {
+            threads_.reserve(threads);
+            try
+            {
+                for (size_t i = 0; i < threads; ++i)
+                    threads_.emplace_back([this, i] { worker_loop(i); });
+            }
+            catch (...)
+            {
+                shutdown();
+                throw;
+            }
+        }
+
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        /// @brief 通知工作线程退出并等待它们结束，尚未执行的任务被丢弃
+        ~thread_pool()
+        {
+            shutdown();
+        }
+
+    public:
+        /// ------------------------------------------------------------------------------------------------------------
+        /// @brief 提交与执行任务
+        /// ------------------------------------------------------------------------------------------------------------
+
+        void submit(task_type task);
+
+        bool run_pending_task();
+
+        /// @brief 工作线程数
+        size_t size() const noexcept { return threads_.size(); }
+
+        /// @brief 可以同时执行任务的线程数：工作线程加上一个等待中的调用者
+        size_t concurrency() const noexcept { return threads_.size() + 1; }
+
+        /**
+         * @brief 并行算法默认使用的线程池，第一次使用时创建，工作线程数为 hardware_concurrency() - 1
+         * @note 调用线程在等待时也执行任务，合计正好占满所有硬件线程
+         * */
+        static thread_pool &default_pool()
+        {
+            static thread_pool pool(std::thread::hardware_concurrency() > 1
+                                    ? std::thread::hardware_concurrency() - 1 : 0);
+            return pool;
+        }
+
+    private:
+        static worker_context &current() noexcept
+        {
+            static thread_local worker_context context{nullptr, 0};
+            return context;
+        }
+
+        bool try_pop(size_t self, task_type &task);
+
+        void worker_loop(size_t index);
+
+        void shutdown() noexcept;
+    };
+
+    /**
+     * @brief 工作线程提交的任务放进自己的队列，其它线程提交的任务轮流放入各个队列
+     * @note 先增加 pending_ 再在 sleep_mutex_ 下通知，与 worker_loop 中的等待条件配合不会丢失唤醒
+     * */
+    inline void thread_pool::submit(task_type task)
+    {
+        const worker_context &ctx = current();
+        const size_t index = ctx.pool == this ? ctx.index : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                                                            queue_count_;
+        {
+            std::lock_guard<std::mutex> lock(queues_[index].mutex);
+            queues_[index].tasks.push_back(mystl::move(task));
+        }
+        pending_.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        sleep_cv_.notify_one();
+    }
+
+    /**
+     * @brief 在当前线程执行一个排队中的任务
+     * @return 没有可执行的任务时返回 false
+     * */
+    inline bool thread_pool::run_pending_task()
+    {
+        const worker_context &ctx = current();
+        task_type task;
+        if (!try_pop(ctx.pool == this ? ctx.index : queue_count_, task))
+            return false;
+        task();
+        return true;
+    }
+
+    /// @param[in] self 当前线程自己的队列下标，不是本线程池的工作线程时为 queue_count_
+    inline bool thread_pool::try_pop(size_t self, task_type &task)
+    {
+        if (pending_.load(std::memory_order_acquire) == 0)
+            return false;
+        if (self < queue_count_)
+        {
+            worker_queue &q = queues_[self];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty())
+            {
+                task = mystl::move(q.tasks.back());
+                q.tasks.pop_back();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        // 从自己的下一个队列开始窃取，避免所有线程都去抢第一个队列
+        const size_t start = self < queue_count_ ? self + 1 : 0;
+        for (size_t i = 0; i < queue_count_; ++i)
+        {
+            worker_queue &q = queues_[(start + i) % queue_count_];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty())
+            {
+                task = mystl::move(q.tasks.front());
+                q.tasks.pop_front();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline void thread_pool::worker_loop(size_t index)
+    {
+        current() = worker_context{this, index};
+        task_type task;
+        while (true)
+        {
+            if (try_pop(index, task))
+            {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleep_cv_.wait(lock, [this] { return stop_ || pending_.load(std::memory_order_acquire) != 0; });
+            if (stop_) return;
+        }
+    }
+
+    inline void thread_pool::shutdown() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (auto &t: threads_)
+        {
+            if (t.joinable())
+                t.join();
+        }
+    }
+
+    /// ================================================================================================================
+    /// @brief task_group
+    /// ================================================================================================================
+
+    /**
+     * @brief 一组 fork-join 任务：run 提交任务，wait 等待全部完成(包括任务中再 run 的任务)
+     * @note 等待期间调用线程执行池中的任务而不是阻塞，因此任务内部可以嵌套使用 task_group
+     * @note 任务抛出的第一个异常在 wait 中重新抛出；析构时等待尚未完成的任务但不抛出异常
+     * */
+
+    class task_group
+    {
+    private:
+        thread_pool &pool_;
+        std::atomic<size_t> pending_;
+        std::mutex error_mutex_;
+        std::exception_ptr error_;
+
+    public:
+        explicit task_group(thread_pool &pool) noexcept: pool_(pool), pending_(0) {}
+
+        task_group(const task_group &) = delete;
+
+        task_group &operator=(const task_group &) = delete;
+
+        ~task_group()
+        {
+            join();
+        }
+
+        template<typename Function>
+        void run(Function f)
+        {
+            pending_.fetch_add(1, std::memory_order_relaxed);
+            try
+            {
+                pool_.submit([this, f]() mutable
+                             {
+                                 try
+                                 {
+                                     f();
+                                 }
+                                 catch (...)
+                                 {
+                                     std::lock_guard<std::mutex> lock(error_mutex_);
+                                     if (!error_) error_ = std::current_exception();
+                                 }
+                                 pending_.fetch_sub(1, std::memory_order_release);
+                             });
+            }
+            catch (...)
+            {
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                throw;
+            }
+        }
+
+        void wait()
+        {
+            join();
+            if (error_)
+            {
+                std::exception_ptr e = error_;
+                error_ = nullptr;
+                std::rethrow_exception(e);
+            }
+        }
+
+    private:
+        void join() noexcept
+        {
+            while (pending_.load(std::memory_order_acquire) != 0)
+            {
+                if (!pool_.run_pending_task())
+                    std::this_thread::yield();
+            }
+        }
+    };
+}
+
+#endif //MYSTL_THREAD_POOL_H
@@ -43,6 +43,36 @@ namespace mystl
     /// @brief false->static constexpr bool value = false;
     typedef m_bool_constant<false> m_false_type;
 
+    /// ================================================================================================================
+    /// @brief mystl::void_t
+    /// ================================================================================================================
+
+    /**
+     * @brief 将任意类型序列映射为void，配合偏特化检测某个类型/表达式是否合法(C++14 中没有std::void_t)
+     * */
+
+    template<typename... Ts>
+    struct make_void
+    {
+        typedef void type;
+    };
+
+    template<typename... Ts>
+    using void_t = typename make_void<Ts...>::type;
+
+    /// ================================================================================================================
+    /// @brief mystl::is_trivially_relocatable
+    /// ================================================================================================================
+
+    /**
+     * @brief 判断类型能否"重定位"：把对象按字节复制到新地址后直接丢弃原对象，等价于移动构造 + 析构原对象
+     * @note 默认只有平凡可复制的类型满足；只持有指针、不引用自身地址的类型(如 unique_ptr 式句柄、mystl::vector)
+     *       可以特化为 std::true_type 主动声明，容器搬移这类元素时就可以用 memcpy/memmove 代替逐个移动
+     * */
+
+    template<typename T>
+    struct is_trivially_relocatable : public std::is_trivially_copyable<T> {};
+
     /// ================================================================================================================
     /// @brief mystl::pair
     /// ================================================================================================================
@@ -58,6 +88,14 @@ namespace mystl
     template <typename T1, typename T2>
     struct is_pair<mystl::pair<T1, T2>> : mystl::m_true_type {};
 
+    /// @brief 两个成员都可以重定位时，pair 也可以重定位
+    template<typename T1, typename T2>
+    struct is_trivially_relocatable<mystl::pair<T1, T2>>
+            : public std::integral_constant<bool, is_trivially_relocatable<T1>::value &&
+                                                  is_trivially_relocatable<T2>::value>
+    {
+    };
+
 }
 
 #endif //MYSTL_TYPE_TRAITS_H
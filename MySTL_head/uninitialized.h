@@ -13,6 +13,8 @@
 #ifndef MYSTL_UNINITIALIZED_H
 #define MYSTL_UNINITIALIZED_H
 
+#include <cstring>
+
 #include "algobase.h"
 #include "construct.h"
 #include "iterator.h"
@@ -48,6 +50,7 @@ namespace mystl
             {
                 mystl::destroy(&*first);
             }
+            throw;
         }
     }
 
@@ -88,6 +91,7 @@ namespace mystl
             {
                 mystl::destroy(&*first);
             }
+            throw;
         }
         return cur;
     }
@@ -122,10 +126,11 @@ namespace mystl
         }
         catch (...)
         {
-            for (; cur != result; --cur)
+            for (; result != cur; ++result)
             {
-                mystl::destroy(&*cur);
+                mystl::destroy(&*result);
             }
+            throw;
         }
         return cur;
     }
@@ -167,10 +172,11 @@ namespace mystl
         }
         catch (...)
         {
-            for (; result != cur; --cur)
+            for (; result != cur; ++result)
             {
-                mystl::destroy(&*cur);
+                mystl::destroy(&*result);
             }
+            throw;
         }
         return cur;
     }
@@ -211,6 +217,7 @@ namespace mystl
         catch (...)
         {
             mystl::destroy(result, cur);
+            throw;
         }
         return cur;
     }
@@ -227,6 +234,100 @@ namespace mystl
                                             std::is_trivially_move_assignable<typename iterator_traits<InputIter>::value_type>{});
     }
 
+
+    /// ================================================================================================================
+    /// @brief uninitialized_relocate
+    /// ================================================================================================================
+
+    /**
+     * @brief 重定位 = 在新位置移动构造 + 析构原对象。源和目标都是同一类型的指针且元素可以重定位时，
+     * @brief 两步合并成一次 memmove，否则退化为 uninitialized_move 再析构源区间
+     * */
+
+    template<typename InputIter, typename ForwardIter>
+    struct is_memmove_relocatable : public std::false_type {};
+
+    template<typename T>
+    struct is_memmove_relocatable<T *, T *> : public mystl::is_trivially_relocatable<T> {};
+
+    template<typename T>
+    T *unchecked_uninit_relocate(T *first, T *last, T *result, std::true_type) noexcept
+    {
+        const auto n = static_cast<size_t>(last - first);
+        if (n != 0)
+            std::memmove(static_cast<void *>(result), static_cast<const void *>(first), n * sizeof(T));
+        return result + n;
+    }
+
+    template<typename InputIter, typename ForwardIter>
+    ForwardIter unchecked_uninit_relocate(InputIter first, InputIter last, ForwardIter result, std::false_type)
+    {
+        auto cur = mystl::uninitialized_move(first, last, result);
+        mystl::destroy(first, last);
+        return cur;
+    }
+
+    /**
+     * @brief uninitialized_relocate
+     * @brief 把 [first, last) 上的对象重定位到以 result 为起始处的未初始化空间，之后源区间视为未初始化，返回结束位置
+     * @note 目标区间不能与源区间重叠，重叠时使用 relocate_n
+     * */
+
+    template<typename InputIter, typename ForwardIter>
+    ForwardIter uninitialized_relocate(InputIter first, InputIter last, ForwardIter result)
+    {
+        return mystl::unchecked_uninit_relocate(first, last, result,
+                                                is_memmove_relocatable<InputIter, ForwardIter>{});
+    }
+
+    /// ================================================================================================================
+    /// @brief relocate_n
+    /// ================================================================================================================
+
+    template<typename T, typename Size>
+    T *unchecked_relocate_n(T *first, Size n, T *result, std::true_type) noexcept
+    {
+        if (n != 0)
+            std::memmove(static_cast<void *>(result), static_cast<const void *>(first), n * sizeof(T));
+        return result + n;
+    }
+
+    template<typename T, typename Size>
+    T *unchecked_relocate_n(T *first, Size n, T *result, std::false_type)
+    {
+        if (result <= first || result >= first + n)
+        {
+            // 目标在前或不重叠，从前往后搬
+            for (Size i = 0; i < n; ++i)
+            {
+                mystl::construct(result + i, mystl::move(first[i]));
+                mystl::destroy(first + i);
+            }
+        }
+        else
+        {
+            // 目标在后且重叠，从后往前搬
+            for (Size i = n; i > 0; --i)
+            {
+                mystl::construct(result + i - 1, mystl::move(first[i - 1]));
+                mystl::destroy(first + i - 1);
+            }
+        }
+        return result + n;
+    }
+
+    /**
+     * @brief relocate_n
+     * @brief 把 first 开始的 n 个对象重定位到 result 开始的位置，两个区间可以重叠(类似 memmove)，返回 result + n
+     * @note 不能重定位的类型逐个移动构造再析构，此时要求移动构造不抛出异常
+     * */
+
+    template<typename T, typename Size>
+    T *relocate_n(T *first, Size n, T *result)
+    {
+        return mystl::unchecked_relocate_n(first, n, result, mystl::is_trivially_relocatable<T>{});
+    }
+
 }
 
 #endif //MYSTL_UNINITIALIZED_H
@@ -13,10 +13,14 @@
 #ifndef MYSTL_VECTOR_H
 #define MYSTL_VECTOR_H
 
+#include <cstring>
+
 #include "allocator.h"
+#include "allocator_traits.h"
 #include "algobase.h"
 #include "uninitialized.h"
 #include "exceptdef.h"
+#include "growth_policy.h"
 #include "memory.h"
 #include "algo.h"
 
@@ -31,28 +35,39 @@ namespace mystl
 #undef min
 #endif
 
-    template<typename T>
-    class vector
+    template<typename T, typename Alloc = mystl::allocator<T>, typename Growth = mystl::default_growth>
+    class vector : private mystl::alloc_holder<Alloc>
     {
+        static_assert(std::is_same<T, typename Alloc::value_type>::value,
+                      "the value_type of Alloc must be the same as T in vector<T, Alloc>");
+
+        typedef mystl::alloc_holder<Alloc> holder_type;
+
+        /// @brief 元素可以重定位时，扩容和插入/删除时的搬移都按字节进行，扩容还会尝试原地扩展
+        typedef typename mystl::is_trivially_relocatable<T>::type trivially_relocatable;
+
     public:
-        typedef mystl::allocator<T> allocator_type;
-        typedef mystl::allocator<T> data_allocator;
-        typedef typename allocator_type::value_type value_type;
-        typedef typename allocator_type::pointer pointer;
-        typedef typename allocator_type::const_pointer const_pointer;
-        typedef typename allocator_type::reference reference;
-        typedef typename allocator_type::const_reference const_reference;
-        typedef typename allocator_type::size_type size_type;
-        typedef typename allocator_type::difference_type difference_type;
+        typedef Alloc allocator_type;
+        typedef mystl::allocator_traits<Alloc> alloc_traits;
+        typedef Growth growth_policy;
+        typedef T value_type;
+        typedef value_type *pointer;
+        typedef const value_type *const_pointer;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef typename alloc_traits::size_type size_type;
+        typedef typename alloc_traits::difference_type difference_type;
 
         typedef value_type *iterator;
         typedef const value_type *const_iterator;
         typedef mystl::reverse_iterator<iterator> reverse_iterator;
         typedef mystl::reverse_iterator<const_iterator> const_reverse_iterator;
 
-        allocator_type get_allocator() { return data_allocator(); }
+        allocator_type get_allocator() const { return get_alloc(); }
 
     private:
+        using holder_type::get_alloc;
+
         iterator begin_;
         iterator end_;
         iterator cap_;
@@ -61,43 +76,74 @@ namespace mystl
         /// ------------------------------------------------------------------------------------------------------------
         /// @brief 构造函数
         /// ------------------------------------------------------------------------------------------------------------
-        ///@brief 默认构造函数
-        vector() noexcept
+        ///@brief 默认构造函数：不分配空间，第一次插入元素时才按增长策略分配
+        vector() noexcept: begin_(nullptr), end_(nullptr), cap_(nullptr)
+        {
+        }
+
+        explicit vector(const allocator_type &alloc) noexcept: holder_type(alloc), begin_(nullptr), end_(nullptr),
+                                                               cap_(nullptr)
         {
-            try_init();
         }
 
         ///@brief 有参构造函数
-        explicit vector(size_type n)
+        explicit vector(size_type n, const allocator_type &alloc = allocator_type()) : holder_type(alloc)
         {
             fill_init(n, value_type());
         }
 
-        vector(size_type n, const value_type &value)
+        vector(size_type n, const value_type &value, const allocator_type &alloc = allocator_type())
+                : holder_type(alloc)
         {
             fill_init(n, value);
         }
 
         template<typename Iter, typename std::enable_if<mystl::is_input_iterator<Iter>::value, int>::type = 0>
-        vector(Iter first, Iter last)
+        vector(Iter first, Iter last, const allocator_type &alloc = allocator_type()) : holder_type(alloc)
+        {
+            range_init(first, last);
+        }
+
+        vector(const vector &lhs) : holder_type(alloc_traits::select_on_container_copy_construction(lhs.get_alloc()))
         {
-            MYSTL_DEBUG(first >= last);
-            range_init();
+            range_init(lhs.begin_, lhs.end_);
         }
 
-        vector(const vector &lhs)
+        vector(const vector &lhs, const allocator_type &alloc) : holder_type(alloc)
         {
             range_init(lhs.begin_, lhs.end_);
         }
 
-        vector(vector &&rhs) noexcept: begin_(rhs.begin_), end_(rhs.end_), cap_(rhs.cap_)
+        vector(vector &&rhs) noexcept: holder_type(mystl::move(rhs.get_alloc())),
+                                       begin_(rhs.begin_), end_(rhs.end_), cap_(rhs.cap_)
         {
             rhs.begin_ = nullptr;
             rhs.end_ = nullptr;
             rhs.cap_ = nullptr;
         }
 
-        vector(std::initializer_list<value_type> ilist)
+        /// @brief 分配器不相等时不能接管 rhs 的空间，只能逐个移动元素
+        vector(vector &&rhs, const allocator_type &alloc) : holder_type(alloc)
+        {
+            if (mystl::alloc_equal(get_alloc(), rhs.get_alloc()))
+            {
+                begin_ = rhs.begin_;
+                end_ = rhs.end_;
+                cap_ = rhs.cap_;
+                rhs.begin_ = nullptr;
+                rhs.end_ = nullptr;
+                rhs.cap_ = nullptr;
+            }
+            else
+            {
+                const size_type len = rhs.size();
+                init_space(len, len);
+                mystl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+            }
+        }
+
+        vector(std::initializer_list<value_type> ilist, const allocator_type &alloc = allocator_type())
+                : holder_type(alloc)
         {
             range_init(ilist.begin(), ilist.end());
         }
@@ -106,9 +152,10 @@ namespace mystl
         /// @brief 赋值运算符重载
         /// ------------------------------------------------------------------------------------------------------------
 
-        vector &operator=(const vector<T> &lhs);
+        vector &operator=(const vector &lhs);
 
-        vector &operator=(vector<T> &&rhs) noexcept;
+        vector &operator=(vector &&rhs) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                                 alloc_traits::is_always_equal::value);
 
         vector &operator=(std::initializer_list<value_type> ilist);
 
@@ -201,7 +248,7 @@ namespace mystl
         /// @brief  max_size函数，用于获取vector可容纳元素的最大数量
         size_type max_size() const noexcept
         {
-            return static_cast<size_type>(-1) / sizeof(T);
+            return alloc_traits::max_size(get_alloc());
         }
 
         size_type capacity() const noexcept
@@ -324,7 +371,7 @@ namespace mystl
         void pop_back()
         {
             MYSTL_DEBUG(!empty());
-            data_allocator::destroy(end_ - 1);
+            alloc_traits::destroy(get_alloc(), end_ - 1);
             --end_;
         }
 
@@ -385,7 +432,7 @@ namespace mystl
         /// @brief swap
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-        void swap(vector<T> &lhs) noexcept;
+        void swap(vector &lhs) noexcept;
 
     private:
         /// ------------------------------------------------------------------------------------------------------------
@@ -396,8 +443,6 @@ namespace mystl
         /// @brief 初始化/回收函数
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-        void try_init();
-
         void init_space(size_type size, size_type cap);
 
         void fill_init(size_type n, const value_type &value);
@@ -432,50 +477,86 @@ namespace mystl
         template<class... Args>
         void reallocate_emplace(iterator pos, Args &&...args);
 
-        void reallocate_insert(iterator pos, const value_type &value);
+        void grow_storage(size_type new_cap, std::true_type);
+
+        void grow_storage(size_type new_cap, std::false_type);
+
+        void relocate_storage(size_type new_cap, std::true_type);
+
+        void relocate_storage(size_type new_cap, std::false_type);
 
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
         /// @brief insert
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
+        template<class... Args>
+        void insert_aux(std::true_type, iterator pos, Args &&...args);
+
+        template<class... Args>
+        void insert_aux(std::false_type, iterator pos, Args &&...args);
+
         iterator fill_insert(iterator pos, size_type n, const value_type &value);
 
+        iterator fill_insert_aux(iterator pos, size_type n, const value_type &value, std::true_type);
+
+        iterator fill_insert_aux(iterator pos, size_type n, const value_type &value, std::false_type);
+
         template<typename IIter>
         void copy_insert(iterator pos, IIter first, IIter last);
 
+        template<typename IIter>
+        void copy_insert_aux(iterator pos, IIter first, IIter last, std::true_type);
+
+        template<typename IIter>
+        void copy_insert_aux(iterator pos, IIter first, IIter last, std::false_type);
+
+        iterator open_gap(iterator pos, size_type n);
+
+        void close_gap(iterator pos, size_type n) noexcept;
+
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief erase
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        iterator erase_aux(iterator first, iterator last, std::true_type);
+
+        iterator erase_aux(iterator first, iterator last, std::false_type);
+
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
         /// @brief shrink_to_fit函数
         /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
         void reinsert(size_type size);
 
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        /// @brief 移动赋值辅助函数
+        /// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        void move_assign(vector &rhs, std::true_type) noexcept;
+
+        void move_assign(vector &rhs, std::false_type);
+
     };
 
     /// ================================================================================================================
     /// @brief 容量相关函数定义
     /// ================================================================================================================
 
-    template<typename T>
-    void vector<T>::reserve(size_type n)
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::reserve(size_type n)
     {
         if (capacity() < n)
         {
             // size n 不能超过max_size()
             THROW_LENGTH_ERROR_IF(n > max_size(), "n can not larger than max_size() in vector<T>::reserve(n)");
-            const auto old_size = size();
-            auto tmp = data_allocator::allocate(n);
-            mystl::uninitialized_move(begin_, end_, tmp);
-            data_allocator::deallocate(begin_, cap_ - begin_);
-            begin_ = tmp;
-            end_ = begin_ + old_size;
-            cap_ = begin_ + n;
+            grow_storage(n, trivially_relocatable());
         }
     }
 
     /// @brief 放弃多余的容量
 
-    template<typename T>
-    void vector<T>::shrink_to_fit()
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::shrink_to_fit()
     {
         if (end_ < cap_)
         {
@@ -489,9 +570,9 @@ namespace mystl
 
     /// @brief emplace/emplace_back 原地构造元素
 
-    template<typename T>
+    template<typename T, typename Alloc, typename Growth>
     template<typename ...Args>
-    typename vector<T>::iterator vector<T>::emplace(const_iterator pos, Args &&...args)
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::emplace(const_iterator pos, Args &&...args)
     {
         MYSTL_DEBUG(pos >= begin() && pos <= end());
         // xpos表示待插入位置
@@ -500,119 +581,110 @@ namespace mystl
         if (end_ != cap_ && xpos == end_)
         {
             // 当空间未满且插入元素在尾部时, 直接在尾部调用construct
-            data_allocator::construct(mystl::address_of(*end_), mystl::forward<Args>(args)...);
+            alloc_traits::construct(get_alloc(), mystl::address_of(*end_), mystl::forward<Args>(args)...);
             ++end_;
         }
-        else if (end_ != cap_)
-        {
-            // 当空间未满且插入元素不在尾部时
-            auto new_end = end_;
-            // 首先在尾部构造一个副本，然后逆序依次拷贝
-            data_allocator::construct(mystl::address_of(*end_), *(end_ - 1));
-            ++new_end;
-            mystl::copy_backward(xpos, end_ - 1, end_);
-            // 最后在xpos处赋新值
-            *xpos = value_type(mystl::forward<Args>(args)...);
-            end_ = new_end;
-        }
         else
         {
-            // 如果空间已满，重新分配空间
-            reallocate_emplace(xpos, mystl::forward<Args>(args)...);
+            insert_aux(trivially_relocatable(), xpos, mystl::forward<Args>(args)...);
         }
         return begin() + n;
     }
 
-    template<typename T>
+    template<typename T, typename Alloc, typename Growth>
     template<typename... Args>
-    void vector<T>::emplace_back(Args &&...args)
+    void vector<T, Alloc, Growth>::emplace_back(Args &&...args)
     {
         if (end_ < cap_)
         {
-            data_allocator::construct(mystl::address_of(*end_), mystl::forward<Args>(args)...);
+            alloc_traits::construct(get_alloc(), mystl::address_of(*end_), mystl::forward<Args>(args)...);
             ++end_;
         }
         else
         {
-            reallocate_emplace(end_, mystl::forward<Args>(args)...);
+            insert_aux(trivially_relocatable(), end_, mystl::forward<Args>(args)...);
         }
     }
 
     /// @brief push_back/pop_back
 
-    template<typename T>
-    void vector<T>::push_back(const value_type &value)
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::push_back(const value_type &value)
     {
         if (end_ != cap_)
         {
-            data_allocator::construct(mystl::address_of(*end_), value);
+            alloc_traits::construct(get_alloc(), mystl::address_of(*end_), value);
             ++end_;
         }
         else
         {
-            reallocate_insert(end_, value);
+            insert_aux(trivially_relocatable(), end_, value);
         }
     }
 
     /// @brief insert
 
-    template<typename T>
-    typename vector<T>::iterator vector<T>::insert(const_iterator pos, const value_type &value)
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(const_iterator pos, const value_type &value)
     {
         MYSTL_DEBUG(pos >= begin() && pos <= end());
         auto xpos = const_cast<iterator>(pos);
         const size_type n = pos - begin_;
         if (end_ != cap_ && xpos == end_)
         {
-            data_allocator::construct(mystl::address_of(*end_), value);
+            alloc_traits::construct(get_alloc(), mystl::address_of(*end_), value);
             ++end_;
         }
-        else if (end_ != cap_)
-        {
-            auto new_end = end_;
-            data_allocator::construct(mystl::address_of(*end_), *(end_ - 1));
-            ++new_end;
-            auto value_copy = value;
-            mystl::copy_backward(xpos, end_ - 1, end_);
-            *xpos = mystl::move(value_copy);
-            end_ = new_end;
-        }
         else
         {
-            reallocate_insert(xpos, value);
+            insert_aux(trivially_relocatable(), xpos, value);
         }
         return begin_ + n;
     }
 
     /// @brief erase
 
-    template<typename T>
-    typename vector<T>::iterator vector<T>::erase(const_iterator pos)
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(const_iterator pos)
     {
         MYSTL_DEBUG(pos >= begin() && pos < end());
         iterator xpos = begin_ + (pos - begin());
-        // 从后往前覆盖
-        mystl::move(xpos + 1, end_, xpos);
-        data_allocator::destroy(end_ - 1);
-        --end_;
-        return xpos;
+        return erase_aux(xpos, xpos + 1, trivially_relocatable());
     }
 
-    template<typename T>
-    typename vector<T>::iterator vector<T>::erase(const_iterator first, const_iterator last)
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(const_iterator first, const_iterator last)
     {
         MYSTL_DEBUG(first >= begin() && last <= end() && !(last < first));
-        const auto n = first - begin();
         iterator r = begin_ + (first - begin());
-        data_allocator::destroy(mystl::move(r + (last - first), end_, r), end_);
+        return erase_aux(r, r + (last - first), trivially_relocatable());
+    }
+
+    /// @brief 可以重定位的元素：先析构被删除的元素，再把后面的元素整体前移(memmove)
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase_aux(iterator first, iterator last, std::true_type)
+    {
+        if (first == last) return first;
+        alloc_traits::destroy(get_alloc(), first, last);
+        mystl::relocate_n(last, end_ - last, first);
+        end_ -= last - first;
+        return first;
+    }
+
+    /// @brief 一般的元素：把后面的元素移动赋值到前面，再析构尾部多余的元素
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase_aux(iterator first, iterator last, std::false_type)
+    {
+        if (first == last) return first;
+        alloc_traits::destroy(get_alloc(), mystl::move(last, end_, first), end_);
         end_ = end_ - (last - first);
-        return begin_ + n;
+        return first;
     }
 
     /// @brief resize
 
-    template<typename T>
-    void vector<T>::resize(size_type new_size, const value_type &value)
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::resize(size_type new_size, const value_type &value)
     {
         if (new_size < size())
         {
@@ -625,11 +697,12 @@ namespace mystl
     }
 
     /// @brief swap
-    template<typename T>
-    void vector<T>::swap(vector<T> &lhs) noexcept
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::swap(vector &lhs) noexcept
     {
         if (this != &lhs)
         {
+            mystl::alloc_on_swap(get_alloc(), lhs.get_alloc());
             mystl::swap(begin_, lhs.begin_);
             mystl::swap(end_, lhs.end_);
             mystl::swap(cap_, lhs.cap_);
@@ -641,38 +714,24 @@ namespace mystl
     /// ================================================================================================================
 
     /**
-     * @brief 初始化 分配16个大小的空间
+     * @brief 调整初始化空间大小
+     * @param[in] size 已初始化
+     * @param[in] cap 已分配，为 0 时不分配空间
      * */
 
-    template<typename T>
-    void vector<T>::try_init()
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::init_space(size_type size, size_type cap)
     {
-        try
-        {
-            begin_ = data_allocator::allocate(16);
-            end_ = begin_;
-            cap_ = begin_ + 16;
-        }
-        catch (...)
+        if (cap == 0)
         {
             begin_ = nullptr;
             end_ = nullptr;
             cap_ = nullptr;
+            return;
         }
-    }
-
-    /**
-     * @brief 调整初始化空间大小
-     * @param[in] size 已初始化
-     * @param[in] cap 已分配
-     * */
-
-    template<typename T>
-    void vector<T>::init_space(size_type size, size_type cap)
-    {
         try
         {
-            begin_ = data_allocator::allocate(cap);
+            begin_ = alloc_traits::allocate(get_alloc(), cap);
             end_ = begin_ + size;
             cap_ = begin_ + cap;
         }
@@ -685,61 +744,61 @@ namespace mystl
         }
     }
 
-    template<typename T>
-    void vector<T>::fill_init(size_type n, const value_type &value)
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::fill_init(size_type n, const value_type &value)
     {
-        const size_type init_size = mystl::max(static_cast<size_type>(16), n);
-        // 空间分配，且保证cap至少为16
-        init_space(n, init_size);
+        THROW_LENGTH_ERROR_IF(n > max_size(), "vector<T>'s size too big");
+        // 空间分配，容量由增长策略决定(默认至少为16)；空的 vector 不分配
+        init_space(n, n == 0 ? 0 : Growth::initial_capacity(n, sizeof(T), max_size()));
         // 填充value
         mystl::uninitialized_fill_n(begin_, n, value);
     }
 
-    template<typename T>
+    template<typename T, typename Alloc, typename Growth>
     template<typename Iter>
-    void vector<T>::range_init(Iter first, Iter last)
+    void vector<T, Alloc, Growth>::range_init(Iter first, Iter last)
     {
         const size_type len = mystl::distance(first, last);
-        const size_type init_size = mystl::max(len, static_cast<size_type>(16));
-        init_space(len, init_size);
+        THROW_LENGTH_ERROR_IF(len > max_size(), "vector<T>'s size too big");
+        init_space(len, len == 0 ? 0 : Growth::initial_capacity(len, sizeof(T), max_size()));
         mystl::uninitialized_copy(first, last, begin_);
     }
 
-    template<typename T>
-    void vector<T>::destroy_and_recover(iterator first, iterator last, size_type n)
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::destroy_and_recover(iterator first, iterator last, size_type n)
     {
-        data_allocator::destroy(first, last);
-        data_allocator::deallocate(first, n);
+        if (first == nullptr) return;
+        alloc_traits::destroy(get_alloc(), first, last);
+        alloc_traits::deallocate(get_alloc(), first, n);
     }
 
     /// ================================================================================================================
     /// @brief get new capacity
     /// ================================================================================================================
 
-    template<typename T>
-    typename vector<T>::size_type vector<T>::get_new_cap(size_type add_size)
+    /**
+     * @brief 容量不足以再放下 add_size 个元素时，由增长策略给出新容量
+     * @return 新容量，至少为 size() + add_size
+     * */
+
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::size_type vector<T, Alloc, Growth>::get_new_cap(size_type add_size)
     {
-        const auto old_size = capacity();
+        const size_type old_size = size();
         THROW_LENGTH_ERROR_IF(old_size > max_size() - add_size, "vector<T>'s size too big");
-        if (old_size > max_size() - old_size / 2)
-        {
-            return old_size + add_size > max_size() - 16 ? old_size + add_size : old_size + add_size + 16;
-        }
-        const size_type new_size = old_size == 0 ? mystl::max(add_size, static_cast<size_type>(16))
-                                                 : mystl::max(old_size + old_size / 2, old_size + add_size);
-        return new_size;
+        return Growth::new_capacity(capacity(), old_size + add_size, sizeof(T), max_size());
     }
 
     /// ================================================================================================================
     /// @brief assign辅助函数
     /// ================================================================================================================
 
-    template<typename T>
-    void vector<T>::fill_assign(size_type n, const value_type &value)
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::fill_assign(size_type n, const value_type &value)
     {
         if (n > capacity())
         {
-            vector tmp(n, value);
+            vector tmp(n, value, get_alloc());
             swap(tmp);
         }
         else if (n > size())
@@ -753,9 +812,9 @@ namespace mystl
         }
     }
 
-    template<typename T>
+    template<typename T, typename Alloc, typename Growth>
     template<typename IIter>
-    void vector<T>::copy_assign(IIter first, IIter last, input_iterator_tag)
+    void vector<T, Alloc, Growth>::copy_assign(IIter first, IIter last, input_iterator_tag)
     {
         auto cur = begin_;
         for (; first != last && cur != end_; ++first, ++cur)
@@ -772,14 +831,14 @@ namespace mystl
         }
     }
 
-    template<typename T>
+    template<typename T, typename Alloc, typename Growth>
     template<typename FIter>
-    void vector<T>::copy_assign(FIter first, FIter last, forward_iterator_tag)
+    void vector<T, Alloc, Growth>::copy_assign(FIter first, FIter last, forward_iterator_tag)
     {
         const size_type len = mystl::distance(first, last);
         if (len > capacity())
         {
-            vector tmp(first, last);
+            vector tmp(first, last, get_alloc());
             swap(tmp);
         }
         else if (len > size())
@@ -793,7 +852,7 @@ namespace mystl
         else
         {
             auto new_end = mystl::copy(first, last, begin_);
-            data_allocator::destroy(new_end, end_);
+            alloc_traits::destroy(get_alloc(), new_end, end_);
             end_ = new_end;
         }
     }
@@ -802,23 +861,31 @@ namespace mystl
     /// @brief reallocate函数，重新分配空间
     /// ================================================================================================================
 
-    template<class T>
+    /// @brief 在新空间中一次完成 [begin, pos) + 新元素 + [pos, end) 的构造
+    template<typename T, typename Alloc, typename Growth>
     template<class ...Args>
-    void vector<T>::reallocate_emplace(iterator pos, Args &&...args)
+    void vector<T, Alloc, Growth>::reallocate_emplace(iterator pos, Args &&...args)
     {
-        const auto new_size = get_new_cap(1);
-        auto new_begin = data_allocator::allocate(new_size);
+        const auto result = alloc_traits::allocate_at_least(get_alloc(), get_new_cap(1));
+        const auto new_size = result.count;
+        auto new_begin = result.ptr;
+        auto new_pos = new_begin + (pos - begin_);
         auto new_end = new_begin;
+        int constructed = 0;
         try
         {
-            new_end = mystl::uninitialized_move(begin_, pos, new_begin);
-            data_allocator::construct(mystl::address_of(*new_end), mystl::forward<Args>(args)...);
-            ++new_end;
-            new_end = mystl::uninitialized_move(pos, end_, new_end);
+            // 先构造新元素：args 可能引用容器内的元素，搬移之后就失效了
+            alloc_traits::construct(get_alloc(), new_pos, mystl::forward<Args>(args)...);
+            constructed = 1;
+            mystl::uninitialized_move(begin_, pos, new_begin);
+            constructed = 2;
+            new_end = mystl::uninitialized_move(pos, end_, new_pos + 1);
         }
         catch (...)
         {
-            data_allocator::deallocate(new_begin, new_size);
+            if (constructed == 2) alloc_traits::destroy(get_alloc(), new_begin, new_pos);
+            if (constructed >= 1) alloc_traits::destroy(get_alloc(), new_pos);
+            alloc_traits::deallocate(get_alloc(), new_begin, new_size);
             throw;
         }
         destroy_and_recover(begin_, end_, cap_ - begin_);
@@ -827,42 +894,172 @@ namespace mystl
         cap_ = new_begin + new_size;
     }
 
-    template<typename T>
-    void vector<T>::reallocate_insert(iterator pos, const value_type &value)
+    /**
+     * @brief grow_storage 把容量扩大到至少 new_cap，保持元素不变
+     * @note 可以重定位的元素先尝试让分配器原地扩展，失败再 relocate_storage
+     * */
+
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::grow_storage(size_type new_cap, std::true_type)
     {
-        const auto new_size = get_new_cap(1);
-        auto new_begin = data_allocator::allocate(new_size);
-        auto new_end = new_begin;
-        const value_type &value_copy = value;
-        try
+        if (begin_ != nullptr && alloc_traits::expand(get_alloc(), begin_, capacity(), new_cap))
         {
-            new_end = mystl::uninitialized_move(begin_, pos, new_begin);
-            data_allocator::construct(mystl::address_of(*new_end), value_copy);
-            ++new_end;
-            new_end = mystl::uninitialized_move(pos, end_, new_end);
-        }
-        catch (...)
-        {
-            data_allocator::deallocate(new_begin, new_size);
-            throw;
+            cap_ = begin_ + new_cap;
+            return;
         }
+        relocate_storage(new_cap, typename alloc_traits::has_reallocate());
+    }
+
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::grow_storage(size_type new_cap, std::false_type)
+    {
+        const auto old_size = size();
+        // 分配器可能给出比 new_cap 更多的可用空间，全部计入容量
+        auto result = alloc_traits::allocate_at_least(get_alloc(), new_cap);
+        mystl::uninitialized_move(begin_, end_, result.ptr);
         destroy_and_recover(begin_, end_, cap_ - begin_);
-        begin_ = new_begin;
-        end_ = new_end;
-        cap_ = new_begin + new_size;
+        begin_ = result.ptr;
+        end_ = begin_ + old_size;
+        cap_ = begin_ + result.count;
+    }
+
+    /// @brief 分配器提供 reallocate(例如 malloc_allocator 的 realloc)时，由它决定原地扩展还是搬移
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::relocate_storage(size_type new_cap, std::true_type)
+    {
+        const auto old_size = size();
+        begin_ = alloc_traits::reallocate(get_alloc(), begin_, capacity(), new_cap);
+        end_ = begin_ + old_size;
+        cap_ = begin_ + new_cap;
+    }
+
+    /// @brief 否则分配新空间并 memcpy，重定位后原来的元素不需要逐个析构
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::relocate_storage(size_type new_cap, std::false_type)
+    {
+        const auto old_size = size();
+        auto result = alloc_traits::allocate_at_least(get_alloc(), new_cap);
+        if (old_size != 0)
+            std::memcpy(static_cast<void *>(result.ptr), static_cast<const void *>(begin_), old_size * sizeof(T));
+        if (begin_ != nullptr)
+            alloc_traits::deallocate(get_alloc(), begin_, capacity());
+        begin_ = result.ptr;
+        end_ = begin_ + old_size;
+        cap_ = begin_ + result.count;
     }
 
     /// ================================================================================================================
     /// @brief insert辅助函数定义
     /// ================================================================================================================
 
+    /**
+     * @brief insert_aux 在 pos 处插入一个由 args 构造的元素，空间不足时扩容
+     * @note 可以重定位的元素：新元素先在一块临时空间上构造(args 可能引用容器内的元素，搬移后会失效)，
+     *       然后把 [pos, end) 整体后移一格，最后把新元素按字节放入空位
+     * */
+
+    template<typename T, typename Alloc, typename Growth>
+    template<class ...Args>
+    void vector<T, Alloc, Growth>::insert_aux(std::true_type, iterator pos, Args &&...args)
+    {
+        const size_type xpos = pos - begin_;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type buf;
+        auto tmp = reinterpret_cast<T *>(&buf);
+        alloc_traits::construct(get_alloc(), tmp, mystl::forward<Args>(args)...);
+        if (end_ == cap_)
+        {
+            try
+            {
+                grow_storage(get_new_cap(1), std::true_type());
+            }
+            catch (...)
+            {
+                alloc_traits::destroy(get_alloc(), tmp);
+                throw;
+            }
+        }
+        pos = begin_ + xpos;
+        mystl::relocate_n(pos, end_ - pos, pos + 1);
+        mystl::relocate_n(tmp, 1, pos);
+        ++end_;
+    }
+
+    /// @brief 一般的元素：空间足够时在尾部构造一个副本，其余元素逐个后移，否则重新分配
+    template<typename T, typename Alloc, typename Growth>
+    template<class ...Args>
+    void vector<T, Alloc, Growth>::insert_aux(std::false_type, iterator pos, Args &&...args)
+    {
+        if (end_ != cap_)
+        {
+            value_type value_copy(mystl::forward<Args>(args)...);
+            alloc_traits::construct(get_alloc(), mystl::address_of(*end_), mystl::move(*(end_ - 1)));
+            auto new_end = end_ + 1;
+            mystl::move_backward(pos, end_ - 1, end_);
+            *pos = mystl::move(value_copy);
+            end_ = new_end;
+        }
+        else
+        {
+            reallocate_emplace(pos, mystl::forward<Args>(args)...);
+        }
+    }
+
+    /**
+     * @brief open_gap 在 pos 处腾出 n 个未初始化的位置(必要时扩容)，返回空位的起始位置，仅用于可以重定位的元素
+     * @note 空位计入 [begin, end)，填充失败时需要调用 close_gap 把后面的元素移回去
+     * */
+
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::open_gap(iterator pos, size_type n)
+    {
+        const size_type xpos = pos - begin_;
+        if (static_cast<size_type>(cap_ - end_) < n)
+            grow_storage(get_new_cap(n), std::true_type());
+        pos = begin_ + xpos;
+        mystl::relocate_n(pos, end_ - pos, pos + n);
+        end_ += n;
+        return pos;
+    }
+
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::close_gap(iterator pos, size_type n) noexcept
+    {
+        mystl::relocate_n(pos + n, end_ - pos - n, pos);
+        end_ -= n;
+    }
+
     /// @brief fill_insert 插入指定数量的元素 value
 
-    template<typename T>
-    typename vector<T>::iterator vector<T>::fill_insert(iterator pos, size_type n, const value_type &value)
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::fill_insert(iterator pos, size_type n, const value_type &value)
     {
         // 没有要插入元素时，直接返回
         if (n == 0) return pos;
+        return fill_insert_aux(pos, n, value, trivially_relocatable());
+    }
+
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator
+    vector<T, Alloc, Growth>::fill_insert_aux(iterator pos, size_type n, const value_type &value, std::true_type)
+    {
+        const value_type value_copy = value;
+        auto gap = open_gap(pos, n);
+        try
+        {
+            mystl::uninitialized_fill_n(gap, n, value_copy);
+        }
+        catch (...)
+        {
+            close_gap(gap, n);
+            throw;
+        }
+        return gap;
+    }
+
+    template<typename T, typename Alloc, typename Growth>
+    typename vector<T, Alloc, Growth>::iterator
+    vector<T, Alloc, Growth>::fill_insert_aux(iterator pos, size_type n, const value_type &value, std::false_type)
+    {
         const size_type xpos = pos - begin_;
         const value_type value_copy = value;
         if (static_cast<size_type>(cap_ - end_) >= n)
@@ -872,23 +1069,24 @@ namespace mystl
             auto old_end = end_;
             if (after_elems > n)
             {
-                mystl::uninitialized_copy(end_ - n, end_, end_);
+                mystl::uninitialized_move(end_ - n, end_, end_);
                 end_ += n;
                 mystl::move_backward(pos, old_end - n, old_end);
-                mystl::uninitialized_fill_n(pos, n, value_copy);
+                mystl::fill_n(pos, n, value_copy);
             }
             else
             {
                 end_ = mystl::uninitialized_fill_n(end_, n - after_elems, value_copy);
                 end_ = mystl::uninitialized_move(pos, old_end, end_);
-                mystl::uninitialized_fill_n(pos, after_elems, value_copy);
+                mystl::fill_n(pos, after_elems, value_copy);
             }
         }
         else
         {
             // 如果备用空间不足
-            const auto new_size = get_new_cap(n);
-            auto new_begin = data_allocator::allocate(new_size);
+            const auto result = alloc_traits::allocate_at_least(get_alloc(), get_new_cap(n));
+            const auto new_size = result.count;
+            auto new_begin = result.ptr;
             auto new_end = new_begin;
             try
             {
@@ -901,7 +1099,7 @@ namespace mystl
                 destroy_and_recover(new_begin, new_end, new_size);
                 throw;
             }
-            data_allocator::deallocate(begin_, cap_ - begin_);
+            destroy_and_recover(begin_, end_, cap_ - begin_);
             begin_ = new_begin;
             end_ = new_end;
             cap_ = begin_ + new_size;
@@ -911,11 +1109,35 @@ namespace mystl
 
     /// @brief copy_insert 插入连续的元素
 
-    template<typename T>
+    template<typename T, typename Alloc, typename Growth>
     template<typename IIter>
-    void vector<T>::copy_insert(iterator pos, IIter first, IIter last)
+    void vector<T, Alloc, Growth>::copy_insert(iterator pos, IIter first, IIter last)
     {
         if (first == last) return;
+        copy_insert_aux(pos, first, last, trivially_relocatable());
+    }
+
+    template<typename T, typename Alloc, typename Growth>
+    template<typename IIter>
+    void vector<T, Alloc, Growth>::copy_insert_aux(iterator pos, IIter first, IIter last, std::true_type)
+    {
+        const size_type n = mystl::distance(first, last);
+        auto gap = open_gap(pos, n);
+        try
+        {
+            mystl::uninitialized_copy(first, last, gap);
+        }
+        catch (...)
+        {
+            close_gap(gap, n);
+            throw;
+        }
+    }
+
+    template<typename T, typename Alloc, typename Growth>
+    template<typename IIter>
+    void vector<T, Alloc, Growth>::copy_insert_aux(iterator pos, IIter first, IIter last, std::false_type)
+    {
         const auto n = mystl::distance(first, last);
         if ((cap_ - end_) >= n)
         {
@@ -924,9 +1146,9 @@ namespace mystl
             auto old_end = end_;
             if (after_elems > n)
             {
-                end_ = mystl::uninitialized_copy(end_ - n, end_, end_);
+                end_ = mystl::uninitialized_move(end_ - n, end_, end_);
                 mystl::move_backward(pos, old_end - n, old_end);
-                mystl::uninitialized_copy(first, last, pos);
+                mystl::copy(first, last, pos);
             }
             else
             {
@@ -934,14 +1156,15 @@ namespace mystl
                 mystl::advance(mid, after_elems);
                 end_ = mystl::uninitialized_copy(mid, last, end_);
                 end_ = mystl::uninitialized_move(pos, old_end, end_);
-                mystl::uninitialized_copy(first, mid, pos);
+                mystl::copy(first, mid, pos);
             }
         }
         else
         {
             // 备用空间不足
-            const auto new_size = get_new_cap(n);
-            auto new_begin = data_allocator::allocate(new_size);
+            const auto result = alloc_traits::allocate_at_least(get_alloc(), get_new_cap(n));
+            const auto new_size = result.count;
+            auto new_begin = result.ptr;
             auto new_end = new_begin;
             try
             {
@@ -954,7 +1177,7 @@ namespace mystl
                 destroy_and_recover(new_begin, new_end, new_size);
                 throw;
             }
-            data_allocator::deallocate(begin_, cap_ - begin_);
+            destroy_and_recover(begin_, end_, cap_ - begin_);
             begin_ = new_begin;
             end_ = new_end;
             cap_ = begin_ + new_size;
@@ -965,20 +1188,29 @@ namespace mystl
     /// @brief shrink_to_fit辅助函数定义
     /// ================================================================================================================
 
-    template<typename T>
-    void vector<T>::reinsert(size_type size)
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::reinsert(size_type size)
     {
-        auto new_begin = data_allocator::allocate(size);
+        if (size == 0)
+        {
+            // 没有元素时直接归还空间，回到默认构造时的状态
+            alloc_traits::deallocate(get_alloc(), begin_, cap_ - begin_);
+            begin_ = nullptr;
+            end_ = nullptr;
+            cap_ = nullptr;
+            return;
+        }
+        auto new_begin = alloc_traits::allocate(get_alloc(), size);
         try
         {
-            mystl::uninitialized_move(begin_, end_, new_begin);
+            mystl::uninitialized_relocate(begin_, end_, new_begin);
         }
         catch (...)
         {
-            data_allocator::deallocate(new_begin, size);
+            alloc_traits::deallocate(get_alloc(), new_begin, size);
             throw;
         }
-        data_allocator::deallocate(begin_, cap_ - begin_);
+        alloc_traits::deallocate(get_alloc(), begin_, cap_ - begin_);
         begin_ = new_begin;
         end_ = begin_ + size;
         cap_ = begin_ + size;
@@ -989,21 +1221,29 @@ namespace mystl
     /// ================================================================================================================
 
     ///@brief 拷贝赋值运算符
-    template<typename T>
-    vector<T> &vector<T>::operator=(const vector<T> &lhs)
+    template<typename T, typename Alloc, typename Growth>
+    vector<T, Alloc, Growth> &vector<T, Alloc, Growth>::operator=(const vector &lhs)
     {
         if (this != &lhs)
         {
+            if (alloc_traits::propagate_on_container_copy_assignment::value &&
+                !mystl::alloc_equal(get_alloc(), lhs.get_alloc()))
+            {
+                // 需要传播分配器且两者不相等时，原空间必须由原分配器回收
+                destroy_and_recover(begin_, end_, cap_ - begin_);
+                begin_ = end_ = cap_ = nullptr;
+            }
+            mystl::alloc_on_copy(get_alloc(), lhs.get_alloc());
             const auto len = lhs.size();
             if (len > capacity())
             {
-                vector<T> tmp(lhs.begin_, lhs.end_);
+                vector tmp(lhs.begin_, lhs.end_, get_alloc());
                 swap(tmp);
             }
             else if (len <= size())
             {
                 auto i = mystl::copy(lhs.begin(), lhs.end(), begin());
-                data_allocator::destroy(i, end_);
+                alloc_traits::destroy(get_alloc(), i, end_);
                 end_ = begin_ + len;
             }
             else
@@ -1011,31 +1251,59 @@ namespace mystl
                 // 该条件包括当len 大于 size() 且 小于capcity() 时
                 mystl::copy(lhs.begin(), lhs.begin() + size(), begin_);
                 mystl::uninitialized_copy(lhs.begin() + size(), lhs.end(), end_);
-                // 讲cap_ 和 end_ 调整至扩展后的空间
-                cap_ = end_ = begin_ + len;
+                end_ = begin_ + len;
             }
         }
         return *this;
     }
 
     ///@brief 移动复制运算符
-    template<typename T>
-    vector<T> &vector<T>::operator=(vector &&rhs) noexcept
+    template<typename T, typename Alloc, typename Growth>
+    vector<T, Alloc, Growth> &vector<T, Alloc, Growth>::operator=(vector &&rhs)
+    noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)
+    {
+        if (this != &rhs)
+        {
+            move_assign(rhs, std::integral_constant<bool,
+                    alloc_traits::propagate_on_container_move_assignment::value ||
+                    alloc_traits::is_always_equal::value>{});
+        }
+        return *this;
+    }
+
+    /// @brief 可以接管 rhs 的空间
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::move_assign(vector &rhs, std::true_type) noexcept
     {
         destroy_and_recover(begin_, end_, cap_ - begin_);
+        mystl::alloc_on_move(get_alloc(), rhs.get_alloc());
         begin_ = rhs.begin_;
         end_ = rhs.end_;
         cap_ = rhs.cap_;
         rhs.begin_ = nullptr;
         rhs.end_ = nullptr;
         rhs.cap_ = nullptr;
-        return *this;
     }
 
-    template<typename T>
-    vector<T> &vector<T>::operator=(std::initializer_list<value_type> ilist)
+    /// @brief 分配器不传播时，只有两者相等才能接管空间，否则逐个移动元素
+    template<typename T, typename Alloc, typename Growth>
+    void vector<T, Alloc, Growth>::move_assign(vector &rhs, std::false_type)
     {
-        vector tmp(ilist.begin(), ilist.end());
+        if (get_alloc() == rhs.get_alloc())
+        {
+            move_assign(rhs, std::true_type{});
+            return;
+        }
+        clear();
+        reserve(rhs.size());
+        end_ = mystl::uninitialized_move(rhs.begin_, rhs.end_, begin_);
+        rhs.clear();
+    }
+
+    template<typename T, typename Alloc, typename Growth>
+    vector<T, Alloc, Growth> &vector<T, Alloc, Growth>::operator=(std::initializer_list<value_type> ilist)
+    {
+        vector tmp(ilist.begin(), ilist.end(), get_alloc());
         swap(tmp);
         return *this;
     }
@@ -1044,48 +1312,52 @@ namespace mystl
     /// @brief 重载比较运算符
     /// ================================================================================================================
 
-    template<typename T>
-    bool operator==(const vector<T> &lhs, const vector<T> &rhs)
+    template<typename T, typename Alloc, typename Growth>
+    bool operator==(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs)
     {
         return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
     }
 
-    template<typename T>
-    bool operator!=(const vector<T> &lhs, const vector<T> &rhs)
+    template<typename T, typename Alloc, typename Growth>
+    bool operator!=(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs)
     {
         return !(lhs == rhs);
     }
 
-    template<class T>
-    bool operator<(const vector<T> &lhs, const vector<T> &rhs)
+    template<typename T, typename Alloc, typename Growth>
+    bool operator<(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs)
     {
         return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
-    template<typename T>
-    bool operator>(const vector<T> &lhs, const vector<T> &rhs)
+    template<typename T, typename Alloc, typename Growth>
+    bool operator>(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs)
     {
         return rhs < lhs;
     }
 
-    template<typename T>
-    bool operator<=(const vector<T> &lhs, const vector<T> &rhs)
+    template<typename T, typename Alloc, typename Growth>
+    bool operator<=(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs)
     {
         return !(rhs < lhs);
     }
 
-    template<typename T>
-    bool operator>=(const vector<T> &lhs, const vector<T> &rhs)
+    template<typename T, typename Alloc, typename Growth>
+    bool operator>=(const vector<T, Alloc, Growth> &lhs, const vector<T, Alloc, Growth> &rhs)
     {
         return !(lhs < rhs);
     }
 
-    template<typename T>
-    void swap(vector<T> &lhs, vector<T> &rhs)
+    template<typename T, typename Alloc, typename Growth>
+    void swap(vector<T, Alloc, Growth> &lhs, vector<T, Alloc, Growth> &rhs)
     {
         lhs.swap(rhs);
     }
 
+    /// @brief vector 只持有指向堆内存的指针，分配器可以重定位时 vector 本身也可以重定位
+    template<typename T, typename Alloc, typename Growth>
+    struct is_trivially_relocatable<mystl::vector<T, Alloc, Growth>> : public mystl::is_trivially_relocatable<Alloc> {};
+
 }
 
 #endif //MYSTL_VECTOR_H
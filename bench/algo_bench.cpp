@@ -0,0 +1,303 @@
+/**
+ * @file algo_bench.cpp
+ * @brief mystl 排序算法(sort / 并行 sort / radix_sort / stable_sort)与 std 的对比基准，
+ * 覆盖随机、有序、逆序、少量不同值、基本有序等输入模式；以及 vector 的 ==、<、fill、find、count 等逐元素扫描
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+#include "algo.h"
+#include "deque.h"
+#include "execution.h"
+#include "vector.h"
+
+namespace mystl_bench
+{
+    namespace
+    {
+        enum pattern
+        {
+            random_order, sorted, reversed, few_unique, organ_pipe, nearly_sorted
+        };
+
+        const char *pattern_name(pattern p)
+        {
+            switch (p)
+            {
+                case random_order:
+                    return "random";
+                case sorted:
+                    return "sorted";
+                case reversed:
+                    return "reversed";
+                case few_unique:
+                    return "few_unique";
+                case nearly_sorted:
+                    return "nearly_sorted";
+                default:
+                    return "organ_pipe";
+            }
+        }
+
+        template<typename T>
+        T make_key(uint64_t x);
+
+        template<>
+        int make_key<int>(uint64_t x) { return static_cast<int>(x); }
+
+        template<>
+        uint32_t make_key<uint32_t>(uint64_t x) { return static_cast<uint32_t>(x * 2654435761u); }
+
+        template<>
+        uint64_t make_key<uint64_t>(uint64_t x) { return x * 0x9e3779b97f4a7c15ull; }
+
+        template<>
+        double make_key<double>(uint64_t x) { return static_cast<double>(x) * 0.5; }
+
+        template<>
+        std::string make_key<std::string>(uint64_t x)
+        {
+            std::string s = std::to_string(x);
+            return std::string(20 - s.size(), '0') + s;
+        }
+
+        template<typename T>
+        std::vector<T> make_input(size_t n, pattern p)
+        {
+            std::mt19937_64 rng(2023);
+            std::vector<T> keys;
+            keys.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                uint64_t x;
+                switch (p)
+                {
+                    case random_order:
+                        x = rng() % (n * 4 + 1);
+                        break;
+                    case sorted:
+                        x = i;
+                        break;
+                    case reversed:
+                        x = n - i;
+                        break;
+                    case few_unique:
+                        x = rng() % 16;
+                        break;
+                    case nearly_sorted:
+                        // 有序序列中约 1% 的位置换成随机值，类似追加了少量乱序记录的日志
+                        x = rng() % 100 == 0 ? rng() % (n + 1) : i;
+                        break;
+                    default:
+                        x = i < n / 2 ? i : n - i;
+                        break;
+                }
+                keys.push_back(make_key<T>(x));
+            }
+            return keys;
+        }
+
+        struct mystl_sorter
+        {
+            template<typename Iter>
+            void operator()(Iter first, Iter last) const { mystl::sort(first, last); }
+        };
+
+        struct mystl_par_sorter
+        {
+            template<typename Iter>
+            void operator()(Iter first, Iter last) const { mystl::sort(mystl::execution::par, first, last); }
+        };
+
+        struct mystl_radix_sorter
+        {
+            template<typename Iter>
+            void operator()(Iter first, Iter last) const { mystl::radix_sort(first, last); }
+        };
+
+        struct mystl_stable_sorter
+        {
+            template<typename Iter>
+            void operator()(Iter first, Iter last) const { mystl::stable_sort(first, last); }
+        };
+
+        struct std_sorter
+        {
+            template<typename Iter>
+            void operator()(Iter first, Iter last) const { std::sort(first, last); }
+        };
+
+        struct std_stable_sorter
+        {
+            template<typename Iter>
+            void operator()(Iter first, Iter last) const { std::stable_sort(first, last); }
+        };
+
+        /// @brief 每次迭代从同一份输入拷贝(不计时)后排序
+        template<typename C, typename Sorter>
+        void bm_sort(state &st, pattern p)
+        {
+            const auto input = make_input<typename C::value_type>(st.range(), p);
+            C c;
+            for (const auto &v: input)
+                c.push_back(v);
+            while (st.keep_running())
+            {
+                st.pause_timing();
+                auto it = c.begin();
+                for (const auto &v: input)
+                    *it++ = v;
+                st.resume_timing();
+                Sorter()(c.begin(), c.end());
+                do_not_optimize(c);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C, typename Sorter>
+        void register_sort(const char *impl, const char *type)
+        {
+            const pattern patterns[] = {random_order, sorted, reversed, few_unique, organ_pipe, nearly_sorted};
+            for (pattern p: patterns)
+            {
+                register_benchmark(std::string("sort_") + pattern_name(p), impl, type, {1024, 65536, 1048576},
+                                   [p](state &st) { bm_sort<C, Sorter>(st, p); });
+            }
+        }
+
+        /// @brief 两个只有最后一个元素不同的 vector，比较时需要扫描全部元素
+        template<typename C>
+        void make_compare_pair(size_t n, C &lhs, C &rhs)
+        {
+            typedef typename C::value_type T;
+            for (size_t i = 0; i < n; ++i)
+            {
+                lhs.push_back(static_cast<T>(i % 100));
+                rhs.push_back(static_cast<T>(i % 100));
+            }
+            rhs.back() = static_cast<T>(rhs.back() + 1);
+        }
+
+        template<typename C>
+        void bm_equal(state &st)
+        {
+            C lhs, rhs;
+            make_compare_pair(st.range(), lhs, rhs);
+            while (st.keep_running())
+                do_not_optimize(lhs == rhs);
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C>
+        void bm_less(state &st)
+        {
+            C lhs, rhs;
+            make_compare_pair(st.range(), lhs, rhs);
+            while (st.keep_running())
+                do_not_optimize(lhs < rhs);
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C>
+        void bm_fill(state &st)
+        {
+            typedef typename C::value_type T;
+            C c(st.range());
+            T value = T(1);
+            while (st.keep_running())
+            {
+                c.assign(st.range(), value);
+                do_not_optimize(c);
+                value = static_cast<T>(value + 1);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        /// @brief 查找不存在的值，需要扫描全部元素
+        template<typename T, bool Mystl>
+        void bm_find(state &st)
+        {
+            std::vector<T> c(st.range());
+            for (size_t i = 0; i < c.size(); ++i)
+                c[i] = static_cast<T>(i % 100);
+            while (st.keep_running())
+            {
+                const T *p = Mystl ? mystl::find(c.data(), c.data() + c.size(), T(101))
+                                   : std::find(c.data(), c.data() + c.size(), T(101));
+                do_not_optimize(p);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename T, bool Mystl>
+        void bm_count(state &st)
+        {
+            std::vector<T> c(st.range());
+            for (size_t i = 0; i < c.size(); ++i)
+                c[i] = static_cast<T>(i % 100);
+            while (st.keep_running())
+            {
+                const auto n = Mystl ? mystl::count(c.data(), c.data() + c.size(), T(7))
+                                     : std::count(c.data(), c.data() + c.size(), T(7));
+                do_not_optimize(n);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename T>
+        void register_scan(const char *type)
+        {
+            const std::vector<size_t> ranges{1024, 65536, 1048576};
+            register_benchmark("equal", "mystl::vector", type, ranges, bm_equal<mystl::vector<T>>);
+            register_benchmark("equal", "std::vector", type, ranges, bm_equal<std::vector<T>>);
+            register_benchmark("less", "mystl::vector", type, ranges, bm_less<mystl::vector<T>>);
+            register_benchmark("less", "std::vector", type, ranges, bm_less<std::vector<T>>);
+            register_benchmark("fill", "mystl::vector", type, ranges, bm_fill<mystl::vector<T>>);
+            register_benchmark("fill", "std::vector", type, ranges, bm_fill<std::vector<T>>);
+            register_benchmark("find", "mystl::find", type, ranges, bm_find<T, true>);
+            register_benchmark("find", "std::find", type, ranges, bm_find<T, false>);
+            register_benchmark("count", "mystl::count", type, ranges, bm_count<T, true>);
+            register_benchmark("count", "std::count", type, ranges, bm_count<T, false>);
+        }
+
+        struct registrar
+        {
+            registrar()
+            {
+                register_scan<char>("char");
+                register_scan<int>("int");
+                register_scan<uint32_t>("uint32");
+                register_scan<uint16_t>("uint16");
+                register_scan<double>("double");
+                register_sort<mystl::vector<int>, mystl_sorter>("mystl::sort/mystl::vector", "int");
+                register_sort<std::vector<int>, std_sorter>("std::sort/std::vector", "int");
+                register_sort<mystl::vector<double>, mystl_sorter>("mystl::sort/mystl::vector", "double");
+                register_sort<std::vector<double>, std_sorter>("std::sort/std::vector", "double");
+                register_sort<mystl::vector<std::string>, mystl_sorter>("mystl::sort/mystl::vector", "string");
+                register_sort<std::vector<std::string>, std_sorter>("std::sort/std::vector", "string");
+                register_sort<mystl::vector<uint32_t>, mystl_radix_sorter>("mystl::radix_sort/mystl::vector", "uint32");
+                register_sort<mystl::vector<uint32_t>, mystl_sorter>("mystl::sort/mystl::vector", "uint32");
+                register_sort<std::vector<uint32_t>, std_sorter>("std::sort/std::vector", "uint32");
+                register_sort<mystl::vector<uint64_t>, mystl_radix_sorter>("mystl::radix_sort/mystl::vector", "uint64");
+                register_sort<mystl::vector<uint64_t>, mystl_sorter>("mystl::sort/mystl::vector", "uint64");
+                register_sort<mystl::vector<uint64_t>, mystl_par_sorter>("mystl::sort(par)/mystl::vector", "uint64");
+                register_sort<std::vector<uint64_t>, std_sorter>("std::sort/std::vector", "uint64");
+                register_sort<mystl::vector<double>, mystl_radix_sorter>("mystl::radix_sort/mystl::vector", "double");
+                register_sort<mystl::vector<int>, mystl_stable_sorter>("mystl::stable_sort/mystl::vector", "int");
+                register_sort<std::vector<int>, std_stable_sorter>("std::stable_sort/std::vector", "int");
+                register_sort<mystl::vector<std::string>, mystl_stable_sorter>("mystl::stable_sort/mystl::vector",
+                                                                               "string");
+                register_sort<std::vector<std::string>, std_stable_sorter>("std::stable_sort/std::vector", "string");
+                register_sort<mystl::deque<int>, mystl_sorter>("mystl::sort/mystl::deque", "int");
+                register_sort<std::deque<int>, std_sorter>("std::sort/std::deque", "int");
+            }
+        } registrar_instance;
+    }
+}
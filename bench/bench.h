@@ -0,0 +1,180 @@
+/**
+ * @file bench.h
+ * @brief 仿照 Google Benchmark 的简易微基准框架：注册、自动确定迭代次数、控制台表格与 JSON 输出
+ */
+
+#ifndef MYSTL_BENCH_H
+#define MYSTL_BENCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mystl_bench
+{
+    /// ================================================================================================================
+    /// @brief do_not_optimize / clobber_memory 阻止编译器把被测代码优化掉
+    /// ================================================================================================================
+
+#if defined(__GNUC__) || defined(__clang__)
+
+    template<typename T>
+    inline void do_not_optimize(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline void clobber_memory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+#else
+
+    template<typename T>
+    inline void do_not_optimize(const T &value)
+    {
+        static volatile const void *sink;
+        sink = &value;
+    }
+
+    inline void clobber_memory()
+    {
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+    }
+
+#endif
+
+    /// ================================================================================================================
+    /// @brief state 单次运行的状态
+    /// ================================================================================================================
+
+    /**
+     * @brief 被测函数的写法：
+     * @code
+     * void bm(mystl_bench::state &st)
+     * {
+     *     while (st.keep_running())
+     *     {
+     *         st.pause_timing();   // 不计时的准备工作
+     *         ...
+     *         st.resume_timing();
+     *         ...                  // 被测代码
+     *     }
+     *     st.set_items_processed(st.iterations() * st.range());
+     * }
+     * @endcode
+     * */
+
+    class state
+    {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+    private:
+        size_t range_;
+        size_t max_iterations_;
+        size_t iterations_;
+        size_t items_processed_;
+
+        clock::time_point start_;
+        std::clock_t cpu_start_;
+        double real_ns_;
+        double cpu_ns_;
+        bool running_;
+
+    public:
+        state(size_t range, size_t max_iterations)
+                : range_(range), max_iterations_(max_iterations), iterations_(0), items_processed_(0),
+                  cpu_start_(0), real_ns_(0), cpu_ns_(0), running_(false) {}
+
+        /// @brief 第一次调用时开始计时，执行满 max_iterations 次后停止计时并返回 false
+        bool keep_running()
+        {
+            if (iterations_ == 0 && !running_)
+            {
+                resume_timing();
+            }
+            if (iterations_ < max_iterations_)
+            {
+                ++iterations_;
+                return true;
+            }
+            if (running_)
+                pause_timing();
+            return false;
+        }
+
+        void pause_timing()
+        {
+            real_ns_ += std::chrono::duration<double, std::nano>(clock::now() - start_).count();
+            cpu_ns_ += static_cast<double>(std::clock() - cpu_start_) * 1e9 / CLOCKS_PER_SEC;
+            running_ = false;
+        }
+
+        void resume_timing()
+        {
+            running_ = true;
+            cpu_start_ = std::clock();
+            start_ = clock::now();
+        }
+
+        size_t range() const noexcept { return range_; }
+
+        size_t iterations() const noexcept { return iterations_; }
+
+        void set_items_processed(size_t n) noexcept { items_processed_ = n; }
+
+        size_t items_processed() const noexcept { return items_processed_; }
+
+        double real_ns() const noexcept { return real_ns_; }
+
+        double cpu_ns() const noexcept { return cpu_ns_; }
+    };
+
+    /// ================================================================================================================
+    /// @brief 注册与运行
+    /// ================================================================================================================
+
+    /**
+     * @brief 一个基准由族名(family)、被测实现(impl，例如 "mystl::vector")、元素类型和规模组成，
+     * @brief 完整名字为 family<impl<type>>/range，便于在两次运行的 JSON 之间按名字比较
+     * */
+
+    struct benchmark
+    {
+        std::string family;
+        std::string impl;
+        std::string value_type;
+        size_t range;
+        std::function<void(state &)> func;
+
+        std::string name() const
+        {
+            return family + "<" + impl + "<" + value_type + ">>/" + std::to_string(range);
+        }
+    };
+
+    inline std::vector<benchmark> &registry()
+    {
+        static std::vector<benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    inline void register_benchmark(const std::string &family, const std::string &impl, const std::string &value_type,
+                                   const std::vector<size_t> &ranges, const std::function<void(state &)> &func)
+    {
+        for (size_t range: ranges)
+            registry().push_back(benchmark{family, impl, value_type, range, func});
+    }
+
+    /// @brief 解析命令行并运行全部已注册的基准，见 bench_main.cpp
+    int run_benchmarks(int argc, char **argv);
+
+}
+
+#endif //MYSTL_BENCH_H
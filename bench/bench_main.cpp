@@ -0,0 +1,236 @@
+/**
+ * @file bench_main.cpp
+ * @brief mystl_bench 的入口：命令行解析、迭代次数标定、控制台与 JSON 输出
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <thread>
+
+#include "bench.h"
+
+namespace mystl_bench
+{
+    namespace
+    {
+        struct options
+        {
+            std::string filter = ".*";
+            double min_time = 0.1;        // 每个基准至少运行的秒数
+            bool json = false;            // 控制台输出 JSON 而不是表格
+            std::string out;              // JSON 结果另外写入的文件
+        };
+
+        struct result
+        {
+            const benchmark *bm;
+            size_t iterations;
+            double real_ns;   // 每次迭代的时间
+            double cpu_ns;
+            double items_per_second;
+        };
+
+        void usage(const char *prog)
+        {
+            std::cerr << "usage: " << prog << " [--filter=REGEX] [--min_time=SECONDS] [--format=console|json]"
+                      << " [--out=FILE]\n";
+        }
+
+        bool starts_with(const char *arg, const char *prefix, const char *&value)
+        {
+            const size_t n = std::strlen(prefix);
+            if (std::strncmp(arg, prefix, n) != 0) return false;
+            value = arg + n;
+            return true;
+        }
+
+        bool parse(int argc, char **argv, options &opt)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                const char *v = nullptr;
+                if (starts_with(argv[i], "--filter=", v))
+                    opt.filter = v;
+                else if (starts_with(argv[i], "--min_time=", v))
+                    opt.min_time = std::atof(v);
+                else if (starts_with(argv[i], "--format=", v) && (std::strcmp(v, "json") == 0 ||
+                                                                   std::strcmp(v, "console") == 0))
+                    opt.json = std::strcmp(v, "json") == 0;
+                else if (starts_with(argv[i], "--out=", v))
+                    opt.out = v;
+                else
+                    return false;
+            }
+            return opt.min_time > 0;
+        }
+
+        /**
+         * @brief 和 Google Benchmark 相同的标定方式：从 1 次迭代开始，
+         * @brief 用上一次的耗时预测达到 min_time 需要的迭代次数(最多放大 10 倍)，直到某次运行足够长
+         * */
+        result run_one(const benchmark &bm, double min_time)
+        {
+            const double target_ns = min_time * 1e9;
+            size_t iters = 1;
+            while (true)
+            {
+                state st(bm.range, iters);
+                bm.func(st);
+                const double elapsed = st.real_ns();
+                if (elapsed >= target_ns || iters >= 1000000000)
+                {
+                    result r{&bm, st.iterations(), elapsed / iters, st.cpu_ns() / iters, 0};
+                    if (st.items_processed() != 0 && elapsed > 0)
+                        r.items_per_second = static_cast<double>(st.items_processed()) * 1e9 / elapsed;
+                    return r;
+                }
+                double multiplier = elapsed <= 0 ? 10.0 : target_ns * 1.4 / elapsed;
+                multiplier = std::min(10.0, std::max(multiplier, 1.1));
+                iters = static_cast<size_t>(static_cast<double>(iters) * multiplier) + 1;
+            }
+        }
+
+        std::string json_escape(const std::string &s)
+        {
+            std::string r;
+            for (char c: s)
+            {
+                if (c == '"' || c == '\\') r += '\\';
+                r += c;
+            }
+            return r;
+        }
+
+        void write_json(std::ostream &os, const std::vector<result> &results, const char *prog)
+        {
+            char date[64];
+            const std::time_t now = std::time(nullptr);
+            std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+#if defined(__clang__)
+            const std::string compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+            const std::string compiler = std::string("gcc ") + __VERSION__;
+#else
+            const std::string compiler = "unknown";
+#endif
+#ifdef NDEBUG
+            const char *build_type = "release";
+#else
+            const char *build_type = "debug";
+#endif
+            os << "{\n  \"context\": {\n"
+               << "    \"date\": \"" << date << "\",\n"
+               << "    \"executable\": \"" << json_escape(prog) << "\",\n"
+               << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+               << "    \"compiler\": \"" << json_escape(compiler) << "\",\n"
+               << "    \"library_build_type\": \"" << build_type << "\"\n"
+               << "  },\n  \"benchmarks\": [";
+            char buf[64];
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                const result &r = results[i];
+                os << (i == 0 ? "\n" : ",\n")
+                   << "    {\n"
+                   << "      \"name\": \"" << json_escape(r.bm->name()) << "\",\n"
+                   << "      \"family\": \"" << json_escape(r.bm->family) << "\",\n"
+                   << "      \"impl\": \"" << json_escape(r.bm->impl) << "\",\n"
+                   << "      \"value_type\": \"" << json_escape(r.bm->value_type) << "\",\n"
+                   << "      \"range\": " << r.bm->range << ",\n"
+                   << "      \"iterations\": " << r.iterations << ",\n";
+                std::snprintf(buf, sizeof(buf), "%.3f", r.real_ns);
+                os << "      \"real_time\": " << buf << ",\n";
+                std::snprintf(buf, sizeof(buf), "%.3f", r.cpu_ns);
+                os << "      \"cpu_time\": " << buf << ",\n"
+                   << "      \"time_unit\": \"ns\"";
+                if (r.items_per_second > 0)
+                {
+                    std::snprintf(buf, sizeof(buf), "%.6e", r.items_per_second);
+                    os << ",\n      \"items_per_second\": " << buf;
+                }
+                os << "\n    }";
+            }
+            os << "\n  ]\n}\n";
+        }
+
+        void print_header(size_t width)
+        {
+            std::printf("%-*s %15s %15s %12s %14s\n", static_cast<int>(width), "Benchmark", "Time(ns)", "CPU(ns)",
+                        "Iterations", "items/s");
+            std::printf("%s\n", std::string(width + 60, '-').c_str());
+        }
+
+        void print_row(const result &r, size_t width)
+        {
+            std::printf("%-*s %15.1f %15.1f %12zu", static_cast<int>(width), r.bm->name().c_str(), r.real_ns, r.cpu_ns,
+                        r.iterations);
+            if (r.items_per_second > 0)
+                std::printf(" %13.4gM", r.items_per_second / 1e6);
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+    }
+
+    int run_benchmarks(int argc, char **argv)
+    {
+        options opt;
+        if (!parse(argc, argv, opt))
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        std::regex filter;
+        try
+        {
+            filter = std::regex(opt.filter);
+        }
+        catch (const std::regex_error &)
+        {
+            std::cerr << "invalid --filter regex: " << opt.filter << "\n";
+            return 1;
+        }
+
+        std::vector<const benchmark *> selected;
+        size_t width = 10;
+        for (const benchmark &bm: registry())
+        {
+            if (std::regex_search(bm.name(), filter))
+            {
+                selected.push_back(&bm);
+                width = std::max(width, bm.name().size());
+            }
+        }
+
+        std::vector<result> results;
+        if (!opt.json) print_header(width);
+        for (const benchmark *bm: selected)
+        {
+            results.push_back(run_one(*bm, opt.min_time));
+            if (!opt.json) print_row(results.back(), width);
+        }
+
+        if (opt.json)
+            write_json(std::cout, results, argv[0]);
+        if (!opt.out.empty())
+        {
+            std::ofstream file(opt.out);
+            if (!file)
+            {
+                std::cerr << "cannot open " << opt.out << "\n";
+                return 1;
+            }
+            write_json(file, results, argv[0]);
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    return mystl_bench::run_benchmarks(argc, argv);
+}
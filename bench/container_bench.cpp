@@ -0,0 +1,434 @@
+/**
+ * @file container_bench.cpp
+ * @brief vector / list / deque 与 std 对应容器的对比基准
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+#include "deque.h"
+#include "list.h"
+#include "vector.h"
+
+namespace mystl_bench
+{
+    namespace
+    {
+        /// ============================================================================================================
+        /// @brief 元素类型
+        /// ============================================================================================================
+
+        /// @brief 64 字节的平凡类型，代表较大的 POD 记录
+        struct blob64
+        {
+            int key;
+            char payload[60];
+
+            blob64() noexcept: key(0), payload() {}
+
+            explicit blob64(int k) noexcept: key(k)
+            {
+                std::memset(payload, k & 0xff, sizeof(payload));
+            }
+
+            bool operator<(const blob64 &rhs) const noexcept { return key < rhs.key; }
+        };
+
+        /**
+         * @brief make(i) 生成第 i 个元素，keys(n) 生成 n 个互不相同且打乱顺序的元素
+         * @note std::string 的长度超过常见实现的 SSO 上限，拷贝时需要分配内存
+         * */
+
+        template<typename T>
+        struct value_maker;
+
+        template<>
+        struct value_maker<int>
+        {
+            static const char *name() { return "int"; }
+
+            static int make(size_t i) { return static_cast<int>(i); }
+        };
+
+        template<>
+        struct value_maker<std::string>
+        {
+            static const char *name() { return "string"; }
+
+            static std::string make(size_t i)
+            {
+                std::string s = std::to_string(i);
+                return std::string(32 - s.size(), '0') + s;
+            }
+        };
+
+        template<>
+        struct value_maker<blob64>
+        {
+            static const char *name() { return "blob64"; }
+
+            static blob64 make(size_t i) { return blob64(static_cast<int>(i)); }
+        };
+
+        template<typename T>
+        std::vector<T> make_values(size_t n, bool shuffled)
+        {
+            std::vector<T> values;
+            values.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+                values.push_back(value_maker<T>::make(i));
+            if (shuffled)
+                std::shuffle(values.begin(), values.end(), std::mt19937(12345));
+            return values;
+        }
+
+        template<typename C>
+        void fill(C &c, const std::vector<typename C::value_type> &values)
+        {
+            for (const auto &v: values)
+                c.push_back(v);
+        }
+
+        /// @brief 链表的中间位置需要遍历，插入/删除时维护一个中间迭代器；可随机访问的容器直接计算
+        template<typename C>
+        struct is_list : std::false_type {};
+
+        template<typename T, typename A>
+        struct is_list<mystl::list<T, A>> : std::true_type {};
+
+        template<typename T, typename A>
+        struct is_list<std::list<T, A>> : std::true_type {};
+
+        /// ============================================================================================================
+        /// @brief 基准函数
+        /// ============================================================================================================
+
+        template<typename C>
+        void bm_push_back(state &st)
+        {
+            const auto values = make_values<typename C::value_type>(st.range(), false);
+            while (st.keep_running())
+            {
+                C c;
+                for (const auto &v: values)
+                    c.push_back(v);
+                do_not_optimize(c);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C>
+        void bm_emplace_back(state &st)
+        {
+            typedef typename C::value_type T;
+            const size_t n = st.range();
+            while (st.keep_running())
+            {
+                C c;
+                for (size_t i = 0; i < n; ++i)
+                    c.emplace_back(value_maker<T>::make(i));
+                do_not_optimize(c);
+            }
+            st.set_items_processed(st.iterations() * n);
+        }
+
+        template<typename C>
+        void insert_middle(C &c, const std::vector<typename C::value_type> &values, std::false_type)
+        {
+            for (const auto &v: values)
+                c.insert(c.begin() + c.size() / 2, v);
+        }
+
+        template<typename C>
+        void insert_middle(C &c, const std::vector<typename C::value_type> &values, std::true_type)
+        {
+            // 每插入两个元素中间迭代器向后移动一步，保持在中间
+            auto mid = c.end();
+            bool odd = false;
+            for (const auto &v: values)
+            {
+                mid = c.insert(mid, v);
+                if ((odd = !odd))
+                    ++mid;
+            }
+        }
+
+        template<typename C>
+        void bm_insert_middle(state &st)
+        {
+            const auto values = make_values<typename C::value_type>(st.range(), false);
+            while (st.keep_running())
+            {
+                C c;
+                insert_middle(c, values, is_list<C>());
+                do_not_optimize(c);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C>
+        void erase_middle(C &c, std::false_type)
+        {
+            while (!c.empty())
+                c.erase(c.begin() + c.size() / 2);
+        }
+
+        template<typename C>
+        void erase_middle(C &c, std::true_type)
+        {
+            auto mid = c.begin();
+            for (size_t i = 0; i < c.size() / 2; ++i)
+                ++mid;
+            bool odd = c.size() % 2 != 0;
+            while (!c.empty())
+            {
+                mid = c.erase(mid);
+                if ((odd = !odd) && mid != c.begin())
+                    --mid;
+            }
+        }
+
+        template<typename C>
+        void bm_erase_middle(state &st)
+        {
+            const auto values = make_values<typename C::value_type>(st.range(), false);
+            while (st.keep_running())
+            {
+                st.pause_timing();
+                C c;
+                fill(c, values);
+                st.resume_timing();
+                erase_middle(c, is_list<C>());
+                do_not_optimize(c);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename T>
+        size_t touch(const T &v) { return static_cast<size_t>(v); }
+
+        size_t touch(const std::string &v) { return v.size(); }
+
+        size_t touch(const blob64 &v) { return static_cast<size_t>(v.key); }
+
+        template<typename C>
+        void bm_iterate(state &st)
+        {
+            C c;
+            fill(c, make_values<typename C::value_type>(st.range(), false));
+            while (st.keep_running())
+            {
+                size_t sum = 0;
+                for (const auto &v: c)
+                    sum += touch(v);
+                do_not_optimize(sum);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        /// @brief 滑动窗口：每轮从尾部进一个、头部出一个，再按下标访问整个窗口
+        template<typename C>
+        void bm_window_index(state &st)
+        {
+            C c;
+            fill(c, make_values<typename C::value_type>(st.range(), false));
+            const auto extra = make_values<typename C::value_type>(64, true);
+            size_t round = 0;
+            while (st.keep_running())
+            {
+                c.push_back(extra[round++ % extra.size()]);
+                c.pop_front();
+                size_t sum = 0;
+                for (size_t i = 0; i < c.size(); ++i)
+                    sum += touch(c[i]);
+                do_not_optimize(sum);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        /// @brief 整个 deque 拷贝到连续数组：mystl 用 mystl::copy(按块 memmove)，std 用 std::copy
+        template<typename T, typename Alloc, size_t BlockBytes>
+        void copy_out(const mystl::deque<T, Alloc, BlockBytes> &c, T *out)
+        {
+            mystl::copy(c.begin(), c.end(), out);
+        }
+
+        template<typename T>
+        void copy_out(const std::deque<T> &c, T *out)
+        {
+            std::copy(c.begin(), c.end(), out);
+        }
+
+        template<typename C>
+        void bm_copy_out(state &st)
+        {
+            typedef typename C::value_type T;
+            C c;
+            fill(c, make_values<T>(st.range(), false));
+            std::vector<T> out(c.size());
+            while (st.keep_running())
+            {
+                copy_out(c, out.data());
+                do_not_optimize(out);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C>
+        void bm_copy_construct(state &st)
+        {
+            C src;
+            fill(src, make_values<typename C::value_type>(st.range(), false));
+            while (st.keep_running())
+            {
+                C dst(src);
+                do_not_optimize(dst);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C>
+        void bm_copy_assign(state &st)
+        {
+            C src;
+            fill(src, make_values<typename C::value_type>(st.range(), false));
+            C dst;
+            fill(dst, make_values<typename C::value_type>(st.range() / 2, true));
+            while (st.keep_running())
+            {
+                st.pause_timing();
+                C tmp(dst);
+                st.resume_timing();
+                tmp = src;
+                do_not_optimize(tmp);
+                st.pause_timing();
+                // tmp 的析构不计时
+                {
+                    C drop(std::move(tmp));
+                }
+                st.resume_timing();
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C, bool Buffered>
+        void list_sort(C &c, std::integral_constant<bool, Buffered>)
+        {
+            c.sort();
+        }
+
+        template<typename C>
+        void list_sort(C &c, std::true_type)
+        {
+            c.sort(mystl::list_sort_mode::buffered);
+        }
+
+        template<typename C, bool Buffered = false>
+        void bm_list_sort(state &st)
+        {
+            const auto values = make_values<typename C::value_type>(st.range(), true);
+            while (st.keep_running())
+            {
+                st.pause_timing();
+                C c;
+                fill(c, values);
+                st.resume_timing();
+                list_sort(c, std::integral_constant<bool, Buffered>());
+                do_not_optimize(c);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        template<typename C>
+        void bm_list_merge(state &st)
+        {
+            auto values = make_values<typename C::value_type>(st.range(), true);
+            std::vector<typename C::value_type> left(values.begin(), values.begin() + values.size() / 2);
+            std::vector<typename C::value_type> right(values.begin() + values.size() / 2, values.end());
+            std::sort(left.begin(), left.end());
+            std::sort(right.begin(), right.end());
+            while (st.keep_running())
+            {
+                st.pause_timing();
+                C a, b;
+                fill(a, left);
+                fill(b, right);
+                st.resume_timing();
+                a.merge(b);
+                do_not_optimize(a);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        /// ============================================================================================================
+        /// @brief 注册
+        /// ============================================================================================================
+
+        const std::vector<size_t> small_ranges{64, 1024, 8192};
+        const std::vector<size_t> large_ranges{64, 4096, 65536};
+
+        /// @brief 三种容器共有的操作
+        template<typename C>
+        void register_sequence(const char *impl)
+        {
+            const char *type = value_maker<typename C::value_type>::name();
+            register_benchmark("push_back", impl, type, large_ranges, bm_push_back<C>);
+            register_benchmark("emplace_back", impl, type, large_ranges, bm_emplace_back<C>);
+            register_benchmark("insert_middle", impl, type, small_ranges, bm_insert_middle<C>);
+            register_benchmark("erase_middle", impl, type, small_ranges, bm_erase_middle<C>);
+            register_benchmark("iterate", impl, type, large_ranges, bm_iterate<C>);
+            register_benchmark("copy_construct", impl, type, large_ranges, bm_copy_construct<C>);
+            register_benchmark("copy_assign", impl, type, large_ranges, bm_copy_assign<C>);
+        }
+
+        template<typename C>
+        void register_list(const char *impl)
+        {
+            const char *type = value_maker<typename C::value_type>::name();
+            register_sequence<C>(impl);
+            register_benchmark("sort", impl, type, large_ranges, bm_list_sort<C>);
+            register_benchmark("merge", impl, type, large_ranges, bm_list_merge<C>);
+        }
+
+        template<typename T>
+        void register_type()
+        {
+            register_sequence<mystl::vector<T>>("mystl::vector");
+            register_sequence<std::vector<T>>("std::vector");
+            register_sequence<mystl::deque<T>>("mystl::deque");
+            register_sequence<std::deque<T>>("std::deque");
+            register_list<mystl::list<T>>("mystl::list");
+            register_list<mystl::pooled_list<T>>("mystl::pooled_list");
+            register_benchmark("sort", "mystl::list(buffered)", value_maker<T>::name(), large_ranges,
+                               bm_list_sort<mystl::list<T>, true>);
+            register_list<std::list<T>>("std::list");
+            register_benchmark("window_index", "mystl::deque", value_maker<T>::name(), large_ranges,
+                               bm_window_index<mystl::deque<T>>);
+            register_benchmark("window_index", "mystl::deque(64KiB)", value_maker<T>::name(), large_ranges,
+                               bm_window_index<mystl::deque<T, mystl::allocator<T>, 65536>>);
+            register_benchmark("window_index", "std::deque", value_maker<T>::name(), large_ranges,
+                               bm_window_index<std::deque<T>>);
+            register_benchmark("copy_out", "mystl::deque", value_maker<T>::name(), large_ranges,
+                               bm_copy_out<mystl::deque<T>>);
+            register_benchmark("copy_out", "std::deque", value_maker<T>::name(), large_ranges,
+                               bm_copy_out<std::deque<T>>);
+        }
+
+        struct registrar
+        {
+            registrar()
+            {
+                register_type<int>();
+                register_type<std::string>();
+                register_type<blob64>();
+            }
+        } registrar_instance;
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file queue_bench.cpp
+ * @brief priority_queue 不同叉数与 std::priority_queue 的对比基准
+ */
+
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+
+#include "queue.h"
+
+namespace mystl_bench
+{
+    namespace
+    {
+        std::vector<uint64_t> random_keys(size_t n)
+        {
+            std::mt19937_64 rng(42);
+            std::vector<uint64_t> keys(n);
+            for (auto &k: keys)
+                k = rng();
+            return keys;
+        }
+
+        /// @brief 先压入 n 个随机键再全部弹出，近似定时器队列的使用方式
+        template<typename PQ>
+        void bm_push_pop(state &st)
+        {
+            const auto keys = random_keys(st.range());
+            while (st.keep_running())
+            {
+                PQ pq;
+                for (uint64_t k: keys)
+                    pq.push(k);
+                uint64_t sum = 0;
+                while (!pq.empty())
+                {
+                    sum += pq.top();
+                    pq.pop();
+                }
+                do_not_optimize(sum);
+            }
+            st.set_items_processed(st.iterations() * st.range());
+        }
+
+        /// @brief 保持堆大小为 n，交替 pop 与 push，主要衡量大堆上的 sift-down
+        template<typename PQ>
+        void bm_steady_state(state &st)
+        {
+            const auto keys = random_keys(st.range() * 2);
+            PQ pq;
+            for (size_t i = 0; i < st.range(); ++i)
+                pq.push(keys[i]);
+            size_t next = st.range();
+            while (st.keep_running())
+            {
+                for (size_t i = 0; i < 1024; ++i)
+                {
+                    pq.pop();
+                    pq.push(keys[next]);
+                    next = next + 1 == keys.size() ? 0 : next + 1;
+                }
+                do_not_optimize(pq.top());
+            }
+            st.set_items_processed(st.iterations() * 1024);
+        }
+
+        template<typename PQ>
+        void register_pq(const char *impl)
+        {
+            register_benchmark("pq_push_pop", impl, "uint64", {1024, 65536, 1048576}, bm_push_pop<PQ>);
+            register_benchmark("pq_steady_state", impl, "uint64", {1024, 65536, 1048576}, bm_steady_state<PQ>);
+        }
+
+        struct registrar
+        {
+            registrar()
+            {
+                typedef mystl::vector<uint64_t> storage;
+                register_pq<mystl::priority_queue<uint64_t, storage, mystl::less<uint64_t>, 2>>(
+                        "mystl::priority_queue_2ary");
+                register_pq<mystl::priority_queue<uint64_t, storage, mystl::less<uint64_t>, 4>>(
+                        "mystl::priority_queue_4ary");
+                register_pq<mystl::priority_queue<uint64_t, storage, mystl::less<uint64_t>, 8>>(
+                        "mystl::priority_queue_8ary");
+                register_pq<std::priority_queue<uint64_t>>("std::priority_queue");
+            }
+        } registrar_instance;
+    }
+}